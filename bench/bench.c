@@ -0,0 +1,407 @@
+#include "perf_counters.h"
+
+#include <snmemory/snmemory.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define KB(x) ((x) * 1024ULL)
+#define MB(x) ((x) * 1024ULL * 1024ULL)
+
+#define POOL_BLOCK_SIZE 48
+#define POOL_BLOCKS 65536
+#define POOL_BATCH 64
+
+#define FREELIST_HOLES 4096
+
+/**
+ * @struct SnBench
+ * @brief A single benchmark.
+ *
+ * setup runs outside the measured region, run is measured and
+ * returns the number of operations it performed. report is optional and
+ * prints extra metrics of the last run.
+ */
+typedef struct SnBench {
+    const char *name;
+    void (*setup)(void);
+    uint64_t (*run)(void);
+    void (*report)(void);
+} SnBench;
+
+static uint8_t *memory;
+static void **ptrs;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void shuffle(void **array, uint64_t count) {
+    for (uint64_t i = count - 1; i > 0; --i) {
+        uint64_t j = (uint64_t)rand() % (i + 1);
+        void *tmp = array[i];
+        array[i] = array[j];
+        array[j] = tmp;
+    }
+}
+
+/* Linear allocator: baseline bump allocation */
+
+static SnLinearAllocator linear;
+
+static void linear_setup(void) {
+    sn_linear_allocator_init(&linear, memory, MB(8));
+}
+
+static uint64_t linear_run(void) {
+    uint64_t ops = 0;
+    while (sn_linear_allocator_allocate(&linear, 48, 16)) ops++;
+    return ops;
+}
+
+/* Zeroed linear allocations: memset per allocation against one bulk zero on reset */
+
+static void linear_zeroed_setup(void) {
+    sn_linear_allocator_init_with_flags(&linear, memory, MB(8), SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET);
+}
+
+static uint64_t linear_memset_run(void) {
+    uint64_t ops = 0;
+    void *ptr;
+    while ((ptr = sn_linear_allocator_allocate(&linear, 48, 16))) {
+        memset(ptr, 0, 48);
+        ops++;
+    }
+    return ops;
+}
+
+static uint64_t linear_zeroed_run(void) {
+    uint64_t ops = 0;
+    while (sn_linear_allocator_allocate_zeroed(&linear, 48, 16)) ops++;
+
+    // The zeroing is paid here, once for the whole buffer
+    sn_linear_allocator_reset(&linear);
+    return ops;
+}
+
+/* VM arena: the same bump with a guard page after every chunk */
+
+static SnVmArena vm_arena;
+
+static void vm_arena_setup(void) {
+    sn_vm_arena_deinit(&vm_arena);
+    sn_vm_arena_init(&vm_arena, MB(8), KB(64), SN_VM_ARENA_FLAG_GUARD_PAGES, 0);
+}
+
+static uint64_t vm_arena_run(void) {
+    uint64_t ops = 0;
+    while (sn_vm_arena_allocate(&vm_arena, 48, 16)) ops++;
+    return ops;
+}
+
+/* Pool allocator: free-list chasing after ordered and shuffled frees */
+
+static SnPoolAllocator pool;
+
+static void pool_setup(void) {
+    sn_pool_allocator_init(&pool, memory, POOL_BLOCK_SIZE * POOL_BLOCKS, POOL_BLOCK_SIZE, 16);
+}
+
+static uint64_t pool_sequential_run(void) {
+    for (uint64_t i = 0; i < POOL_BLOCKS; ++i) ptrs[i] = sn_pool_allocator_allocate(&pool);
+    for (uint64_t i = 0; i < POOL_BLOCKS; ++i) sn_pool_allocator_free(&pool, ptrs[i]);
+    return POOL_BLOCKS * 2;
+}
+
+static uint64_t pool_batch_run(void) {
+    // Packet sized batches
+    for (uint64_t i = 0; i < POOL_BLOCKS; i += POOL_BATCH) {
+        sn_pool_allocator_allocate_batch(&pool, ptrs + i, POOL_BATCH);
+        sn_pool_allocator_free_batch(&pool, ptrs + i, POOL_BATCH);
+    }
+    return POOL_BLOCKS * 2;
+}
+
+static void pool_shuffled_setup(void) {
+    pool_setup();
+    for (uint64_t i = 0; i < POOL_BLOCKS; ++i) ptrs[i] = sn_pool_allocator_allocate(&pool);
+    shuffle(ptrs, POOL_BLOCKS);
+    for (uint64_t i = 0; i < POOL_BLOCKS; ++i) sn_pool_allocator_free(&pool, ptrs[i]);
+}
+
+static uint64_t pool_shuffled_run(void) {
+    // Every allocation touches a block in a random place of the pool
+    for (uint64_t i = 0; i < POOL_BLOCKS; ++i) {
+        ptrs[i] = sn_pool_allocator_allocate(&pool);
+        *(uint64_t *)ptrs[i] = i;
+    }
+    return POOL_BLOCKS;
+}
+
+/* Free-list allocator: first fit scanning over a fragmented heap */
+
+static SnFreeListAllocator freelist;
+
+static void freelist_fragmented_setup(void) {
+    sn_freelist_allocator_init(&freelist, memory, MB(8));
+
+    // Leave small holes at the front of the list so large requests must scan
+    for (uint64_t i = 0; i < FREELIST_HOLES * 2; ++i)
+        ptrs[i] = sn_freelist_allocator_allocate(&freelist, 32, 8);
+    for (uint64_t i = 0; i < FREELIST_HOLES * 2; i += 2)
+        sn_freelist_allocator_free(&freelist, ptrs[i]);
+}
+
+static uint64_t freelist_fragmented_run(void) {
+    for (uint64_t i = 0; i < 1024; ++i) {
+        void *p = sn_freelist_allocator_allocate(&freelist, KB(1), 16);
+        sn_freelist_allocator_free(&freelist, p);
+    }
+    return 1024 * 2;
+}
+
+static void freelist_batch_setup(void) {
+    sn_freelist_allocator_init(&freelist, memory, MB(8));
+}
+
+static uint64_t freelist_batch_run(void) {
+    for (uint64_t i = 0; i < 1024; ++i) {
+        sn_freelist_allocator_allocate_batch(&freelist, ptrs, POOL_BATCH, 64, 8);
+        shuffle(ptrs, POOL_BATCH);
+        sn_freelist_allocator_free_batch(&freelist, ptrs, POOL_BATCH);
+    }
+    return 1024 * POOL_BATCH * 2;
+}
+
+static uint64_t freelist_allocations;
+
+static void freelist_random_setup_policy(SnFreeListPolicy policy) {
+    sn_freelist_allocator_init_with_policy(&freelist, memory, MB(8), policy);
+    memset(ptrs, 0, sizeof(void *) * FREELIST_HOLES);
+    freelist_allocations = 0;
+
+    // Same request stream for every policy
+    srand(0xF1EE);
+}
+
+static void freelist_random_setup(void) {
+    freelist_random_setup_policy(SN_FREELIST_FIRST_FIT);
+}
+
+static void freelist_next_fit_setup(void) {
+    freelist_random_setup_policy(SN_FREELIST_NEXT_FIT);
+}
+
+static void freelist_best_fit_setup(void) {
+    freelist_random_setup_policy(SN_FREELIST_BEST_FIT);
+}
+
+static uint64_t freelist_random_run(void) {
+    uint64_t ops = 0;
+    for (uint64_t i = 0; i < 65536; ++i) {
+        uint64_t slot = (uint64_t)rand() % FREELIST_HOLES;
+        if (ptrs[slot]) {
+            sn_freelist_allocator_free(&freelist, ptrs[slot]);
+            ptrs[slot] = NULL;
+        } else {
+            ptrs[slot] = sn_freelist_allocator_allocate(&freelist, 16 + (uint64_t)rand() % 512, 8);
+            freelist_allocations++;
+        }
+        ops++;
+    }
+    return ops;
+}
+
+static void freelist_report(void) {
+    // Fragmentation: share of free memory outside the largest free block
+    uint64_t free_size = sn_freelist_allocator_get_free_size(&freelist);
+    uint64_t largest = sn_freelist_allocator_get_largest_free_size(&freelist);
+    uint64_t scanned = sn_freelist_allocator_get_scanned_nodes(&freelist, false);
+
+    printf("%-28s %10.2f nodes/alloc %6.2f%% fragmented\n", "", (double)scanned / freelist_allocations,
+        free_size ? 100.0 * (double)(free_size - largest) / (double)free_size : 0.0);
+}
+
+/* Free-list large blocks: growing a populated block past its reservation */
+
+static SnFreeListAllocator large_freelist;
+static SnFreeListLargeBlock large_registry[1];
+static void *large_block;
+
+static void freelist_large_setup(void) {
+    // Drops the block of the previous repetition
+    sn_freelist_allocator_deinit(&large_freelist);
+    sn_freelist_allocator_init(&large_freelist, memory, KB(64));
+    sn_freelist_allocator_enable_large_blocks(&large_freelist, SN_FREELIST_LARGE_THRESHOLD, large_registry, 1);
+
+    large_block = sn_freelist_allocator_allocate(&large_freelist, MB(64), 16);
+    if (large_block) memset(large_block, 0x5A, MB(64));
+}
+
+static uint64_t freelist_large_grow_run(void) {
+    // 4x is past the 2x reservation, so the whole block has to move
+    large_block = sn_freelist_allocator_reallocate(&large_freelist, large_block, MB(256), 16);
+    return large_block ? 1 : 0;
+}
+
+/* Handle pool: resolving handles in random order */
+
+static SnHandlePool handles;
+
+static void handle_setup(void) {
+    sn_handle_pool_init(&handles, memory, MB(8), POOL_BLOCK_SIZE, 16);
+
+    // Handles are stored in the pointer array
+    for (uint64_t i = 0; i < POOL_BLOCKS; ++i)
+        ptrs[i] = (void *)(uintptr_t)sn_handle_pool_allocate(&handles, NULL);
+    shuffle(ptrs, POOL_BLOCKS);
+}
+
+static uint64_t handle_resolve_run(void) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < POOL_BLOCKS; ++i)
+        sum += (uint64_t)sn_handle_pool_resolve(&handles, (SnHandle)(uintptr_t)ptrs[i]);
+
+    // Keep the loop from being optimized away
+    if (!sum) printf("unreachable\n");
+    return POOL_BLOCKS;
+}
+
+/* Packed pool: streaming over live items after random removals */
+
+static SnPackedPool packed;
+
+static void packed_setup(void) {
+    if (!sn_packed_pool_init(&packed, memory, MB(8), POOL_BLOCK_SIZE, 16)) {
+        fprintf(stderr, "packed_setup: pool init failed\n");
+        exit(1);
+    }
+
+    for (uint64_t i = 0; i < POOL_BLOCKS; ++i) {
+        void *item = NULL;
+        SnHandle handle = sn_packed_pool_allocate(&packed, &item);
+        if (handle == SN_HANDLE_INVALID || !item) {
+            fprintf(stderr, "packed_setup: pool full after %llu items\n", (unsigned long long)i);
+            exit(1);
+        }
+
+        ptrs[i] = (void *)(uintptr_t)handle;
+        memset(item, (int)i, POOL_BLOCK_SIZE);
+    }
+
+    shuffle(ptrs, POOL_BLOCKS);
+    for (uint64_t i = 0; i < POOL_BLOCKS / 2; ++i) sn_packed_pool_free(&packed, (SnHandle)(uintptr_t)ptrs[i]);
+}
+
+static uint64_t packed_iterate_run(void) {
+    uint64_t sum = 0;
+    uint8_t *items = sn_packed_pool_get_items(&packed);
+    uint32_t count = sn_packed_pool_get_count(&packed);
+
+    for (uint32_t i = 0; i < count; ++i) sum += *(uint64_t *)(items + (uint64_t)i * POOL_BLOCK_SIZE);
+
+    if (!sum) printf("unreachable\n");
+    return count;
+}
+
+static const SnBench benches[] = {
+    {"linear_allocate",            linear_setup,              linear_run,              NULL           },
+    {"linear_allocate_memset",     linear_setup,              linear_memset_run,       NULL           },
+    {"linear_zero_on_reset",       linear_zeroed_setup,       linear_zeroed_run,       NULL           },
+    {"vm_arena_guarded_allocate",  vm_arena_setup,            vm_arena_run,            NULL           },
+    {"pool_alloc_free_sequential", pool_setup,                pool_sequential_run,     NULL           },
+    {"pool_alloc_free_batch",      pool_setup,                pool_batch_run,          NULL           },
+    {"pool_alloc_shuffled",        pool_shuffled_setup,       pool_shuffled_run,       NULL           },
+    {"freelist_first_fit_holes",   freelist_fragmented_setup, freelist_fragmented_run, NULL           },
+    {"freelist_alloc_free_batch",  freelist_batch_setup,      freelist_batch_run,      NULL           },
+    {"freelist_random",            freelist_random_setup,     freelist_random_run,     freelist_report},
+    {"freelist_random_next_fit",   freelist_next_fit_setup,   freelist_random_run,     freelist_report},
+    {"freelist_random_best_fit",   freelist_best_fit_setup,   freelist_random_run,     freelist_report},
+    {"freelist_large_grow_64mb",   freelist_large_setup,      freelist_large_grow_run, NULL           },
+    {"handle_pool_resolve",        handle_setup,              handle_resolve_run,      NULL           },
+    {"packed_pool_iterate",        packed_setup,              packed_iterate_run,      NULL           },
+};
+
+static void print_result(const SnBench *bench, uint64_t ops, uint64_t ns, SnPerfSample *sample) {
+    printf("%-28s %10llu ops %9.2f ns/op", bench->name, (unsigned long long)ops, (double)ns / ops);
+
+    if (sample) {
+        for (int i = 0; i < SN_PERF_EVENT_COUNT; ++i) {
+            if (sample->valid[i])
+                printf("  %s %.2f", sn_perf_event_name(i), (double)sample->values[i] / ops);
+            else printf("  %s n/a", sn_perf_event_name(i));
+        }
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    bool use_perf = false;
+    uint64_t repeat = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--perf") == 0) {
+            use_perf = true;
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = strtoull(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "usage: %s [--perf] [--repeat N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SnPerfCounters counters;
+    if (use_perf && !sn_perf_counters_open(&counters)) {
+        fprintf(stderr, "hardware counters unavailable, reporting wall time only\n");
+        use_perf = false;
+    }
+
+    memory = malloc(MB(8));
+    ptrs = malloc(sizeof(void *) * POOL_BLOCKS);
+    if (!memory || !ptrs) return 1;
+
+    srand(0xC0FFEE);
+
+    for (uint64_t i = 0; i < sizeof(benches) / sizeof(benches[0]); ++i) {
+        const SnBench *bench = &benches[i];
+
+        // Report the fastest repetition, it is the least disturbed one
+        uint64_t best_ns = UINT64_MAX, best_ops = 0;
+        SnPerfSample best_sample = {0};
+
+        for (uint64_t r = 0; r < repeat; ++r) {
+            bench->setup();
+
+            SnPerfSample sample;
+            if (use_perf) sn_perf_counters_start(&counters);
+            uint64_t start = now_ns();
+
+            uint64_t ops = bench->run();
+
+            uint64_t ns = now_ns() - start;
+            if (use_perf) sn_perf_counters_stop(&counters, &sample);
+
+            if (ops && ns < best_ns) {
+                best_ns = ns;
+                best_ops = ops;
+                if (use_perf) best_sample = sample;
+            }
+        }
+
+        if (best_ops) print_result(bench, best_ops, best_ns, use_perf ? &best_sample : NULL);
+        if (best_ops && bench->report) bench->report();
+    }
+
+    if (use_perf) sn_perf_counters_close(&counters);
+
+    free(ptrs);
+    free(memory);
+
+    return 0;
+}
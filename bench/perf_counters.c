@@ -0,0 +1,141 @@
+#if defined(__linux__)
+    #define _GNU_SOURCE
+#endif
+
+#include "perf_counters.h"
+
+#include <string.h>
+
+static const char *event_names[SN_PERF_EVENT_COUNT] = {
+    [SN_PERF_EVENT_CYCLES] = "cycles",
+    [SN_PERF_EVENT_INSTRUCTIONS] = "instr",
+    [SN_PERF_EVENT_L1D_MISSES] = "l1d-miss",
+    [SN_PERF_EVENT_LLC_MISSES] = "llc-miss",
+    [SN_PERF_EVENT_DTLB_MISSES] = "dtlb-miss",
+    [SN_PERF_EVENT_BRANCH_MISSES] = "br-miss",
+};
+
+const char *sn_perf_event_name(SnPerfEvent event) {
+    if (event >= SN_PERF_EVENT_COUNT) return "unknown";
+    return event_names[event];
+}
+
+#if defined(__linux__)
+
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+
+    #define CACHE_MISS(cache) \
+        ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static int open_event(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+bool sn_perf_counters_open(SnPerfCounters *counters) {
+    if (!counters) return false;
+
+    static const struct {
+        uint32_t type;
+        uint64_t config;
+    } events[SN_PERF_EVENT_COUNT] = {
+        [SN_PERF_EVENT_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        [SN_PERF_EVENT_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        [SN_PERF_EVENT_L1D_MISSES] = {PERF_TYPE_HW_CACHE, CACHE_MISS(PERF_COUNT_HW_CACHE_L1D)},
+        [SN_PERF_EVENT_LLC_MISSES] = {PERF_TYPE_HW_CACHE, CACHE_MISS(PERF_COUNT_HW_CACHE_LL)},
+        [SN_PERF_EVENT_DTLB_MISSES] = {PERF_TYPE_HW_CACHE, CACHE_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+        [SN_PERF_EVENT_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+
+    // Events are opened separately rather than as a group so that one
+    // unsupported event (common in VMs) does not take the others down.
+    for (int i = 0; i < SN_PERF_EVENT_COUNT; ++i)
+        counters->fds[i] = open_event(events[i].type, events[i].config);
+
+    bool any = false;
+    for (int i = 0; i < SN_PERF_EVENT_COUNT; ++i) any |= counters->fds[i] >= 0;
+
+    return any;
+}
+
+void sn_perf_counters_close(SnPerfCounters *counters) {
+    if (!counters) return;
+
+    for (int i = 0; i < SN_PERF_EVENT_COUNT; ++i) {
+        if (counters->fds[i] >= 0) close(counters->fds[i]);
+        counters->fds[i] = -1;
+    }
+}
+
+void sn_perf_counters_start(SnPerfCounters *counters) {
+    if (!counters) return;
+
+    for (int i = 0; i < SN_PERF_EVENT_COUNT; ++i) {
+        if (counters->fds[i] < 0) continue;
+        ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void sn_perf_counters_stop(SnPerfCounters *counters, SnPerfSample *sample) {
+    if (!counters || !sample) return;
+
+    for (int i = 0; i < SN_PERF_EVENT_COUNT; ++i) {
+        if (counters->fds[i] >= 0) ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for (int i = 0; i < SN_PERF_EVENT_COUNT; ++i) {
+        sample->values[i] = 0;
+        sample->valid[i] = false;
+
+        // value, time_enabled, time_running
+        uint64_t data[3];
+        if (counters->fds[i] < 0) continue;
+        if (read(counters->fds[i], data, sizeof(data)) != sizeof(data) || !data[2]) continue;
+
+        // Scale up if the kernel had to multiplex the counter
+        sample->values[i] = data[0];
+        if (data[2] < data[1]) sample->values[i] = (uint64_t)((double)data[0] * data[1] / data[2]);
+        sample->valid[i] = true;
+    }
+}
+
+#else
+
+bool sn_perf_counters_open(SnPerfCounters *counters) {
+    if (!counters) return false;
+
+    for (int i = 0; i < SN_PERF_EVENT_COUNT; ++i) counters->fds[i] = -1;
+
+    return false;
+}
+
+void sn_perf_counters_close(SnPerfCounters *counters) {
+    (void)counters;
+}
+
+void sn_perf_counters_start(SnPerfCounters *counters) {
+    (void)counters;
+}
+
+void sn_perf_counters_stop(SnPerfCounters *counters, SnPerfSample *sample) {
+    (void)counters;
+    if (!sample) return;
+
+    memset(sample, 0, sizeof(*sample));
+}
+
+#endif
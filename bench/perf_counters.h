@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @enum SnPerfEvent
+ * @brief Hardware events sampled around a measured region.
+ */
+typedef enum SnPerfEvent {
+    SN_PERF_EVENT_CYCLES,
+    SN_PERF_EVENT_INSTRUCTIONS,
+    SN_PERF_EVENT_L1D_MISSES,
+    SN_PERF_EVENT_LLC_MISSES,
+    SN_PERF_EVENT_DTLB_MISSES,
+    SN_PERF_EVENT_BRANCH_MISSES,
+
+    SN_PERF_EVENT_COUNT
+} SnPerfEvent;
+
+/**
+ * @struct SnPerfCounters
+ * @brief Set of opened hardware counters.
+ *
+ * @note Only implemented on Linux (perf_event_open). On other platforms,
+ * or when the kernel refuses access (perf_event_paranoid, containers),
+ * every event is reported as unavailable.
+ */
+typedef struct SnPerfCounters {
+    int fds[SN_PERF_EVENT_COUNT]; /**< Counter file descriptors, -1 if unavailable */
+} SnPerfCounters;
+
+/**
+ * @struct SnPerfSample
+ * @brief Counter values read after a measured region.
+ */
+typedef struct SnPerfSample {
+    uint64_t values[SN_PERF_EVENT_COUNT]; /**< Counts scaled for multiplexing */
+    bool valid[SN_PERF_EVENT_COUNT]; /**< Whether the event could be counted */
+} SnPerfSample;
+
+/**
+ * @brief Open the hardware counters for the calling thread.
+ *
+ * @param counters Pointer to counters.
+ *
+ * @return Returns true if at least one event could be opened.
+ */
+bool sn_perf_counters_open(SnPerfCounters *counters);
+
+/**
+ * @brief Close the hardware counters.
+ *
+ * @param counters Pointer to counters.
+ */
+void sn_perf_counters_close(SnPerfCounters *counters);
+
+/**
+ * @brief Reset and start counting.
+ *
+ * @param counters Pointer to counters.
+ */
+void sn_perf_counters_start(SnPerfCounters *counters);
+
+/**
+ * @brief Stop counting and read the values.
+ *
+ * @param counters Pointer to counters.
+ * @param sample Sample to fill.
+ */
+void sn_perf_counters_stop(SnPerfCounters *counters, SnPerfSample *sample);
+
+/**
+ * @brief Get short name of the event.
+ *
+ * @param event The event.
+ *
+ * @return Returns name of the event.
+ */
+const char *sn_perf_event_name(SnPerfEvent event);
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+/**
+ * @brief Free function that is told the size and alignment of the allocation.
+ */
+typedef void (*SnMemoryFreeSizedFn)(void *data, void *ptr, uint64_t size, uint64_t align);
+
+/**
+ * @brief Returns true if ptr lies in memory managed by the allocator.
+ */
+typedef bool (*SnMemoryOwnsFn)(void *data, const void *ptr);
+
+/**
+ * @struct SnMemoryAdapter
+ * @brief SnMemoryAllocator with optional extra entry points.
+ *
+ * SnMemoryAllocator is defined by SnCore, optional entry points supported
+ * by SnMemory allocators live here. Any of them can be NULL, the
+ * sn_memory_adapter_* functions fall back to the SnMemoryAllocator ones.
+ */
+typedef struct SnMemoryAdapter {
+    SnMemoryAllocator allocator; /**< Base allocator interface */
+    SnMemoryFreeSizedFn free_sized; /**< Free with known size, optional */
+    SnMemoryOwnsFn owns; /**< Ownership query, optional */
+} SnMemoryAdapter;
+
+/**
+ * @brief Create an adapter with only the base interface.
+ *
+ * @param allocator The allocator to wrap.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_memory_adapter_from_allocator(SnMemoryAllocator allocator) {
+    return (SnMemoryAdapter){.allocator = allocator};
+}
+
+/**
+ * @brief Allocate memory through the adapter.
+ *
+ * @param adapter Pointer to the adapter.
+ * @param size Number of bytes to allocate.
+ * @param align The alignment.
+ *
+ * @return Returns pointer to allocated memory or NULL on failure.
+ */
+SN_FORCE_INLINE void *sn_memory_adapter_allocate(const SnMemoryAdapter *adapter, uint64_t size, uint64_t align) {
+    if (!adapter || !adapter->allocator.alloc) return NULL;
+    return adapter->allocator.alloc(adapter->allocator.data, size, align);
+}
+
+/**
+ * @brief Free memory through the adapter.
+ *
+ * @param adapter Pointer to the adapter.
+ * @param ptr Pointer to free.
+ */
+SN_FORCE_INLINE void sn_memory_adapter_free(const SnMemoryAdapter *adapter, void *ptr) {
+    if (!adapter || !adapter->allocator.free) return;
+    adapter->allocator.free(adapter->allocator.data, ptr);
+}
+
+/**
+ * @brief Free memory of known size through the adapter.
+ *
+ * @param adapter Pointer to the adapter.
+ * @param ptr Pointer to free.
+ * @param size Size passed when allocating ptr.
+ * @param align Alignment passed when allocating ptr.
+ *
+ * @note Uses the free function if the adapter has no sized free.
+ */
+SN_FORCE_INLINE void
+    sn_memory_adapter_free_sized(const SnMemoryAdapter *adapter, void *ptr, uint64_t size, uint64_t align) {
+    if (!adapter) return;
+
+    if (adapter->free_sized) adapter->free_sized(adapter->allocator.data, ptr, size, align);
+    else if (adapter->allocator.free) adapter->allocator.free(adapter->allocator.data, ptr);
+}
+
+/**
+ * @brief Check if the adapter owns ptr.
+ *
+ * @param adapter Pointer to the adapter.
+ * @param ptr Pointer to check.
+ *
+ * @return Returns true if ptr belongs to the allocator, false if it does not
+ * or the adapter has no ownership query.
+ */
+SN_FORCE_INLINE bool sn_memory_adapter_owns(const SnMemoryAdapter *adapter, const void *ptr) {
+    if (!adapter || !adapter->owns) return false;
+    return adapter->owns(adapter->allocator.data, ptr);
+}
@@ -0,0 +1,340 @@
+#pragma once
+
+#include "snmemory/adapter.h"
+#include "snmemory/api.h"
+#include "snmemory/pool.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+/**
+ * @struct SnFallbackAllocator
+ * @brief Allocates from primary, and from secondary when primary fails.
+ *
+ * Frees are routed with the primary ownership query, anything primary does
+ * not own goes to secondary.
+ *
+ * @note
+ * - Primary must have an ownership query
+ * - Reallocation stays within the allocator owning the pointer
+ */
+typedef struct SnFallbackAllocator {
+    SnMemoryAdapter primary; /**< Tried first */
+    SnMemoryAdapter secondary; /**< Used when primary fails */
+} SnFallbackAllocator;
+
+/**
+ * @brief Initialize fallback allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param primary Allocator tried first, must have owns
+ * @param secondary Allocator used when primary fails
+ *
+ * @return true on success, false on failure
+ */
+SN_INLINE bool
+    sn_fallback_allocator_init(SnFallbackAllocator *alloc, SnMemoryAdapter primary, SnMemoryAdapter secondary) {
+    if (!alloc || !primary.allocator.alloc || !primary.owns || !secondary.allocator.alloc) return false;
+
+    *alloc = (SnFallbackAllocator){.primary = primary, .secondary = secondary};
+
+    return true;
+}
+
+/**
+ * @brief Allocate memory from fallback allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param size Number of bytes to allocate
+ * @param align Alignment requirement
+ *
+ * @return Pointer to allocated memory or NULL if both allocators fail
+ */
+SN_MEMORY_API void *sn_fallback_allocator_allocate(SnFallbackAllocator *alloc, uint64_t size, uint64_t align);
+
+/**
+ * @brief Reallocate memory allocated by fallback allocator.
+ *
+ * @param alloc Pointer to allocator context.
+ * @param ptr Pointer to memory to reallocate.
+ * @param new_size The new size.
+ * @param align The alignment.
+ *
+ * @return Returns NULL if the owning allocator can not reallocate.
+ */
+SN_MEMORY_API void *sn_fallback_allocator_reallocate(
+    SnFallbackAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align);
+
+/**
+ * @brief Free memory allocated by fallback allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to memory to free
+ */
+SN_MEMORY_API void sn_fallback_allocator_free(SnFallbackAllocator *alloc, void *ptr);
+
+/**
+ * @brief Free memory of known size allocated by fallback allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to memory to free
+ * @param size Size passed when allocating ptr
+ * @param align Alignment passed when allocating ptr
+ */
+SN_MEMORY_API void sn_fallback_allocator_free_sized(
+    SnFallbackAllocator *alloc, void *ptr, uint64_t size, uint64_t align);
+
+/**
+ * @brief Check if ptr belongs to either allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to check
+ */
+SN_MEMORY_API bool sn_fallback_allocator_owns(SnFallbackAllocator *alloc, const void *ptr);
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param alloc Pointer to fallback allocator.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_fallback_allocator_get_allocator(SnFallbackAllocator *alloc) {
+    return (SnMemoryAllocator){
+        .data = alloc,
+        .alloc = (SnMemoryAllocateFn)sn_fallback_allocator_allocate,
+        .realloc = (SnMemoryReallocateFn)sn_fallback_allocator_reallocate,
+        .free = (SnMemoryFreeFn)sn_fallback_allocator_free,
+    };
+}
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to fallback allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_fallback_allocator_get_adapter(SnFallbackAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_fallback_allocator_get_allocator(alloc),
+        .free_sized = (SnMemoryFreeSizedFn)sn_fallback_allocator_free_sized,
+        .owns = (SnMemoryOwnsFn)sn_fallback_allocator_owns,
+    };
+}
+
+/**
+ * @struct SnSegregatorAllocator
+ * @brief Sends sizes up to a threshold to one allocator and larger ones to another.
+ *
+ * Sized frees are routed by size alone. Plain frees need an ownership query
+ * on either side.
+ *
+ * @note Reallocation moves blocks between allocators only when shrinking
+ * below the threshold, growing past it returns NULL as the old size is unknown.
+ */
+typedef struct SnSegregatorAllocator {
+    uint64_t threshold; /**< Largest size served by small */
+    SnMemoryAdapter small; /**< Serves size <= threshold */
+    SnMemoryAdapter large; /**< Serves size > threshold */
+} SnSegregatorAllocator;
+
+/**
+ * @brief Initialize segregator allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param threshold Largest size served by small
+ * @param small Allocator for sizes up to threshold
+ * @param large Allocator for sizes above threshold
+ *
+ * @return true on success, false on failure
+ */
+SN_INLINE bool sn_segregator_allocator_init(
+    SnSegregatorAllocator *alloc, uint64_t threshold, SnMemoryAdapter small, SnMemoryAdapter large) {
+    if (!alloc || !small.allocator.alloc || !large.allocator.alloc) return false;
+
+    *alloc = (SnSegregatorAllocator){.threshold = threshold, .small = small, .large = large};
+
+    return true;
+}
+
+/**
+ * @brief Allocate memory from segregator allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param size Number of bytes to allocate
+ * @param align Alignment requirement
+ *
+ * @return Pointer to allocated memory or NULL on failure
+ */
+SN_FORCE_INLINE void *sn_segregator_allocator_allocate(SnSegregatorAllocator *alloc, uint64_t size, uint64_t align) {
+    if (!alloc) return NULL;
+    return sn_memory_adapter_allocate(size <= alloc->threshold ? &alloc->small : &alloc->large, size, align);
+}
+
+/**
+ * @brief Reallocate memory allocated by segregator allocator.
+ *
+ * @param alloc Pointer to allocator context.
+ * @param ptr Pointer to memory to reallocate.
+ * @param new_size The new size.
+ * @param align The alignment.
+ *
+ * @return Returns NULL if the owning allocator can not reallocate or
+ * new_size grows ptr past the threshold.
+ */
+SN_MEMORY_API void *sn_segregator_allocator_reallocate(
+    SnSegregatorAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align);
+
+/**
+ * @brief Free memory allocated by segregator allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to memory to free
+ *
+ * @note Either small or large must have an ownership query.
+ */
+SN_MEMORY_API void sn_segregator_allocator_free(SnSegregatorAllocator *alloc, void *ptr);
+
+/**
+ * @brief Free memory of known size allocated by segregator allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to memory to free
+ * @param size Size passed when allocating ptr
+ * @param align Alignment passed when allocating ptr
+ */
+SN_FORCE_INLINE void
+    sn_segregator_allocator_free_sized(SnSegregatorAllocator *alloc, void *ptr, uint64_t size, uint64_t align) {
+    if (!ptr || !alloc) return;
+    sn_memory_adapter_free_sized(size <= alloc->threshold ? &alloc->small : &alloc->large, ptr, size, align);
+}
+
+/**
+ * @brief Check if ptr belongs to either allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to check
+ */
+SN_FORCE_INLINE bool sn_segregator_allocator_owns(SnSegregatorAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return sn_memory_adapter_owns(&alloc->small, ptr) || sn_memory_adapter_owns(&alloc->large, ptr);
+}
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param alloc Pointer to segregator allocator.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_segregator_allocator_get_allocator(SnSegregatorAllocator *alloc) {
+    return (SnMemoryAllocator){
+        .data = alloc,
+        .alloc = (SnMemoryAllocateFn)sn_segregator_allocator_allocate,
+        .realloc = (SnMemoryReallocateFn)sn_segregator_allocator_reallocate,
+        .free = (SnMemoryFreeFn)sn_segregator_allocator_free,
+    };
+}
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to segregator allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_segregator_allocator_get_adapter(SnSegregatorAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_segregator_allocator_get_allocator(alloc),
+        .free_sized = (SnMemoryFreeSizedFn)sn_segregator_allocator_free_sized,
+        .owns = (SnMemoryOwnsFn)sn_segregator_allocator_owns,
+    };
+}
+
+/**
+ * @struct SnBucketizerAllocator
+ * @brief Routes allocations to an array of pools by size range.
+ *
+ * Pools are sorted by block size, a request goes to the first pool whose
+ * blocks are big and aligned enough. Pool i serves sizes in
+ * (block_size[i - 1], block_size[i]].
+ *
+ * @note
+ * - Does not spill into a larger pool when one is exhausted
+ * - The pools array must outlive the allocator
+ */
+typedef struct SnBucketizerAllocator {
+    SnPoolAllocator *pools; /**< Pools sorted by block size */
+    uint32_t pool_count; /**< Number of pools */
+} SnBucketizerAllocator;
+
+/**
+ * @brief Initialize bucketizer allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param pools Initialized pools, sorted by increasing block size
+ * @param pool_count Number of pools
+ *
+ * @return true on success, false on failure
+ */
+SN_MEMORY_API bool
+    sn_bucketizer_allocator_init(SnBucketizerAllocator *alloc, SnPoolAllocator *pools, uint32_t pool_count);
+
+/**
+ * @brief Allocate memory from bucketizer allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param size Number of bytes to allocate
+ * @param align Alignment requirement
+ *
+ * @return Pointer to allocated memory or NULL on failure
+ */
+SN_MEMORY_API void *sn_bucketizer_allocator_allocate(SnBucketizerAllocator *alloc, uint64_t size, uint64_t align);
+
+/**
+ * @brief Reallocate memory allocated by bucketizer allocator.
+ *
+ * @param alloc Pointer to allocator context.
+ * @param ptr Pointer to memory to reallocate.
+ * @param new_size The new size.
+ * @param align The alignment.
+ *
+ * @note Returns ptr as is if the new size still fits its block.
+ */
+SN_MEMORY_API void *sn_bucketizer_allocator_reallocate(
+    SnBucketizerAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align);
+
+/**
+ * @brief Free memory allocated by bucketizer allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to memory to free
+ */
+SN_MEMORY_API void sn_bucketizer_allocator_free(SnBucketizerAllocator *alloc, void *ptr);
+
+/**
+ * @brief Check if ptr belongs to one of the pools.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to check
+ */
+SN_MEMORY_API bool sn_bucketizer_allocator_owns(SnBucketizerAllocator *alloc, const void *ptr);
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param alloc Pointer to bucketizer allocator.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_bucketizer_allocator_get_allocator(SnBucketizerAllocator *alloc) {
+    return (SnMemoryAllocator){
+        .data = alloc,
+        .alloc = (SnMemoryAllocateFn)sn_bucketizer_allocator_allocate,
+        .realloc = (SnMemoryReallocateFn)sn_bucketizer_allocator_reallocate,
+        .free = (SnMemoryFreeFn)sn_bucketizer_allocator_free,
+    };
+}
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to bucketizer allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_bucketizer_allocator_get_adapter(SnBucketizerAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_bucketizer_allocator_get_allocator(alloc),
+        .owns = (SnMemoryOwnsFn)sn_bucketizer_allocator_owns,
+    };
+}
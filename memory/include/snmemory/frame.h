@@ -39,6 +39,27 @@ SN_FORCE_INLINE bool sn_frame_allocator_init(SnFrameAllocator *alloc, void *mem,
     return true;
 }
 
+/**
+ * @brief Initialize frame allocator with SnLinearAllocatorFlags.
+ *
+ * @param alloc Pointer to frame allocator
+ * @param mem Memory buffer to manage
+ * @param size Size of memory buffer
+ * @param flags Combination of SnLinearAllocatorFlags
+ *
+ * @return true on success, false on failure
+ *
+ * @note With SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET end() zeroes the memory
+ *       used by the frame, so every frame starts on zeroed memory.
+ */
+SN_FORCE_INLINE bool sn_frame_allocator_init_with_flags(
+    SnFrameAllocator *alloc, void *mem, uint64_t size, uint32_t flags) {
+    if (!alloc || !sn_linear_allocator_init_with_flags(&alloc->arena, mem, size, flags)) return false;
+
+    alloc->frame_mark = NULL;
+    return true;
+}
+
 /**
  * @brief Deinitialize frame allocator.
  *
@@ -107,6 +128,23 @@ SN_FORCE_INLINE void *sn_frame_allocator_allocate(SnFrameAllocator *alloc, uint6
     return sn_linear_allocator_allocate(&alloc->arena, size, align);
 }
 
+/**
+ * @brief Allocate zeroed memory for the current frame.
+ *
+ * @param alloc Pointer to frame allocator
+ * @param size Number of bytes to allocate
+ * @param align Alignment requirement
+ *
+ * @return Pointer to allocated memory or NULL on failure
+ *
+ * @note Free of cost in zero on reset mode.
+ */
+SN_FORCE_INLINE void *
+    sn_frame_allocator_allocate_zeroed(SnFrameAllocator *alloc, uint64_t size, uint64_t align) {
+    if (!alloc) return NULL;
+    return sn_linear_allocator_allocate_zeroed(&alloc->arena, size, align);
+}
+
 /**
  * @brief Get memory used in current frame.
  *
@@ -127,6 +165,19 @@ SN_FORCE_INLINE uint64_t sn_frame_allocator_get_remaining_size(SnFrameAllocator
     return sn_linear_allocator_get_remaining_size(&alloc->arena);
 }
 
+/**
+ * @brief Check if ptr lies in the memory managed by the allocator.
+ *
+ * @param alloc Pointer to frame allocator
+ * @param ptr Pointer to check
+ *
+ * @return Returns true if ptr is inside the managed buffer.
+ */
+SN_FORCE_INLINE bool sn_frame_allocator_owns(SnFrameAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return sn_linear_allocator_owns(&alloc->arena, ptr);
+}
+
 /**
  * @brief Get the SnMemoryAllocator.
  *
@@ -140,3 +191,15 @@ SN_FORCE_INLINE SnMemoryAllocator sn_frame_allocator_get_allocator(SnFrameAlloca
         .free = NULL,
     };
 }
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to frame allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_frame_allocator_get_adapter(SnFrameAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_frame_allocator_get_allocator(alloc),
+        .owns = (SnMemoryOwnsFn)sn_frame_allocator_owns,
+    };
+}
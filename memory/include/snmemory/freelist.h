@@ -1,6 +1,8 @@
 #pragma once
 
+#include "snmemory/adapter.h"
 #include "snmemory/api.h"
+#include "snmemory/vm.h"
 
 #include <sncore/defines.h>
 #include <sncore/types.h>
@@ -14,33 +16,83 @@ typedef struct SnFreeNode {
     #define SN_FREELIST_SPLITTING_THRESHOLD (2 * 16)
 #endif
 
+#ifndef SN_FREELIST_LARGE_THRESHOLD
+    #define SN_FREELIST_LARGE_THRESHOLD (256 * 1024)
+#endif
+
+/**
+ * @struct SnFreeListLargeBlock
+ * @brief Registry entry of an allocation with its own mapping.
+ *
+ * The registry is an open addressing hash table keyed by the block start,
+ * so a block is found in constant expected time.
+ */
+typedef struct SnFreeListLargeBlock {
+    uint8_t *ptr; /**< Start of the mapping, also the user pointer, NULL for an empty entry */
+    uint64_t size; /**< Committed bytes */
+    uint64_t reserved_size; /**< Reserved bytes, the block grows in place up to this */
+} SnFreeListLargeBlock;
+
+/**
+ * @brief Where a free-list allocator places new blocks.
+ *
+ * The free list stays sorted by address under every policy, so freed
+ * blocks coalesce the same way.
+ */
+typedef enum SnFreeListPolicy {
+    SN_FREELIST_FIRST_FIT, /**< First node that fits, scanning from the head */
+    SN_FREELIST_NEXT_FIT, /**< First node that fits, scanning on from the last placement */
+    SN_FREELIST_BEST_FIT, /**< Smallest node that fits, stops early on an exact fit */
+} SnFreeListPolicy;
+
 /**
  * @struct SnFreeListAllocator
  * @brief General-purpose free-list allocator.
  *
  * Manages variable-sized allocations from a user-provided memory buffer.
  *
+ * Allocated blocks keep a 16 byte node header plus at least one padding
+ * byte in front of the user pointer. In compact mode the header is a single
+ * 8 byte size word, padding is only added when the alignment needs it, and
+ * padding that is large enough goes back to the free list.
+ *
+ * Large allocations can bypass the buffer, see
+ * sn_freelist_allocator_enable_large_blocks. They get their own mapping
+ * and go back to the OS as soon as they are freed.
+ *
  * @note
  * - Not thread-safe
- * - No OS allocations
+ * - No OS allocations unless large blocks are enabled
  */
 typedef struct SnFreeListAllocator {
     uint8_t *mem; /**< Base memory pointer */
     uint64_t size; /**< Total size of managed memory */
 
     SnFreeNode *free_list; /**< Head of free block list */
+    SnFreeNode *rover; /**< Next fit resumes after this node, NULL for the head */
+
+    SnFreeListPolicy policy; /**< Placement policy */
+    bool compact; /**< Blocks have 8 byte headers */
+    uint64_t scanned_nodes; /**< Free nodes visited while placing blocks */
+
+    SnFreeListLargeBlock *large_blocks; /**< Registry of large blocks */
+    uint32_t large_capacity; /**< Registry entries */
+    uint32_t large_count; /**< Live large blocks */
+    uint64_t large_threshold; /**< Allocations of at least this size get their own mapping */
 } SnFreeListAllocator;
 
 /**
- * @brief Initialize free-list allocator.
+ * @brief Initialize free-list allocator with a placement policy.
  *
  * @param alloc Pointer to allocator context
  * @param mem Memory buffer to manage
  * @param size Size of memory buffer
+ * @param policy Placement policy
  *
  * @return true on success, false on failure
  */
-SN_INLINE bool sn_freelist_allocator_init(SnFreeListAllocator *alloc, void *mem, uint64_t size) {
+SN_INLINE bool sn_freelist_allocator_init_with_policy(
+    SnFreeListAllocator *alloc, void *mem, uint64_t size, SnFreeListPolicy policy) {
     if (!alloc || !mem || !size) return false;
 
     // Too small buffer
@@ -50,6 +102,8 @@ SN_INLINE bool sn_freelist_allocator_init(SnFreeListAllocator *alloc, void *mem,
         .mem = mem,
         .size = size,
         .free_list = SN_GET_ALIGNED_PTR(mem, SnFreeNode),
+        .policy = policy,
+        .large_threshold = UINT64_MAX,
     };
 
     *alloc->free_list = (SnFreeNode){
@@ -60,15 +114,85 @@ SN_INLINE bool sn_freelist_allocator_init(SnFreeListAllocator *alloc, void *mem,
     return true;
 }
 
+/**
+ * @brief Initialize free-list allocator with compact block headers.
+ *
+ * @param alloc Pointer to allocator context
+ * @param mem Memory buffer to manage
+ * @param size Size of memory buffer
+ * @param policy Placement policy
+ *
+ * @return true on success, false on failure
+ *
+ * @note Sizes are rounded up to multiples of 8 bytes.
+ */
+SN_INLINE bool sn_freelist_allocator_init_compact(
+    SnFreeListAllocator *alloc, void *mem, uint64_t size, SnFreeListPolicy policy) {
+    if (!sn_freelist_allocator_init_with_policy(alloc, mem, size, policy)) return false;
+
+    // Block boundaries stay size word aligned
+    alloc->compact = true;
+    alloc->free_list->size &= ~(sizeof(uint64_t) - 1);
+
+    return true;
+}
+
+/**
+ * @brief Initialize first-fit free-list allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param mem Memory buffer to manage
+ * @param size Size of memory buffer
+ *
+ * @return true on success, false on failure
+ */
+SN_FORCE_INLINE bool sn_freelist_allocator_init(SnFreeListAllocator *alloc, void *mem, uint64_t size) {
+    return sn_freelist_allocator_init_with_policy(alloc, mem, size, SN_FREELIST_FIRST_FIT);
+}
+
+/**
+ * @brief Serve large allocations from their own mappings.
+ *
+ * Allocations of at least threshold bytes are reserved and committed
+ * with sn_vm_* instead of coming from the buffer. Reallocating one
+ * commits or decommits pages in place while it stays within twice the
+ * size it was reserved for. When the registry is full, or the alignment
+ * exceeds the page size, large allocations come from the buffer.
+ *
+ * @param alloc Pointer to allocator context
+ * @param threshold Smallest size to map, 0 for SN_FREELIST_LARGE_THRESHOLD
+ * @param registry Array tracking the mappings, cleared here, must outlive the allocator
+ * @param capacity Number of entries in registry
+ *
+ * @return true on success, false on failure
+ */
+SN_INLINE bool sn_freelist_allocator_enable_large_blocks(
+    SnFreeListAllocator *alloc, uint64_t threshold, SnFreeListLargeBlock *registry, uint32_t capacity) {
+    if (!alloc || !registry || !capacity || alloc->large_count) return false;
+
+    for (uint32_t i = 0; i < capacity; ++i) registry[i] = (SnFreeListLargeBlock){0};
+
+    alloc->large_blocks = registry;
+    alloc->large_capacity = capacity;
+    alloc->large_threshold = threshold ? threshold : SN_FREELIST_LARGE_THRESHOLD;
+
+    return true;
+}
+
 /**
  * @brief Deinitialize free-list allocator.
  *
  * @param alloc Pointer to allocator context
  *
- * @note Does not free memory buffer
+ * @note Does not free memory buffer, releases the large blocks
  */
-SN_FORCE_INLINE void sn_freelist_allocator_deinit(SnFreeListAllocator *alloc) {
+SN_INLINE void sn_freelist_allocator_deinit(SnFreeListAllocator *alloc) {
     if (!alloc) return;
+
+    for (uint32_t i = 0; i < alloc->large_capacity; ++i)
+        if (alloc->large_blocks[i].ptr)
+            sn_vm_release_range(alloc->large_blocks[i].ptr, alloc->large_blocks[i].reserved_size);
+
     *alloc = (SnFreeListAllocator){0};
 }
 
@@ -104,6 +228,58 @@ SN_MEMORY_API void *sn_freelist_allocator_allocate(SnFreeListAllocator *alloc, u
  */
 SN_MEMORY_API void sn_freelist_allocator_free(SnFreeListAllocator *alloc, void *ptr);
 
+/**
+ * @brief Free memory of known size allocated by free-list allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to memory to free
+ * @param size Size passed when allocating ptr
+ * @param align Alignment passed when allocating ptr
+ *
+ * @note
+ * - Skips decoding the padding bytes when align <= alignof(SnFreeNode), in
+ *   compact mode the header is decoded as for sn_freelist_allocator_free
+ * - ptr must be returned by this allocator
+ * - ptr must not be freed twice
+ */
+SN_MEMORY_API void sn_freelist_allocator_free_sized(
+    SnFreeListAllocator *alloc, void *ptr, uint64_t size, uint64_t align);
+
+/**
+ * @brief Allocate multiple blocks of the same size from free-list allocator.
+ *
+ * Blocks are placed by the policy of the allocator. With first fit the
+ * blocks are filled in a single pass over the free list, a node that was too
+ * small for one block is never scanned again.
+ *
+ * @param alloc Pointer to allocator context
+ * @param out_ptrs Array receiving the blocks
+ * @param count Number of blocks to allocate
+ * @param size Size of each block
+ * @param align Alignment of each block
+ *
+ * @return Number of blocks allocated, less than count if memory runs out
+ */
+SN_MEMORY_API uint64_t sn_freelist_allocator_allocate_batch(
+    SnFreeListAllocator *alloc, void **out_ptrs, uint64_t count, uint64_t size, uint64_t align);
+
+/**
+ * @brief Free multiple blocks allocated by free-list allocator.
+ *
+ * Sorts the blocks by address and merges them into the free list in a
+ * single pass, coalescing neighbours on the way.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptrs Blocks to free, NULL entries are ignored
+ * @param count Number of entries in ptrs
+ *
+ * @note
+ * - ptrs is sorted in place
+ * - Every block must be returned by this allocator
+ * - Blocks must not be freed twice
+ */
+SN_MEMORY_API void sn_freelist_allocator_free_batch(SnFreeListAllocator *alloc, void **ptrs, uint64_t count);
+
 /**
  * @brief Reallocate memory allocated by free-list allocator.
  *
@@ -122,6 +298,8 @@ SN_MEMORY_API void *sn_freelist_allocator_reallocate(
  * @brief Get total managed memory size.
  *
  * @param alloc Pointer to allocator context
+ *
+ * @note Covers the buffer only, not large blocks
  */
 SN_FORCE_INLINE uint64_t sn_freelist_allocator_get_total_size(SnFreeListAllocator *alloc) {
     if (!alloc) return 0;
@@ -148,6 +326,86 @@ SN_INLINE uint64_t sn_freelist_allocator_get_free_size(SnFreeListAllocator *allo
     return size;
 }
 
+/**
+ * @brief Get size of the largest free block.
+ *
+ * @param alloc Pointer to allocator context
+ *
+ * @note Together with sn_freelist_allocator_get_free_size this measures fragmentation
+ */
+SN_INLINE uint64_t sn_freelist_allocator_get_largest_free_size(SnFreeListAllocator *alloc) {
+    if (!alloc) return 0;
+    uint64_t size = 0;
+
+    for (SnFreeNode *node = alloc->free_list; node; node = node->next) size = SN_MAX(size, node->size);
+
+    return size;
+}
+
+/**
+ * @brief Get number of free nodes visited while placing blocks.
+ *
+ * @param alloc Pointer to allocator context
+ * @param reset Start counting from zero again
+ */
+SN_FORCE_INLINE uint64_t sn_freelist_allocator_get_scanned_nodes(SnFreeListAllocator *alloc, bool reset) {
+    if (!alloc) return 0;
+    uint64_t scanned = alloc->scanned_nodes;
+    if (reset) alloc->scanned_nodes = 0;
+    return scanned;
+}
+
+/**
+ * @brief Get the registry entry a large block lookup starts probing at.
+ *
+ * @param alloc Pointer to allocator context, large blocks must be enabled
+ * @param ptr Start of the large block
+ */
+SN_FORCE_INLINE uint32_t sn_freelist_allocator_get_large_slot(SnFreeListAllocator *alloc, const void *ptr) {
+    // Blocks start on pages, mix the bits above the page offset
+    uint64_t hash = ((uint64_t)(uintptr_t)ptr >> 12) * 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)((hash >> 32) % alloc->large_capacity);
+}
+
+/**
+ * @brief Find the registry entry of a large block.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Start of the large block
+ *
+ * @return Returns the entry, NULL if ptr does not start a large block
+ */
+SN_INLINE SnFreeListLargeBlock *
+    sn_freelist_allocator_find_large_block(SnFreeListAllocator *alloc, const void *ptr) {
+    if (!alloc || !alloc->large_count) return NULL;
+
+    // Linear probing, a lookup ends at the first empty entry
+    uint32_t i = sn_freelist_allocator_get_large_slot(alloc, ptr);
+    for (uint32_t probed = 0; probed < alloc->large_capacity && alloc->large_blocks[i].ptr; ++probed) {
+        if (alloc->large_blocks[i].ptr == ptr) return &alloc->large_blocks[i];
+        if (++i == alloc->large_capacity) i = 0;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Check if ptr lies in the memory managed by the allocator.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param ptr Pointer to check.
+ *
+ * @return Returns true if ptr is inside the managed buffer or starts a large block.
+ *
+ * @note O(1), large blocks are looked up by their start in the registry hash table.
+ */
+SN_INLINE bool sn_freelist_allocator_owns(SnFreeListAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    if ((const uint8_t *)ptr >= alloc->mem && (const uint8_t *)ptr < alloc->mem + alloc->size) return true;
+
+    return sn_freelist_allocator_find_large_block(alloc, ptr) != NULL;
+}
+
 /**
  * @brief Get the SnMemoryAllocator.
  *
@@ -161,3 +419,16 @@ SN_FORCE_INLINE SnMemoryAllocator sn_freelist_allocator_get_allocator(SnFreeList
         .free = (SnMemoryFreeFn)sn_freelist_allocator_free,
     };
 }
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to freelist allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_freelist_allocator_get_adapter(SnFreeListAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_freelist_allocator_get_allocator(alloc),
+        .free_sized = (SnMemoryFreeSizedFn)sn_freelist_allocator_free_sized,
+        .owns = (SnMemoryOwnsFn)sn_freelist_allocator_owns,
+    };
+}
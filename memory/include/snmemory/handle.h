@@ -0,0 +1,299 @@
+#pragma once
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+#ifndef SN_HANDLE32_INDEX_BITS
+    #define SN_HANDLE32_INDEX_BITS 20
+#endif
+
+#define SN_HANDLE_INVALID 0
+#define SN_HANDLE_NO_INDEX UINT32_MAX
+
+#define SN_HANDLE32_INDEX_MASK ((1U << SN_HANDLE32_INDEX_BITS) - 1)
+
+/**
+ * @brief 64-bit handle, slot index in the low and generation in the high half.
+ */
+typedef uint64_t SnHandle;
+
+/**
+ * @brief 32-bit handle, SN_HANDLE32_INDEX_BITS of index, the rest is generation.
+ *
+ * @note Only the low bits of the generation are kept, so a stale handle is
+ *       missed once its slot was reused 2^(31 - SN_HANDLE32_INDEX_BITS) times.
+ */
+typedef uint32_t SnHandle32;
+
+/**
+ * @struct SnHandlePool
+ * @brief Fixed-size object pool addressed by generational handles.
+ *
+ * Every slot has a generation counter in a dense side array. It is odd
+ * while the slot is live and bumped on allocate and free, so a handle is
+ * valid only while its generation matches. Resolving a handle is a bounds
+ * check and a compare. Slots are handed out from a free list and the
+ * storage only grows up to a high water mark, so iteration walks two
+ * dense arrays.
+ *
+ * @note
+ * - Item size must be >= sizeof(uint32_t)
+ * - None of the sn_handle_pool* functions are thread-safe
+ */
+typedef struct SnHandlePool {
+    uint32_t *generations; /**< Generation of every slot */
+    uint8_t *items; /**< Item storage */
+
+    uint64_t item_size; /**< Size of each item */
+    uint32_t capacity; /**< Number of slots */
+    uint32_t high_water; /**< Slots ever used */
+
+    uint32_t free_index; /**< First free slot below high water */
+    uint32_t live_count; /**< Number of live items */
+} SnHandlePool;
+
+/**
+ * @brief Get the memory needed for a handle pool.
+ *
+ * @param capacity Number of items
+ * @param item_size Size of each item
+ * @param item_align Alignment of each item
+ */
+SN_FORCE_INLINE uint64_t
+    sn_handle_pool_get_required_size(uint32_t capacity, uint64_t item_size, uint64_t item_align) {
+    uint64_t slot_size = sizeof(uint32_t) + SN_GET_ALIGNED(item_size, item_align);
+    return (uint64_t)capacity * slot_size + item_align + alignof(uint32_t);
+}
+
+/**
+ * @brief Initialize a handle pool.
+ *
+ * @param pool Pointer to pool context
+ * @param mem Memory buffer to manage
+ * @param size Size of memory buffer
+ * @param item_size Size of each item (should be >= sizeof(uint32_t))
+ * @param item_align Alignment of each item
+ *
+ * @return true on success, false on failure
+ */
+SN_INLINE bool sn_handle_pool_init(
+    SnHandlePool *pool, void *mem, uint64_t size, uint64_t item_size, uint64_t item_align) {
+    if (!pool || !mem || !item_align) return false;
+
+    item_size = SN_GET_ALIGNED(item_size, item_align);
+    if (item_size < sizeof(uint32_t)) return false;
+
+    uint32_t *generations = SN_GET_ALIGNED_PTR(mem, uint32_t);
+    if ((uint8_t *)generations > ((uint8_t *)mem) + size) return false;
+    uint64_t available = size - SN_PTR_DIFF(generations, mem);
+
+    // Leave room to align the items after the generations
+    if (available < item_align) return false;
+    uint64_t capacity = (available - item_align) / (sizeof(uint32_t) + item_size);
+    capacity = SN_MIN(capacity, (uint64_t)SN_HANDLE_NO_INDEX - 1);
+    if (!capacity) return false;
+
+    *pool = (SnHandlePool){
+        .generations = generations,
+        .items = (uint8_t *)SN_GET_ALIGNED(generations + capacity, item_align),
+        .item_size = item_size,
+        .capacity = (uint32_t)capacity,
+        .free_index = SN_HANDLE_NO_INDEX,
+    };
+
+    return true;
+}
+
+/**
+ * @brief Deinitialize handle pool.
+ *
+ * @note Does not free memory buffer
+ */
+SN_FORCE_INLINE void sn_handle_pool_deinit(SnHandlePool *pool) {
+    if (!pool) return;
+    *pool = (SnHandlePool){0};
+}
+
+/**
+ * @brief Get the item in a slot.
+ *
+ * @param pool Pointer to pool context
+ * @param index Slot index, must be below capacity
+ */
+SN_FORCE_INLINE void *sn_handle_pool_get_item(SnHandlePool *pool, uint32_t index) {
+    return pool->items + (uint64_t)index * pool->item_size;
+}
+
+/**
+ * @brief Allocate an item.
+ *
+ * @param pool Pointer to pool context
+ * @param out_item Receives the item, can be NULL
+ *
+ * @return Handle of the item or SN_HANDLE_INVALID if the pool is full
+ */
+SN_INLINE SnHandle sn_handle_pool_allocate(SnHandlePool *pool, void **out_item) {
+    if (!pool) return SN_HANDLE_INVALID;
+
+    uint32_t index = pool->free_index;
+    if (index != SN_HANDLE_NO_INDEX) {
+        // Free slots keep the next free index in the item
+        pool->free_index = *(uint32_t *)sn_handle_pool_get_item(pool, index);
+    } else {
+        if (pool->high_water == pool->capacity) return SN_HANDLE_INVALID;
+        index = pool->high_water++;
+        pool->generations[index] = 0;
+    }
+
+    uint32_t generation = ++pool->generations[index];
+    pool->live_count++;
+
+    if (out_item) *out_item = sn_handle_pool_get_item(pool, index);
+
+    return (SnHandle)generation << 32 | index;
+}
+
+/**
+ * @brief Resolve a handle to its item.
+ *
+ * @param pool Pointer to pool context
+ * @param handle The handle
+ *
+ * @return Pointer to item or NULL if the handle is stale or invalid
+ */
+SN_FORCE_INLINE void *sn_handle_pool_resolve(SnHandlePool *pool, SnHandle handle) {
+    uint32_t index = (uint32_t)handle;
+    if (index >= pool->high_water || pool->generations[index] != (uint32_t)(handle >> 32)) return NULL;
+    return sn_handle_pool_get_item(pool, index);
+}
+
+/**
+ * @brief Check if a handle refers to a live item.
+ *
+ * @param pool Pointer to pool context
+ * @param handle The handle
+ */
+SN_FORCE_INLINE bool sn_handle_pool_is_valid(SnHandlePool *pool, SnHandle handle) {
+    return sn_handle_pool_resolve(pool, handle) != NULL;
+}
+
+/**
+ * @brief Free an item.
+ *
+ * @param pool Pointer to pool context
+ * @param handle Handle of the item
+ *
+ * @return Returns false if the handle is stale or invalid.
+ */
+SN_INLINE bool sn_handle_pool_free(SnHandlePool *pool, SnHandle handle) {
+    if (!pool) return false;
+
+    void *item = sn_handle_pool_resolve(pool, handle);
+    if (!item) return false;
+
+    uint32_t index = (uint32_t)handle;
+
+    // Even generation marks the slot free and invalidates every handle to it
+    pool->generations[index]++;
+    *(uint32_t *)item = pool->free_index;
+    pool->free_index = index;
+    pool->live_count--;
+
+    return true;
+}
+
+/**
+ * @brief Get the handle of a live item.
+ *
+ * @param pool Pointer to pool context
+ * @param item Pointer to the item
+ *
+ * @return Handle of the item or SN_HANDLE_INVALID if it is not live
+ */
+SN_INLINE SnHandle sn_handle_pool_get_handle(SnHandlePool *pool, const void *item) {
+    if (!pool || (const uint8_t *)item < pool->items) return SN_HANDLE_INVALID;
+
+    uint64_t index = SN_PTR_DIFF(item, pool->items) / pool->item_size;
+    if (index >= pool->high_water || !(pool->generations[index] & 1)) return SN_HANDLE_INVALID;
+
+    return (SnHandle)pool->generations[index] << 32 | index;
+}
+
+/**
+ * @brief Iterate over live items.
+ *
+ * @param pool Pointer to pool context
+ * @param cursor Iteration state, start with 0
+ *
+ * @return Next live item or NULL when done
+ *
+ * @note Freeing the returned item while iterating is allowed.
+ */
+SN_INLINE void *sn_handle_pool_iterate(SnHandlePool *pool, uint32_t *cursor) {
+    while (*cursor < pool->high_water) {
+        uint32_t index = (*cursor)++;
+        if (pool->generations[index] & 1) return sn_handle_pool_get_item(pool, index);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Narrow a handle to 32 bits.
+ *
+ * @param handle The handle, its index must fit SN_HANDLE32_INDEX_BITS
+ */
+SN_FORCE_INLINE SnHandle32 sn_handle_to_32(SnHandle handle) {
+    SN_ASSERT((uint32_t)handle <= SN_HANDLE32_INDEX_MASK);
+    return (SnHandle32)(handle >> 32 << SN_HANDLE32_INDEX_BITS) | ((uint32_t)handle & SN_HANDLE32_INDEX_MASK);
+}
+
+/**
+ * @brief Resolve a 32-bit handle to its item.
+ *
+ * @param pool Pointer to pool context
+ * @param handle The handle
+ *
+ * @return Pointer to item or NULL if the handle is stale or invalid
+ */
+SN_FORCE_INLINE void *sn_handle_pool_resolve32(SnHandlePool *pool, SnHandle32 handle) {
+    uint32_t index = handle & SN_HANDLE32_INDEX_MASK;
+    uint32_t generation = handle & ~SN_HANDLE32_INDEX_MASK;
+    if (index >= pool->high_water || pool->generations[index] << SN_HANDLE32_INDEX_BITS != generation) return NULL;
+    return sn_handle_pool_get_item(pool, index);
+}
+
+/**
+ * @brief Free an item through a 32-bit handle.
+ *
+ * @param pool Pointer to pool context
+ * @param handle Handle of the item
+ *
+ * @return Returns false if the handle is stale or invalid.
+ */
+SN_INLINE bool sn_handle_pool_free32(SnHandlePool *pool, SnHandle32 handle) {
+    if (!pool || !sn_handle_pool_resolve32(pool, handle)) return false;
+
+    uint32_t index = handle & SN_HANDLE32_INDEX_MASK;
+    return sn_handle_pool_free(pool, (SnHandle)pool->generations[index] << 32 | index);
+}
+
+/**
+ * @brief Get number of live items.
+ *
+ * @param pool Pointer to pool context
+ */
+SN_FORCE_INLINE uint32_t sn_handle_pool_get_live_count(SnHandlePool *pool) {
+    if (!pool) return 0;
+    return pool->live_count;
+}
+
+/**
+ * @brief Get number of slots.
+ *
+ * @param pool Pointer to pool context
+ */
+SN_FORCE_INLINE uint32_t sn_handle_pool_get_capacity(SnHandlePool *pool) {
+    if (!pool) return 0;
+    return pool->capacity;
+}
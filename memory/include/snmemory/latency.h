@@ -0,0 +1,221 @@
+#pragma once
+
+#include "snmemory/api.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    #include <intrin.h>
+#elif !defined(__aarch64__)
+    #include <time.h>
+#endif
+
+/**
+ * @brief Number of linear sub-buckets per power of two (as bits).
+ *
+ * 3 bits gives 8 sub-buckets, so any recorded value is known within 12.5%.
+ */
+#define SN_LATENCY_SUB_BUCKET_BITS 3
+
+/**
+ * @brief Number of buckets in a latency histogram.
+ */
+#define SN_LATENCY_BUCKET_COUNT ((64 - SN_LATENCY_SUB_BUCKET_BITS + 1) << SN_LATENCY_SUB_BUCKET_BITS)
+
+/**
+ * @struct SnLatencyHistogram
+ * @brief Log-linear (HDR style) histogram of latencies in cycle counter ticks.
+ *
+ * Values below 2^SN_LATENCY_SUB_BUCKET_BITS are recorded exactly, larger
+ * values land in one of the linear sub-buckets of their power of two.
+ *
+ * @note Recording is done by one thread (the allocator owner) while
+ * another thread may snapshot and reset concurrently.
+ */
+typedef struct SnLatencyHistogram {
+    uint64_t counts[SN_LATENCY_BUCKET_COUNT]; /**< Per bucket counts */
+    uint64_t count; /**< Total number of recorded values */
+    uint64_t sum; /**< Sum of recorded values */
+    uint64_t max; /**< Largest recorded value */
+} SnLatencyHistogram;
+
+/**
+ * @struct SnLatencySnapshot
+ * @brief Point in time copy of a latency histogram.
+ */
+typedef SnLatencyHistogram SnLatencySnapshot;
+
+/**
+ * @brief Read the cycle counter.
+ *
+ * Uses rdtsc on x86 and cntvct_el0 on arm64, falls back to nanoseconds
+ * elsewhere.
+ *
+ * @return Returns current counter value.
+ */
+SN_FORCE_INLINE uint64_t sn_cycle_counter(void) {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    return __rdtsc();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    return (uint64_t)_ReadStatusReg(ARM64_CNTVCT);
+#elif defined(__aarch64__)
+    uint64_t value;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Get the frequency of the cycle counter.
+ *
+ * @return Returns ticks per second.
+ *
+ * @note On x86 the first call calibrates against the wall clock and blocks
+ * for about 10 milliseconds, call it from a non-critical thread.
+ */
+SN_MEMORY_API uint64_t sn_cycle_counter_frequency(void);
+
+/**
+ * @brief Initialize a latency histogram.
+ *
+ * @param histogram Pointer to the histogram.
+ */
+SN_MEMORY_API void sn_latency_histogram_init(SnLatencyHistogram *histogram);
+
+/**
+ * @brief Record one latency value.
+ *
+ * @param histogram Pointer to the histogram.
+ * @param ticks The latency in cycle counter ticks.
+ */
+SN_MEMORY_API void sn_latency_histogram_record(SnLatencyHistogram *histogram, uint64_t ticks);
+
+/**
+ * @brief Copy the histogram, optionally resetting it.
+ *
+ * Safe to call from a different thread than the one recording.
+ *
+ * @param histogram Pointer to the histogram.
+ * @param snapshot Pointer to snapshot to fill.
+ * @param reset Whether to reset the histogram while copying.
+ */
+SN_MEMORY_API void
+    sn_latency_histogram_snapshot(SnLatencyHistogram *histogram, SnLatencySnapshot *snapshot, bool reset);
+
+/**
+ * @brief Get the bucket index of a value.
+ *
+ * @param ticks The value.
+ *
+ * @return Returns index in [0, SN_LATENCY_BUCKET_COUNT).
+ */
+SN_MEMORY_API uint32_t sn_latency_bucket_index(uint64_t ticks);
+
+/**
+ * @brief Get the smallest value that lands in the bucket.
+ *
+ * @param index The bucket index.
+ *
+ * @return Returns lower bound of the bucket.
+ */
+SN_MEMORY_API uint64_t sn_latency_bucket_lower_bound(uint32_t index);
+
+/**
+ * @brief Get the value at the given percentile.
+ *
+ * @param snapshot Pointer to snapshot.
+ * @param percentile The percentile in [0, 100].
+ *
+ * @return Returns the upper bound of the bucket holding the percentile,
+ * or 0 if snapshot is empty.
+ */
+SN_MEMORY_API uint64_t sn_latency_snapshot_percentile(SnLatencySnapshot *snapshot, double percentile);
+
+/**
+ * @struct SnLatencyAllocator
+ * @brief Wraps a SnMemoryAllocator and records latency of every call.
+ *
+ * @note Recording is compiled only when SN_MEMORY_LATENCY_HOOKS is defined
+ * (SN_MEMORY_ENABLE_LATENCY_HOOKS cmake option). Otherwise
+ * sn_latency_allocator_get_allocator returns the wrapped allocator as is,
+ * so the hooks cost nothing on the hot path.
+ */
+typedef struct SnLatencyAllocator {
+    SnMemoryAllocator allocator; /**< The wrapped allocator */
+    SnLatencyHistogram allocate; /**< Latency of alloc calls */
+    SnLatencyHistogram reallocate; /**< Latency of realloc calls */
+    SnLatencyHistogram free; /**< Latency of free calls */
+} SnLatencyAllocator;
+
+/**
+ * @brief Initialize latency allocator.
+ *
+ * @param alloc Pointer to latency allocator.
+ * @param allocator The allocator to wrap.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_INLINE bool sn_latency_allocator_init(SnLatencyAllocator *alloc, SnMemoryAllocator allocator) {
+    if (!alloc || !allocator.alloc) return false;
+
+    alloc->allocator = allocator;
+    sn_latency_histogram_init(&alloc->allocate);
+    sn_latency_histogram_init(&alloc->reallocate);
+    sn_latency_histogram_init(&alloc->free);
+
+    return true;
+}
+
+#if defined(SN_MEMORY_LATENCY_HOOKS)
+
+SN_INLINE void *sn_latency_allocator_allocate(SnLatencyAllocator *alloc, uint64_t size, uint64_t align) {
+    uint64_t start = sn_cycle_counter();
+    void *ptr = alloc->allocator.alloc(alloc->allocator.data, size, align);
+    sn_latency_histogram_record(&alloc->allocate, sn_cycle_counter() - start);
+    return ptr;
+}
+
+SN_INLINE void *
+    sn_latency_allocator_reallocate(SnLatencyAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align) {
+    uint64_t start = sn_cycle_counter();
+    void *new_ptr = alloc->allocator.realloc(alloc->allocator.data, ptr, new_size, align);
+    sn_latency_histogram_record(&alloc->reallocate, sn_cycle_counter() - start);
+    return new_ptr;
+}
+
+SN_INLINE void sn_latency_allocator_free(SnLatencyAllocator *alloc, void *ptr) {
+    uint64_t start = sn_cycle_counter();
+    alloc->allocator.free(alloc->allocator.data, ptr);
+    sn_latency_histogram_record(&alloc->free, sn_cycle_counter() - start);
+}
+
+#endif
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param alloc Pointer to latency allocator.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_latency_allocator_get_allocator(SnLatencyAllocator *alloc) {
+#if defined(SN_MEMORY_LATENCY_HOOKS)
+    return (SnMemoryAllocator){
+        .data = alloc,
+        .alloc = (SnMemoryAllocateFn)sn_latency_allocator_allocate,
+        .realloc = alloc->allocator.realloc ? (SnMemoryReallocateFn)sn_latency_allocator_reallocate : NULL,
+        .free = alloc->allocator.free ? (SnMemoryFreeFn)sn_latency_allocator_free : NULL,
+    };
+#else
+    return alloc->allocator;
+#endif
+}
@@ -1,18 +1,39 @@
 #pragma once
 
+#include "snmemory/adapter.h"
+#include "snmemory/api.h"
+
 #include <sncore/defines.h>
 #include <sncore/types.h>
 
+/**
+ * @enum SnLinearAllocatorFlags
+ * @brief Flags for @ref sn_linear_allocator_init_with_flags.
+ */
+typedef enum SnLinearAllocatorFlags {
+    SN_LINEAR_ALLOCATOR_FLAG_NONE = 0, /**< Memory is handed out as it is */
+    SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET = 1 << 0, /**< Memory given back is zeroed, allocations are zero */
+    SN_LINEAR_ALLOCATOR_FLAG_ZEROED = 1 << 1, /**< The memory passed to init is already zero */
+    SN_LINEAR_ALLOCATOR_FLAG_VM_BACKED = 1 << 2, /**< The memory is committed sn_vm_* memory */
+} SnLinearAllocatorFlags;
+
 /**
  * @struct SnLinearAllocator
  * @brief Struct to store linear allocator context.
  *
+ * Memory past the dirty high-water mark (the larger of dirty_end and top)
+ * has never been handed out since it was last zeroed, so allocations there
+ * are known to be zero.
+ *
  * @note None of the sn_linear_allocator* functions is thread-safe.
  */
 typedef struct SnLinearAllocator {
     uint8_t *mem; /**< Pointer to memory */
     uint8_t *top; /**< Pointer to top of memory */
     uint64_t size; /**< Size of the memory */
+
+    uint8_t *dirty_end; /**< Highest top before the last reset, end of memory if the contents are unknown */
+    uint32_t flags; /**< SnLinearAllocatorFlags */
 } SnLinearAllocator;
 
 /**
@@ -38,11 +59,44 @@ SN_FORCE_INLINE bool sn_linear_allocator_init(SnLinearAllocator *alloc, void *me
         .mem = (uint8_t *)mem,
         .top = (uint8_t *)mem,
         .size = size,
+        .dirty_end = (uint8_t *)mem + size,
     };
 
     return true;
 }
 
+/**
+ * @brief Initialize a linear allocator with SnLinearAllocatorFlags.
+ *
+ * With SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET the memory handed back by
+ * reset and free_to_memory_mark is zeroed right away, only up to the dirty
+ * high-water mark. Large spans are written with non-temporal stores, whole
+ * pages of VM-backed memory are given back to the OS instead.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param mem The memory to handle.
+ * @param size Size of the memory to handle.
+ * @param flags Combination of SnLinearAllocatorFlags.
+ *
+ * @return Returns true on success, false otherwise.
+ *
+ * @note Unless SN_LINEAR_ALLOCATOR_FLAG_ZEROED is passed, zero on reset mode
+ *       zeroes the memory here.
+ */
+SN_MEMORY_API bool sn_linear_allocator_init_with_flags(
+    SnLinearAllocator *alloc, void *mem, uint64_t size, uint32_t flags);
+
+/**
+ * @brief Zero memory of the allocator, the way its flags allow.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param start Start of the range.
+ * @param end End of the range.
+ *
+ * @note Used by reset, free_to_memory_mark and allocate_zeroed.
+ */
+SN_MEMORY_API void sn_linear_allocator_zero_range(SnLinearAllocator *alloc, uint8_t *start, uint8_t *end);
+
 /**
  * @breif Deinitialize linear allocator.
  *
@@ -68,6 +122,12 @@ SN_FORCE_INLINE void
     if (!alloc) return;
     SN_ASSERT(alloc->mem + alloc->size == mem);
     alloc->size += size;
+
+    // Nothing is known about the new memory
+    if (alloc->flags & SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET)
+        sn_linear_allocator_zero_range(alloc, (uint8_t *)mem, (uint8_t *)mem + size);
+    else
+        alloc->dirty_end = alloc->mem + alloc->size;
 }
 
 /**
@@ -92,14 +152,49 @@ SN_INLINE void *sn_linear_allocator_allocate(SnLinearAllocator *alloc, uint64_t
     return aligned;
 }
 
+/**
+ * @brief Allocate zeroed memory from the linear allocator.
+ *
+ * Only the part below the dirty high-water mark is written, in zero on
+ * reset mode nothing is.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param size Number of bytes to allocate.
+ * @param align The alignment.
+ *
+ * @return Returns pointer to allocated memory or NULL on failure.
+ */
+SN_INLINE void *sn_linear_allocator_allocate_zeroed(SnLinearAllocator *alloc, uint64_t size, uint64_t align) {
+    uint8_t *ptr = (uint8_t *)sn_linear_allocator_allocate(alloc, size, align);
+    if (!ptr) return NULL;
+
+    // Memory past the dirty high-water mark is zero already
+    if (ptr < alloc->dirty_end) {
+        uint8_t *end = ptr + size;
+        sn_linear_allocator_zero_range(alloc, ptr, SN_MIN(end, alloc->dirty_end));
+    }
+
+    return ptr;
+}
+
 /**
  * @brief Clear all allocations from the linear allocator.
  *
  * @param alloc Pointer to the allocator context.
+ *
+ * @note Zeroes the used memory in zero on reset mode.
  */
 SN_FORCE_INLINE void sn_linear_allocator_reset(SnLinearAllocator *alloc) {
     if (!alloc) return;
+
+    uint8_t *dirty_end = SN_MAX(alloc->dirty_end, alloc->top);
+    if (alloc->flags & SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET) {
+        sn_linear_allocator_zero_range(alloc, alloc->mem, dirty_end);
+        dirty_end = alloc->mem;
+    }
+
     alloc->top = alloc->mem;
+    alloc->dirty_end = dirty_end;
 }
 
 /**
@@ -148,13 +243,37 @@ SN_FORCE_INLINE snMemoryMark sn_linear_allocator_get_memory_mark(SnLinearAllocat
  *
  * @param alloc Pointer to allocator context.
  * @param mark The mark
+ *
+ * @note Zeroes the memory past the mark in zero on reset mode.
  */
 SN_FORCE_INLINE void sn_linear_allocator_free_to_memory_mark(SnLinearAllocator *alloc, snMemoryMark mark) {
     if (!alloc || !mark) return;
 
     SN_ASSERT(((uint64_t)mark) >= ((uint64_t)alloc->mem));
     SN_ASSERT(((uint64_t)mark) <= ((uint64_t)(alloc->mem + alloc->size)));
-    if (alloc->top > mark) alloc->top = mark;
+    if (alloc->top <= mark) return;
+
+    uint8_t *dirty_end = SN_MAX(alloc->dirty_end, alloc->top);
+    if (alloc->flags & SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET) {
+        sn_linear_allocator_zero_range(alloc, mark, dirty_end);
+        dirty_end = mark;
+    }
+
+    alloc->top = mark;
+    alloc->dirty_end = dirty_end;
+}
+
+/**
+ * @brief Check if ptr lies in the memory managed by the allocator.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param ptr Pointer to check.
+ *
+ * @return Returns true if ptr is inside the managed buffer.
+ */
+SN_FORCE_INLINE bool sn_linear_allocator_owns(SnLinearAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return (const uint8_t *)ptr >= alloc->mem && (const uint8_t *)ptr < alloc->mem + alloc->size;
 }
 
 /**
@@ -170,3 +289,15 @@ SN_FORCE_INLINE SnMemoryAllocator sn_linear_allocator_get_allocator(SnLinearAllo
         .free = NULL,
     };
 }
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to linear allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_linear_allocator_get_adapter(SnLinearAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_linear_allocator_get_allocator(alloc),
+        .owns = (SnMemoryOwnsFn)sn_linear_allocator_owns,
+    };
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "snmemory/api.h"
+#include "snmemory/latency.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+#ifndef SN_LOCK_SPIN_COUNT
+    #define SN_LOCK_SPIN_COUNT 128
+#endif
+
+#ifndef SN_LOCK_TICKET_BACKOFF
+    #define SN_LOCK_TICKET_BACKOFF 32
+#endif
+
+// Storage for the platform mutex and condition variable, checked in locked.c
+#ifndef SN_LOCK_MUTEX_STORAGE
+    #define SN_LOCK_MUTEX_STORAGE 64
+#endif
+
+#ifndef SN_LOCK_CONDITION_STORAGE
+    #define SN_LOCK_CONDITION_STORAGE 64
+#endif
+
+/**
+ * @enum SnLockKind
+ * @brief Lock implementation used by SnLock.
+ */
+typedef enum SnLockKind {
+    SN_LOCK_KIND_MUTEX, /**< Platform mutex (pthread mutex / SRW lock) */
+    SN_LOCK_KIND_TICKET, /**< FIFO ticket spinlock, backs off in proportion to the queue length */
+    SN_LOCK_KIND_ADAPTIVE, /**< Spins SN_LOCK_SPIN_COUNT times, then parks the thread */
+} SnLockKind;
+
+/**
+ * @struct SnLock
+ * @brief Lock with a selectable implementation.
+ *
+ * @note Must not move after init.
+ */
+typedef struct SnLock {
+    SnLockKind kind; /**< The implementation */
+
+    uint64_t next_ticket; /**< Ticket: next ticket handed out */
+    uint64_t now_serving; /**< Ticket: ticket holding the lock */
+
+    uint64_t state; /**< Adaptive: 0 free, 1 locked, 2 locked with parked waiters */
+
+    alignas(16) uint8_t mutex[SN_LOCK_MUTEX_STORAGE]; /**< Mutex, parking lot of the adaptive lock */
+    alignas(16) uint8_t condition[SN_LOCK_CONDITION_STORAGE]; /**< Adaptive: parked waiters */
+} SnLock;
+
+/**
+ * @brief Initialize lock.
+ *
+ * @param lock Pointer to lock
+ * @param kind The implementation
+ *
+ * @return true on success, false on failure
+ */
+SN_MEMORY_API bool sn_lock_init(SnLock *lock, SnLockKind kind);
+
+/**
+ * @brief Deinitialize lock.
+ *
+ * @param lock Pointer to lock, must be unlocked
+ */
+SN_MEMORY_API void sn_lock_deinit(SnLock *lock);
+
+/**
+ * @brief Acquire lock.
+ *
+ * @param lock Pointer to lock
+ *
+ * @return Returns true if the lock was taken and the caller had to wait.
+ */
+SN_MEMORY_API bool sn_lock_acquire(SnLock *lock);
+
+/**
+ * @brief Release lock.
+ *
+ * @param lock Pointer to lock
+ */
+SN_MEMORY_API void sn_lock_release(SnLock *lock);
+
+/**
+ * @struct SnLockStats
+ * @brief Contention statistics of a SnLockedAllocator.
+ */
+typedef struct SnLockStats {
+    uint64_t acquire_count; /**< Number of lock acquisitions */
+    uint64_t contended_count; /**< Acquisitions that had to wait */
+    SnLatencySnapshot hold_time; /**< Lock hold times in cycle counter ticks */
+} SnLockStats;
+
+/**
+ * @struct SnLockedAllocator
+ * @brief Serializes every call of a SnMemoryAllocator with a lock.
+ *
+ * Makes any single-threaded allocator usable from several threads.
+ * Instrumentation, when enabled at init, counts contended acquisitions and
+ * records hold times in a latency histogram.
+ *
+ * @note
+ * - Thread-safe
+ * - Must not move after init
+ */
+typedef struct SnLockedAllocator {
+    SnMemoryAllocator allocator; /**< The wrapped allocator */
+    SnLock lock; /**< Lock around every call */
+
+    bool instrument; /**< Whether statistics are recorded */
+    uint64_t acquire_count; /**< Number of lock acquisitions */
+    uint64_t contended_count; /**< Acquisitions that had to wait */
+    SnLatencyHistogram hold_time; /**< Lock hold times */
+} SnLockedAllocator;
+
+/**
+ * @brief Initialize locked allocator.
+ *
+ * @param alloc Pointer to locked allocator
+ * @param allocator The allocator to wrap
+ * @param kind Lock implementation
+ * @param instrument Whether to record contention and hold times
+ *
+ * @return true on success, false on failure
+ */
+SN_MEMORY_API bool sn_locked_allocator_init(
+    SnLockedAllocator *alloc, SnMemoryAllocator allocator, SnLockKind kind, bool instrument);
+
+/**
+ * @brief Deinitialize locked allocator.
+ *
+ * @param alloc Pointer to locked allocator
+ *
+ * @note Does not deinitialize the wrapped allocator.
+ */
+SN_MEMORY_API void sn_locked_allocator_deinit(SnLockedAllocator *alloc);
+
+/**
+ * @brief Allocate memory under the lock.
+ *
+ * @param alloc Pointer to locked allocator
+ * @param size Number of bytes to allocate
+ * @param align Alignment requirement
+ *
+ * @return Pointer to allocated memory or NULL on failure
+ */
+SN_MEMORY_API void *sn_locked_allocator_allocate(SnLockedAllocator *alloc, uint64_t size, uint64_t align);
+
+/**
+ * @brief Reallocate memory under the lock.
+ *
+ * @param alloc Pointer to locked allocator
+ * @param ptr Pointer to memory to reallocate
+ * @param new_size The new size
+ * @param align The alignment
+ *
+ * @return Returns NULL on failure or if the wrapped allocator can not reallocate.
+ */
+SN_MEMORY_API void *
+    sn_locked_allocator_reallocate(SnLockedAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align);
+
+/**
+ * @brief Free memory under the lock.
+ *
+ * @param alloc Pointer to locked allocator
+ * @param ptr Pointer to memory to free
+ */
+SN_MEMORY_API void sn_locked_allocator_free(SnLockedAllocator *alloc, void *ptr);
+
+/**
+ * @brief Copy the statistics, optionally resetting them.
+ *
+ * @param alloc Pointer to locked allocator
+ * @param stats Pointer to stats to fill
+ * @param reset Whether to reset the statistics while copying
+ */
+SN_MEMORY_API void sn_locked_allocator_get_stats(SnLockedAllocator *alloc, SnLockStats *stats, bool reset);
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param alloc Pointer to locked allocator.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_locked_allocator_get_allocator(SnLockedAllocator *alloc) {
+    return (SnMemoryAllocator){
+        .data = alloc,
+        .alloc = (SnMemoryAllocateFn)sn_locked_allocator_allocate,
+        .realloc = alloc->allocator.realloc ? (SnMemoryReallocateFn)sn_locked_allocator_reallocate : NULL,
+        .free = alloc->allocator.free ? (SnMemoryFreeFn)sn_locked_allocator_free : NULL,
+    };
+}
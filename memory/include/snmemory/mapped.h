@@ -0,0 +1,151 @@
+#pragma once
+
+#include "snmemory/api.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+/**
+ * @enum SnMappedFileFlags
+ * @brief Flags for @ref sn_mapped_file_open.
+ */
+typedef enum SnMappedFileFlags {
+    SN_MAPPED_FILE_FLAG_NONE = 0, /**< Open an existing file read-write, writes reach the file */
+    SN_MAPPED_FILE_FLAG_CREATE = 1 << 0, /**< Create the file if it does not exist */
+    SN_MAPPED_FILE_FLAG_READ_ONLY = 1 << 1, /**< Map read-only */
+    SN_MAPPED_FILE_FLAG_PRIVATE = 1 << 2, /**< Copy on write, writes never reach the file */
+} SnMappedFileFlags;
+
+/**
+ * @enum SnMappedFileAdvice
+ * @brief Access pattern hints for @ref sn_mapped_file_advise.
+ */
+typedef enum SnMappedFileAdvice {
+    SN_MAPPED_FILE_ADVICE_NORMAL, /**< No particular pattern */
+    SN_MAPPED_FILE_ADVICE_SEQUENTIAL, /**< Read ahead aggressively */
+    SN_MAPPED_FILE_ADVICE_RANDOM, /**< Do not read ahead */
+    SN_MAPPED_FILE_ADVICE_WILLNEED, /**< Start reading the range in now */
+    SN_MAPPED_FILE_ADVICE_DONTNEED, /**< Drop the range from memory, it is read back on access */
+} SnMappedFileAdvice;
+
+/**
+ * @struct SnMappedFile
+ * @brief A file mapped into memory.
+ *
+ * The mapping is a plain memory range, so base and size can be handed to
+ * any sn_*_allocator_init to keep allocations in the file. Reopening the
+ * file brings the state back without rebuilding it, and processes mapping
+ * the same file share it.
+ *
+ * @note
+ * - Allocator contexts and their blocks hold absolute pointers, they are
+ *   only valid while the file is mapped at the same base. Store offsets
+ *   (@ref sn_offset_from_ptr) in data that outlives the mapping
+ * - None of the sn_mapped_file* functions are thread-safe
+ */
+typedef struct SnMappedFile {
+    void *base; /**< Start of the mapping */
+    uint64_t size; /**< Size of the mapping, same as the file size */
+    intptr_t file; /**< File descriptor or handle */
+    intptr_t mapping; /**< File mapping handle on Windows, unused elsewhere */
+    uint32_t flags; /**< SnMappedFileFlags the file was opened with */
+} SnMappedFile;
+
+/**
+ * @brief Open a file and map it.
+ *
+ * @param file Receives the mapping.
+ * @param path Path of the file.
+ * @param size Size to map. A smaller file is extended with zeros, unless it is read-only.
+ *             Pass 0 to map the whole existing file.
+ * @param flags Combination of SnMappedFileFlags.
+ * @param address Preferred base address (hint). Pass NULL to let the OS pick.
+ *
+ * @return Returns true on success, false otherwise.
+ *
+ * @note The address is a hint, compare it with file->base to know if
+ *       pointers stored in the file are still valid.
+ */
+SN_MEMORY_API bool sn_mapped_file_open(
+    SnMappedFile *file, const char *path, uint64_t size, uint32_t flags, void *address);
+
+/**
+ * @brief Unmap the file and close it.
+ *
+ * @note Shared writes reach the file eventually, use @ref sn_mapped_file_sync
+ *       to know when they are durable.
+ */
+SN_MEMORY_API void sn_mapped_file_close(SnMappedFile *file);
+
+/**
+ * @brief Write modified pages of a range back to the file.
+ *
+ * @param file Pointer to the mapping.
+ * @param ptr Start of the range, rounded down to the page.
+ * @param size Size of the range in bytes.
+ * @param wait Wait until the data is durable (MS_SYNC), otherwise only schedule the writes (MS_ASYNC).
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_mapped_file_sync(SnMappedFile *file, void *ptr, uint64_t size, bool wait);
+
+/**
+ * @brief Hint the expected access pattern of a range.
+ *
+ * @param file Pointer to the mapping.
+ * @param ptr Start of the range, rounded down to the page.
+ * @param size Size of the range in bytes.
+ * @param advice One of SnMappedFileAdvice.
+ *
+ * @return Returns true on success, false otherwise.
+ *
+ * @note Hints without an equivalent on the platform are ignored and succeed.
+ */
+SN_MEMORY_API bool sn_mapped_file_advise(
+    SnMappedFile *file, void *ptr, uint64_t size, SnMappedFileAdvice advice);
+
+/**
+ * @brief Check if a pointer lies inside the mapping.
+ *
+ * @param file Pointer to the mapping.
+ * @param ptr The pointer.
+ */
+SN_FORCE_INLINE bool sn_mapped_file_owns(SnMappedFile *file, const void *ptr) {
+    if (!file || !file->base) return false;
+
+    const uint8_t *base = (const uint8_t *)file->base;
+    return (const uint8_t *)ptr >= base && (const uint8_t *)ptr < base + file->size;
+}
+
+/**
+ * @brief Turn a pointer into an offset from a base.
+ *
+ * Offsets are position independent, they stay valid when the same memory
+ * is mapped at another address, in another process or after a restart.
+ *
+ * @param base Start of the region, usually file->base.
+ * @param ptr Pointer inside the region, past the base, or NULL.
+ *
+ * @return Returns the offset, 0 for NULL.
+ *
+ * @note Offset 0 stands for NULL, so the first byte of the region can not be referenced.
+ */
+SN_FORCE_INLINE uint64_t sn_offset_from_ptr(const void *base, const void *ptr) {
+    if (!ptr) return 0;
+
+    SN_ASSERT((const uint8_t *)ptr > (const uint8_t *)base);
+    return SN_PTR_DIFF(ptr, base);
+}
+
+/**
+ * @brief Turn an offset from @ref sn_offset_from_ptr back into a pointer.
+ *
+ * @param base Start of the region, where it is mapped now.
+ * @param offset The offset.
+ *
+ * @return Returns the pointer, NULL for offset 0.
+ */
+SN_FORCE_INLINE void *sn_offset_to_ptr(void *base, uint64_t offset) {
+    if (!offset) return NULL;
+    return ((uint8_t *)base) + offset;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "snmemory/adapter.h"
+#include "snmemory/api.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+/**
+ * @struct SnOwnedHeap
+ * @brief Single-threaded allocator owned by one thread, freeable from any thread.
+ *
+ * Only the owner allocates. A free from the owner goes straight to the
+ * backend, a free from any other thread pushes the block onto a lock-free
+ * remote-free list. The owner takes the whole list with one exchange and
+ * frees it in batch on its next allocate, so the owner path only does a
+ * relaxed load of the list head.
+ *
+ * @note
+ * - Allocate, drain and deinit must be called from the owner thread
+ * - Free is thread-safe
+ * - Blocks are at least sizeof(void *), the link is stored in the freed block
+ * - Must not move after init
+ */
+typedef struct SnOwnedHeap {
+    SnMemoryAdapter backend; /**< Allocator owned by the thread, pool, slab or free-list */
+    uint64_t owner; /**< Id of the owner thread */
+
+    alignas(64) uint64_t remote_head; /**< Blocks freed by other threads, written by them */
+} SnOwnedHeap;
+
+/**
+ * @brief Initialize owned heap, owned by the calling thread.
+ *
+ * @param heap Pointer to heap context
+ * @param backend Allocator to own, not required to be thread-safe
+ *
+ * @return true on success, false on failure
+ */
+SN_MEMORY_API bool sn_owned_heap_init(SnOwnedHeap *heap, SnMemoryAdapter backend);
+
+/**
+ * @brief Deinitialize owned heap, returning remotely freed blocks to the backend.
+ *
+ * @param heap Pointer to heap context
+ *
+ * @note No other thread may free into the heap anymore.
+ */
+SN_MEMORY_API void sn_owned_heap_deinit(SnOwnedHeap *heap);
+
+/**
+ * @brief Make the calling thread the owner.
+ *
+ * @param heap Pointer to heap context
+ *
+ * @note The previous owner must have stopped using the heap, the hand-over
+ *       itself has to be synchronized by the caller.
+ */
+SN_MEMORY_API void sn_owned_heap_set_owner(SnOwnedHeap *heap);
+
+/**
+ * @brief Check if the calling thread owns the heap.
+ *
+ * @param heap Pointer to heap context
+ */
+SN_MEMORY_API bool sn_owned_heap_is_owner(SnOwnedHeap *heap);
+
+/**
+ * @brief Allocate memory, draining remote frees first.
+ *
+ * @param heap Pointer to heap context
+ * @param size Number of bytes to allocate
+ * @param align Alignment requirement
+ *
+ * @return Pointer to allocated memory or NULL on failure
+ */
+SN_MEMORY_API void *sn_owned_heap_allocate(SnOwnedHeap *heap, uint64_t size, uint64_t align);
+
+/**
+ * @brief Free memory from any thread.
+ *
+ * @param heap Pointer to heap context
+ * @param ptr Pointer to memory to free
+ */
+SN_MEMORY_API void sn_owned_heap_free(SnOwnedHeap *heap, void *ptr);
+
+/**
+ * @brief Return every remotely freed block to the backend.
+ *
+ * @param heap Pointer to heap context
+ *
+ * @return Number of blocks freed
+ */
+SN_MEMORY_API uint64_t sn_owned_heap_drain(SnOwnedHeap *heap);
+
+/**
+ * @brief Check if ptr belongs to the backend.
+ *
+ * @param heap Pointer to heap context
+ * @param ptr Pointer to check
+ *
+ * @return Returns false if the backend has no ownership query.
+ */
+SN_FORCE_INLINE bool sn_owned_heap_owns(SnOwnedHeap *heap, const void *ptr) {
+    if (!heap) return false;
+    return sn_memory_adapter_owns(&heap->backend, ptr);
+}
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param heap Pointer to owned heap.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_owned_heap_get_allocator(SnOwnedHeap *heap) {
+    return (SnMemoryAllocator){
+        .data = heap,
+        .alloc = (SnMemoryAllocateFn)sn_owned_heap_allocate,
+        .realloc = NULL,
+        .free = (SnMemoryFreeFn)sn_owned_heap_free,
+    };
+}
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param heap Pointer to owned heap.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_owned_heap_get_adapter(SnOwnedHeap *heap) {
+    return (SnMemoryAdapter){
+        .allocator = sn_owned_heap_get_allocator(heap),
+        .free_sized = NULL,
+        .owns = (SnMemoryOwnsFn)sn_owned_heap_owns,
+    };
+}
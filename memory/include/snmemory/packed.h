@@ -0,0 +1,165 @@
+#pragma once
+
+#include "snmemory/api.h"
+#include "snmemory/handle.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+/**
+ * @struct SnPackedSlot
+ * @brief Sparse entry of a packed pool.
+ */
+typedef struct SnPackedSlot {
+    uint32_t dense; /**< Index of the item, next free slot while free */
+    uint32_t generation; /**< Odd while live */
+} SnPackedSlot;
+
+/**
+ * @struct SnPackedPool
+ * @brief Fixed-size object pool keeping live items contiguous.
+ *
+ * Items are stored densely from index 0 to count - 1. Removing an item
+ * moves the last item into its place, so a full iteration is a linear
+ * scan with no holes. Items are named by generational handles through a
+ * sparse slot array, which stays stable while items move.
+ *
+ * @note
+ * - Freeing an item moves another one, pointers to items are only valid
+ *   until the next free
+ * - None of the sn_packed_pool* functions are thread-safe
+ */
+typedef struct SnPackedPool {
+    uint8_t *items; /**< Dense item storage */
+    uint32_t *dense_slots; /**< Slot of every dense item */
+    SnPackedSlot *slots; /**< Sparse slots, indexed by handle */
+
+    uint64_t item_size; /**< Size of each item */
+    uint32_t capacity; /**< Maximum number of items */
+    uint32_t count; /**< Number of live items */
+
+    uint32_t high_water; /**< Slots ever used */
+    uint32_t free_slot; /**< First free slot below high water */
+} SnPackedPool;
+
+/**
+ * @brief Get the memory needed for a packed pool.
+ *
+ * @param capacity Number of items
+ * @param item_size Size of each item
+ * @param item_align Alignment of each item
+ */
+SN_FORCE_INLINE uint64_t
+    sn_packed_pool_get_required_size(uint32_t capacity, uint64_t item_size, uint64_t item_align) {
+    uint64_t slot_size = SN_GET_ALIGNED(item_size, item_align) + sizeof(uint32_t) + sizeof(SnPackedSlot);
+    return (uint64_t)capacity * slot_size + item_align + alignof(uint32_t) + alignof(SnPackedSlot);
+}
+
+/**
+ * @brief Initialize a packed pool.
+ *
+ * @param pool Pointer to pool context
+ * @param mem Memory buffer to manage
+ * @param size Size of memory buffer
+ * @param item_size Size of each item
+ * @param item_align Alignment of each item, the item array starts aligned to it
+ *
+ * @return true on success, false on failure
+ */
+SN_MEMORY_API bool sn_packed_pool_init(
+    SnPackedPool *pool, void *mem, uint64_t size, uint64_t item_size, uint64_t item_align);
+
+/**
+ * @brief Deinitialize packed pool.
+ *
+ * @note Does not free memory buffer
+ */
+SN_FORCE_INLINE void sn_packed_pool_deinit(SnPackedPool *pool) {
+    if (!pool) return;
+    *pool = (SnPackedPool){0};
+}
+
+/**
+ * @brief Append an item.
+ *
+ * @param pool Pointer to pool context
+ * @param out_item Receives the item, can be NULL
+ *
+ * @return Handle of the item or SN_HANDLE_INVALID if the pool is full
+ */
+SN_MEMORY_API SnHandle sn_packed_pool_allocate(SnPackedPool *pool, void **out_item);
+
+/**
+ * @brief Remove an item, moving the last item into its place.
+ *
+ * @param pool Pointer to pool context
+ * @param handle Handle of the item
+ *
+ * @return Returns false if the handle is stale or invalid.
+ */
+SN_MEMORY_API bool sn_packed_pool_free(SnPackedPool *pool, SnHandle handle);
+
+/**
+ * @brief Get the item at a dense index.
+ *
+ * @param pool Pointer to pool context
+ * @param index Dense index, must be below the count
+ */
+SN_FORCE_INLINE void *sn_packed_pool_get_item(SnPackedPool *pool, uint32_t index) {
+    return pool->items + (uint64_t)index * pool->item_size;
+}
+
+/**
+ * @brief Resolve a handle to its item.
+ *
+ * @param pool Pointer to pool context
+ * @param handle The handle
+ *
+ * @return Pointer to item or NULL if the handle is stale or invalid
+ */
+SN_FORCE_INLINE void *sn_packed_pool_resolve(SnPackedPool *pool, SnHandle handle) {
+    uint32_t slot = (uint32_t)handle;
+    if (slot >= pool->high_water || pool->slots[slot].generation != (uint32_t)(handle >> 32)) return NULL;
+    return sn_packed_pool_get_item(pool, pool->slots[slot].dense);
+}
+
+/**
+ * @brief Get the handle of the item at a dense index.
+ *
+ * @param pool Pointer to pool context
+ * @param index Dense index, must be below the count
+ */
+SN_FORCE_INLINE SnHandle sn_packed_pool_get_handle(SnPackedPool *pool, uint32_t index) {
+    uint32_t slot = pool->dense_slots[index];
+    return (SnHandle)pool->slots[slot].generation << 32 | slot;
+}
+
+/**
+ * @brief Get the dense item array, count items long.
+ *
+ * @param pool Pointer to pool context
+ */
+SN_FORCE_INLINE void *sn_packed_pool_get_items(SnPackedPool *pool) {
+    if (!pool) return NULL;
+    return pool->items;
+}
+
+/**
+ * @brief Get number of live items.
+ *
+ * @param pool Pointer to pool context
+ */
+SN_FORCE_INLINE uint32_t sn_packed_pool_get_count(SnPackedPool *pool) {
+    if (!pool) return 0;
+    return pool->count;
+}
+
+/**
+ * @brief Get maximum number of items.
+ *
+ * @param pool Pointer to pool context
+ */
+SN_FORCE_INLINE uint32_t sn_packed_pool_get_capacity(SnPackedPool *pool) {
+    if (!pool) return 0;
+    return pool->capacity;
+}
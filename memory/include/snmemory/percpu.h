@@ -0,0 +1,234 @@
+#pragma once
+
+#include "snmemory/adapter.h"
+#include "snmemory/api.h"
+#include "snmemory/pool.h"
+#include "snmemory/slab.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+#ifndef SN_PERCPU_CACHE_CAPACITY
+    #define SN_PERCPU_CACHE_CAPACITY 32
+#endif
+
+/**
+ * @struct SnPercpuSlot
+ * @brief Block cache of one CPU.
+ *
+ * @note Aligned to 64 bytes so that slots of different CPUs never share a cache line.
+ */
+typedef struct SnPercpuSlot {
+    alignas(64) uint64_t lock; /**< Taken while the slot is used, or flushed when restartable */
+    uint64_t count; /**< Number of cached blocks */
+    void *blocks[SN_PERCPU_CACHE_CAPACITY]; /**< Cached blocks */
+} SnPercpuSlot;
+
+/**
+ * @struct SnPercpuCache
+ * @brief Per-CPU caching front-end for a fixed size allocator.
+ *
+ * Every CPU owns a slot of cached blocks, so the cache count scales with
+ * cores instead of threads. On Linux x86-64 and aarch64 with one slot per
+ * CPU, a slot is updated in a restartable sequence (rseq): the kernel
+ * restarts it if the thread is preempted or migrated before the final store,
+ * so allocate and free need no atomics. Otherwise a slot is picked from the
+ * current CPU id and taken with an uncontended try-lock, which also keeps it
+ * correct if the thread migrates. Empty or full slots move half of their
+ * capacity from or to the backend, which is shared and guarded by a spin lock.
+ *
+ * @note
+ * - Thread-safe
+ * - Must not move after init
+ * - Without a CPU id (macOS), every thread gets its own slot index instead
+ * - Restartable slots need glibc to register rseq and the kernel to support
+ *   membarrier rseq fences (Linux 5.10), used by flush
+ */
+typedef struct SnPercpuCache {
+    SnMemoryAdapter backend; /**< Shared allocator blocks come from */
+    uint64_t block_size; /**< Size passed to the backend */
+    uint64_t block_align; /**< Alignment passed to the backend */
+
+    uint64_t lock; /**< Backend lock unless shared */
+    uint64_t *backend_lock; /**< Lock guarding the backend */
+
+    SnPercpuSlot *slots; /**< Per-CPU slots */
+    uint32_t slot_count; /**< Number of slots */
+    bool restartable; /**< Slots are updated in restartable sequences */
+} SnPercpuCache;
+
+/**
+ * @brief Get the number of CPUs.
+ */
+SN_MEMORY_API uint32_t sn_percpu_get_cpu_count(void);
+
+/**
+ * @brief Get the memory needed for the slots.
+ *
+ * @param slot_count Number of slots, 0 for one per CPU.
+ *
+ * @return Returns the size in bytes, the memory must be aligned to alignof(SnPercpuSlot).
+ */
+SN_FORCE_INLINE uint64_t sn_percpu_cache_get_required_size(uint32_t slot_count) {
+    if (!slot_count) slot_count = sn_percpu_get_cpu_count();
+    return (uint64_t)slot_count * sizeof(SnPercpuSlot) + alignof(SnPercpuSlot);
+}
+
+/**
+ * @brief Initialize per-CPU cache.
+ *
+ * @param cache Pointer to cache context
+ * @param backend Allocator blocks come from, not required to be thread-safe
+ * @param block_size Size of the blocks
+ * @param block_align Alignment of the blocks
+ * @param mem Memory for the slots
+ * @param size Size of the memory, one slot per CPU at most
+ *
+ * @return true on success, false on failure
+ */
+SN_MEMORY_API bool sn_percpu_cache_init(
+    SnPercpuCache *cache, SnMemoryAdapter backend, uint64_t block_size, uint64_t block_align, void *mem, uint64_t size);
+
+/**
+ * @brief Initialize per-CPU cache in front of a pool.
+ *
+ * @param cache Pointer to cache context
+ * @param pool The pool
+ * @param mem Memory for the slots
+ * @param size Size of the memory
+ *
+ * @return true on success, false on failure
+ */
+SN_INLINE bool sn_percpu_cache_init_pool(SnPercpuCache *cache, SnPoolAllocator *pool, void *mem, uint64_t size) {
+    if (!pool) return false;
+    return sn_percpu_cache_init(
+        cache, sn_pool_allocator_get_adapter(pool), pool->block_size, pool->block_align, mem, size);
+}
+
+/**
+ * @brief Deinitialize per-CPU cache, returning cached blocks to the backend.
+ *
+ * @param cache Pointer to cache context
+ *
+ * @note No other thread may use the cache.
+ */
+SN_MEMORY_API void sn_percpu_cache_deinit(SnPercpuCache *cache);
+
+/**
+ * @brief Allocate a block.
+ *
+ * @param cache Pointer to cache context
+ *
+ * @return Pointer to block or NULL if the backend is exhausted
+ */
+SN_MEMORY_API void *sn_percpu_cache_allocate(SnPercpuCache *cache);
+
+/**
+ * @brief Free a block.
+ *
+ * @param cache Pointer to cache context
+ * @param ptr Block to free
+ */
+SN_MEMORY_API void sn_percpu_cache_free(SnPercpuCache *cache, void *ptr);
+
+/**
+ * @brief Return every cached block to the backend.
+ *
+ * @param cache Pointer to cache context
+ */
+SN_MEMORY_API void sn_percpu_cache_flush(SnPercpuCache *cache);
+
+SN_INLINE void *sn_percpu_cache_allocate_wrapper(void *data, uint64_t size, uint64_t align) {
+    SnPercpuCache *cache = (SnPercpuCache *)data;
+    if (size > cache->block_size || align > cache->block_align) return NULL;
+    return sn_percpu_cache_allocate(cache);
+}
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param cache Pointer to per-CPU cache.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_percpu_cache_get_allocator(SnPercpuCache *cache) {
+    return (SnMemoryAllocator){
+        .data = cache,
+        .alloc = sn_percpu_cache_allocate_wrapper,
+        .realloc = NULL,
+        .free = (SnMemoryFreeFn)sn_percpu_cache_free,
+    };
+}
+
+/**
+ * @struct SnPercpuSlab
+ * @brief Per-CPU caches for every slab size class.
+ *
+ * @note
+ * - Thread-safe
+ * - Must not move after init
+ */
+typedef struct SnPercpuSlab {
+    SnSlabAllocator *slab; /**< The slab allocator */
+    uint64_t lock; /**< Lock guarding the slab allocator */
+    SnPercpuCache classes[SN_SLAB_CLASS_COUNT]; /**< One cache per size class */
+} SnPercpuSlab;
+
+/**
+ * @brief Get the memory needed for the slots of every class.
+ *
+ * @param slot_count Number of slots per class, 0 for one per CPU.
+ */
+SN_FORCE_INLINE uint64_t sn_percpu_slab_get_required_size(uint32_t slot_count) {
+    return sn_percpu_cache_get_required_size(slot_count) * SN_SLAB_CLASS_COUNT;
+}
+
+/**
+ * @brief Initialize per-CPU slab caches.
+ *
+ * @param alloc Pointer to context
+ * @param slab Initialized slab allocator
+ * @param mem Memory for the slots
+ * @param size Size of the memory
+ *
+ * @return true on success, false on failure
+ */
+SN_MEMORY_API bool sn_percpu_slab_init(SnPercpuSlab *alloc, SnSlabAllocator *slab, void *mem, uint64_t size);
+
+/**
+ * @brief Deinitialize per-CPU slab caches, returning cached blocks to the slab allocator.
+ *
+ * @param alloc Pointer to context
+ */
+SN_MEMORY_API void sn_percpu_slab_deinit(SnPercpuSlab *alloc);
+
+/**
+ * @brief Allocate memory.
+ *
+ * @param alloc Pointer to context
+ * @param size Number of bytes to allocate (at most SN_SLAB_MAX_SIZE)
+ * @param align Alignment requirement
+ *
+ * @return Pointer to allocated memory or NULL on failure
+ */
+SN_MEMORY_API void *sn_percpu_slab_allocate(SnPercpuSlab *alloc, uint64_t size, uint64_t align);
+
+/**
+ * @brief Free memory.
+ *
+ * @param alloc Pointer to context
+ * @param ptr Pointer to memory to free
+ */
+SN_MEMORY_API void sn_percpu_slab_free(SnPercpuSlab *alloc, void *ptr);
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param alloc Pointer to per-CPU slab caches.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_percpu_slab_get_allocator(SnPercpuSlab *alloc) {
+    return (SnMemoryAllocator){
+        .data = alloc,
+        .alloc = (SnMemoryAllocateFn)sn_percpu_slab_allocate,
+        .realloc = NULL,
+        .free = (SnMemoryFreeFn)sn_percpu_slab_free,
+    };
+}
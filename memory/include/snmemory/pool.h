@@ -1,8 +1,21 @@
 #pragma once
 
+#include "snmemory/adapter.h"
+#include "snmemory/api.h"
+
 #include <sncore/defines.h>
 #include <sncore/types.h>
 
+/**
+ * @enum SnPoolLayout
+ * @brief Block placement for @ref sn_pool_allocator_init_with_layout.
+ */
+typedef enum SnPoolLayout {
+    SN_POOL_LAYOUT_PACKED, /**< Blocks back to back, handed out in address order */
+    SN_POOL_LAYOUT_LINE_PADDED, /**< Blocks padded and aligned to whole cache lines, none share a line */
+    SN_POOL_LAYOUT_INTERLEAVED, /**< Blocks back to back, consecutive allocations at least a line apart */
+} SnPoolLayout;
+
 /**
  * @struct SnPoolAllocator
  * @brief Fixed-size block memory allocator.
@@ -73,6 +86,37 @@ SN_INLINE bool sn_pool_allocator_init(
     return true;
 }
 
+/**
+ * @brief Initialize a pool allocator with cache line aware placement.
+ *
+ * Blocks written by different threads should not share a cache line, or the
+ * line bounces between the cores (false sharing). LINE_PADDED rules that out
+ * for any block at the cost of the padding. INTERLEAVED keeps blocks packed
+ * and orders the free list so that consecutive allocations, which usually
+ * go to different owners, land in distinct lines.
+ *
+ * @param alloc Pointer to allocator context
+ * @param mem Memory buffer to manage
+ * @param size Size of memory buffer
+ * @param block_size Size of each block (should be >= sizeof(void *))
+ * @param block_align Alignment of each block
+ * @param layout One of SnPoolLayout
+ *
+ * @return true on success, false on failure
+ *
+ * @note The interleaved order holds for the blocks as initialized, freed
+ *       blocks are handed out again first.
+ */
+SN_MEMORY_API bool sn_pool_allocator_init_with_layout(
+    SnPoolAllocator *alloc, void *mem, uint64_t size, uint64_t block_size, uint64_t block_align, SnPoolLayout layout);
+
+/**
+ * @brief Get the L1 data cache line size detected at runtime.
+ *
+ * @note Falls back to 64 bytes when the OS does not report it.
+ */
+SN_MEMORY_API uint64_t sn_memory_get_cache_line_size(void);
+
 /**
  * @brief Deinitialize pool allocator.
  *
@@ -163,6 +207,83 @@ SN_FORCE_INLINE void sn_pool_allocator_free(SnPoolAllocator *alloc, void *ptr) {
     alloc->free_count++;
 }
 
+/**
+ * @brief Free a previously allocated block of known size.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to block to free
+ * @param size Size requested for the block
+ * @param align Alignment requested for the block
+ *
+ * @note Blocks have no header, this only validates size and align in debug builds.
+ */
+SN_FORCE_INLINE void sn_pool_allocator_free_sized(SnPoolAllocator *alloc, void *ptr, uint64_t size, uint64_t align) {
+    if (!ptr || !alloc) return;
+
+    SN_ASSERT(size <= alloc->block_size);
+    SN_ASSERT(SN_IS_ALIGNED(ptr, align));
+    SN_UNUSED(size);
+    SN_UNUSED(align);
+
+    sn_pool_allocator_free(alloc, ptr);
+}
+
+/**
+ * @brief Allocate multiple blocks from the pool.
+ *
+ * Detaches the first count blocks of the free list in one go.
+ *
+ * @param alloc Pointer to allocator context
+ * @param out_ptrs Array receiving the blocks
+ * @param count Number of blocks to allocate
+ *
+ * @return Number of blocks allocated, less than count if the pool is exhausted
+ */
+SN_INLINE uint64_t sn_pool_allocator_allocate_batch(SnPoolAllocator *alloc, void **out_ptrs, uint64_t count) {
+    if (!alloc || !out_ptrs) return 0;
+
+    count = SN_MIN(count, alloc->free_count);
+
+    void *block = alloc->free_list;
+    for (uint64_t i = 0; i < count; ++i) {
+        out_ptrs[i] = block;
+        block = *((void **)block);
+    }
+
+    alloc->free_list = block;
+    alloc->free_count -= count;
+
+    return count;
+}
+
+/**
+ * @brief Free multiple blocks.
+ *
+ * Links the blocks together and splices them onto the free list in one go.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptrs Blocks to free, none of them can be NULL
+ * @param count Number of blocks to free
+ *
+ * @note
+ * - Every block must be returned by this allocator
+ * - Blocks must not be freed twice
+ */
+SN_INLINE void sn_pool_allocator_free_batch(SnPoolAllocator *alloc, void **ptrs, uint64_t count) {
+    if (!alloc || !ptrs || !count) return;
+
+    for (uint64_t i = 0; i < count; ++i) {
+        SN_ASSERT((uint8_t *)ptrs[i] >= alloc->mem);
+        SN_ASSERT((uint8_t *)ptrs[i] < alloc->mem + alloc->size);
+        SN_ASSERT(SN_IS_ALIGNED(ptrs[i], alloc->block_align));
+
+        *((void **)ptrs[i]) = i + 1 < count ? ptrs[i + 1] : alloc->free_list;
+    }
+
+    alloc->free_list = ptrs[0];
+    alloc->free_count += count;
+}
+
 /**
  * @brief Get total number of blocks.
  *
@@ -199,6 +320,19 @@ SN_INLINE void *sn_pool_allocator_allocate_wrapper(void *data, uint64_t size, ui
     return sn_pool_allocator_allocate((SnPoolAllocator *)data);
 }
 
+/**
+ * @brief Check if ptr lies in the memory managed by the allocator.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param ptr Pointer to check.
+ *
+ * @return Returns true if ptr is inside the managed buffer.
+ */
+SN_FORCE_INLINE bool sn_pool_allocator_owns(SnPoolAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return (const uint8_t *)ptr >= alloc->mem && (const uint8_t *)ptr < alloc->mem + alloc->size;
+}
+
 /**
  * @brief Get the SnMemoryAllocator.
  *
@@ -212,3 +346,16 @@ SN_FORCE_INLINE SnMemoryAllocator sn_pool_allocator_get_allocator(SnPoolAllocato
         .free = (SnMemoryFreeFn)sn_pool_allocator_free,
     };
 }
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to pool allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_pool_allocator_get_adapter(SnPoolAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_pool_allocator_get_allocator(alloc),
+        .free_sized = (SnMemoryFreeSizedFn)sn_pool_allocator_free_sized,
+        .owns = (SnMemoryOwnsFn)sn_pool_allocator_owns,
+    };
+}
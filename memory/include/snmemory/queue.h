@@ -1,5 +1,7 @@
 #pragma once
 
+#include "snmemory/adapter.h"
+
 #include <sncore/defines.h>
 #include <sncore/types.h>
 
@@ -133,6 +135,26 @@ SN_INLINE void sn_queue_allocator_free(SnQueueAllocator *alloc, void *ptr) {
     else alloc->tail = header->next;
 }
 
+/**
+ * @brief Free the allocated memory of known size from queue allocator.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param ptr The pointer to free.
+ * @param size Size passed when allocating ptr.
+ * @param align Alignment passed when allocating ptr.
+ */
+SN_FORCE_INLINE void sn_queue_allocator_free_sized(SnQueueAllocator *alloc, void *ptr, uint64_t size, uint64_t align) {
+    if (!ptr || !alloc) return;
+
+    // Next of the newest allocation still points at its end
+    SN_ASSERT(alloc->tail != alloc->head
+              || ((SnQueueAllocatorHeader *)alloc->tail)->next == ((uint8_t *)ptr) + size);
+    SN_UNUSED(size);
+    SN_UNUSED(align);
+
+    sn_queue_allocator_free(alloc, ptr);
+}
+
 /**
  * @brief Clear all allocations from the queue allocator.
  *
@@ -196,6 +218,19 @@ SN_FORCE_INLINE uint64_t sn_queue_allocator_get_remaining_size(SnQueueAllocator
     return size;
 }
 
+/**
+ * @brief Check if ptr lies in the memory managed by the allocator.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param ptr Pointer to check.
+ *
+ * @return Returns true if ptr is inside the managed buffer.
+ */
+SN_FORCE_INLINE bool sn_queue_allocator_owns(SnQueueAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return (const uint8_t *)ptr >= alloc->mem && (const uint8_t *)ptr < alloc->mem + alloc->size;
+}
+
 /**
  * @brief Get the SnMemoryAllocator.
  *
@@ -209,3 +244,16 @@ SN_FORCE_INLINE SnMemoryAllocator sn_queue_allocator_get_allocator(SnQueueAlloca
         .free = (SnMemoryFreeFn)sn_queue_allocator_free,
     };
 }
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to queue allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_queue_allocator_get_adapter(SnQueueAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_queue_allocator_get_allocator(alloc),
+        .free_sized = (SnMemoryFreeSizedFn)sn_queue_allocator_free_sized,
+        .owns = (SnMemoryOwnsFn)sn_queue_allocator_owns,
+    };
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "snmemory/api.h"
+#include "snmemory/handle.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+// Alignment of every block, kept when a block moves
+#define SN_RELOC_HEAP_ALIGNMENT 16
+
+/**
+ * @struct SnRelocEntry
+ * @brief Handle table entry of a relocatable heap.
+ */
+typedef struct SnRelocEntry {
+    uint8_t *block; /**< Current block of the handle */
+    uint32_t generation; /**< Odd while live */
+    uint32_t pins; /**< Pin count, next free entry while free */
+} SnRelocEntry;
+
+/**
+ * @struct SnRelocHeap
+ * @brief Heap of movable blocks addressed by handles.
+ *
+ * Clients hold handles and pin one to get a pointer, which stays valid
+ * until the matching unpin. Unpinned blocks may move: the compactor slides
+ * live blocks towards the start of the heap in address order, a bounded
+ * amount of work per call, so free space gathers at the end where it is
+ * bump allocated. Pinned blocks stay in place and the compactor continues
+ * after them.
+ *
+ * @note
+ * - Blocks are aligned to SN_RELOC_HEAP_ALIGNMENT
+ * - None of the sn_reloc_heap* functions are thread-safe
+ */
+typedef struct SnRelocHeap {
+    SnRelocEntry *entries; /**< Handle table */
+    uint32_t entry_count; /**< Number of handles */
+    uint32_t free_entry; /**< First free handle below high water */
+    uint32_t entry_high_water; /**< Handles ever used */
+
+    uint8_t *base; /**< First block */
+    uint8_t *top; /**< End of the last block, bump pointer */
+    uint8_t *end; /**< End of the heap */
+
+    uint8_t *compact_dest; /**< Compacted up to here, the rest of the pass starts with a gap */
+    uint8_t *compact_scan; /**< Next block the compactor looks at */
+
+    uint64_t used_size; /**< Bytes in live blocks, headers included */
+} SnRelocHeap;
+
+/**
+ * @brief Initialize relocatable heap.
+ *
+ * @param heap Pointer to heap context
+ * @param mem Memory buffer to manage
+ * @param size Size of memory buffer
+ * @param handle_count Maximum number of live handles, taken from the front of the buffer
+ *
+ * @return true on success, false on failure
+ */
+SN_MEMORY_API bool sn_reloc_heap_init(SnRelocHeap *heap, void *mem, uint64_t size, uint32_t handle_count);
+
+/**
+ * @brief Deinitialize relocatable heap.
+ *
+ * @note Does not free memory buffer
+ */
+SN_FORCE_INLINE void sn_reloc_heap_deinit(SnRelocHeap *heap) {
+    if (!heap) return;
+    *heap = (SnRelocHeap){0};
+}
+
+/**
+ * @brief Allocate a block.
+ *
+ * Bump allocates past the last block, then falls back to the first free
+ * hole that fits.
+ *
+ * @param heap Pointer to heap context
+ * @param size Number of bytes to allocate
+ *
+ * @return Handle of the block or SN_HANDLE_INVALID on failure
+ */
+SN_MEMORY_API SnHandle sn_reloc_heap_allocate(SnRelocHeap *heap, uint64_t size);
+
+/**
+ * @brief Free a block.
+ *
+ * @param heap Pointer to heap context
+ * @param handle Handle of the block
+ *
+ * @return Returns false if the handle is stale, invalid or pinned.
+ */
+SN_MEMORY_API bool sn_reloc_heap_free(SnRelocHeap *heap, SnHandle handle);
+
+/**
+ * @brief Pin a block, keeping it in place.
+ *
+ * @param heap Pointer to heap context
+ * @param handle Handle of the block
+ *
+ * @return Pointer to the block or NULL if the handle is stale or invalid
+ *
+ * @note Pins nest, every pin needs an unpin.
+ */
+SN_MEMORY_API void *sn_reloc_heap_pin(SnRelocHeap *heap, SnHandle handle);
+
+/**
+ * @brief Unpin a block, the pointer from pin must not be used anymore.
+ *
+ * @param heap Pointer to heap context
+ * @param handle Handle of the block
+ */
+SN_MEMORY_API void sn_reloc_heap_unpin(SnRelocHeap *heap, SnHandle handle);
+
+/**
+ * @brief Compact the heap incrementally.
+ *
+ * Continues the current compaction pass until max_bytes were moved,
+ * max_ticks cycle counter ticks passed, or the pass finished. Finishing
+ * a pass lowers the bump pointer to the end of the compacted blocks.
+ *
+ * @param heap Pointer to heap context
+ * @param max_bytes Byte budget, 0 for no limit
+ * @param max_ticks Time budget in sn_cycle_counter ticks, 0 for no limit
+ *
+ * @return Number of bytes moved
+ */
+SN_MEMORY_API uint64_t sn_reloc_heap_compact(SnRelocHeap *heap, uint64_t max_bytes, uint64_t max_ticks);
+
+/**
+ * @brief Check if a handle refers to a live block.
+ *
+ * @param heap Pointer to heap context
+ * @param handle The handle
+ */
+SN_FORCE_INLINE bool sn_reloc_heap_is_valid(SnRelocHeap *heap, SnHandle handle) {
+    uint32_t index = (uint32_t)handle;
+    return index < heap->entry_high_water && heap->entries[index].generation == (uint32_t)(handle >> 32);
+}
+
+/**
+ * @brief Get the usable size of a block.
+ *
+ * @param heap Pointer to heap context
+ * @param handle Handle of the block
+ *
+ * @return Returns 0 if the handle is stale or invalid.
+ */
+SN_MEMORY_API uint64_t sn_reloc_heap_get_size(SnRelocHeap *heap, SnHandle handle);
+
+/**
+ * @brief Get number of free bytes, in holes and past the last block.
+ *
+ * @param heap Pointer to heap context
+ */
+SN_FORCE_INLINE uint64_t sn_reloc_heap_get_free_size(SnRelocHeap *heap) {
+    if (!heap) return 0;
+    return SN_PTR_DIFF(heap->end, heap->base) - heap->used_size;
+}
+
+/**
+ * @brief Get number of contiguous free bytes past the last block.
+ *
+ * @param heap Pointer to heap context
+ */
+SN_FORCE_INLINE uint64_t sn_reloc_heap_get_tail_size(SnRelocHeap *heap) {
+    if (!heap) return 0;
+    return SN_PTR_DIFF(heap->end, heap->top);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "snmemory/adapter.h"
+
 #include <sncore/defines.h>
 #include <sncore/types.h>
 
@@ -85,6 +87,19 @@ SN_FORCE_INLINE void sn_ring_buffer_allocator_reset(SnRingBufferAllocator *alloc
     alloc->read_offset = 0;
 }
 
+/**
+ * @brief Check if ptr lies in the memory managed by the allocator.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param ptr Pointer to check.
+ *
+ * @return Returns true if ptr is inside the managed buffer.
+ */
+SN_FORCE_INLINE bool sn_ring_buffer_allocator_owns(SnRingBufferAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return (const uint8_t *)ptr >= alloc->buffer && (const uint8_t *)ptr < alloc->buffer + alloc->size;
+}
+
 /**
  * @brief Get the SnMemoryAllocator.
  *
@@ -98,3 +113,15 @@ SN_FORCE_INLINE SnMemoryAllocator sn_ring_buffer_allocator_get_allocator(SnRingB
         .free = NULL,
     };
 }
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to ring buffer allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_ring_buffer_allocator_get_adapter(SnRingBufferAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_ring_buffer_allocator_get_allocator(alloc),
+        .owns = (SnMemoryOwnsFn)sn_ring_buffer_allocator_owns,
+    };
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "snmemory/api.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+// Identifies an initialized ring header, the low byte is the layout version
+#define SN_SHARED_RING_MAGIC 0x534E53524E470001ULL
+
+// Alignment of every record and its payload
+#define SN_SHARED_RING_ALIGNMENT 16
+
+// Longest shared memory object name, terminator included
+#define SN_SHARED_RING_NAME_MAX 64
+
+// Timeout that never expires
+#define SN_SHARED_RING_WAIT_FOREVER UINT32_MAX
+
+/**
+ * @struct SnSharedRingHeader
+ * @brief Header at the start of the shared memory, followed by the data.
+ *
+ * Offsets only grow, they are taken modulo the capacity, so the header
+ * holds no pointers and the memory can be mapped anywhere. The producer
+ * and consumer sides sit on their own cache lines.
+ */
+typedef struct SnSharedRingHeader {
+    uint64_t magic; /**< SN_SHARED_RING_MAGIC once initialized */
+    uint64_t capacity; /**< Size of the data, a power of two */
+
+    alignas(64) uint64_t write_offset; /**< Bytes ever committed, written by the producer */
+    uint32_t data_signal; /**< Bumped on commit while the consumer waits */
+    uint32_t consumer_waiting; /**< Consumer is about to sleep on data_signal */
+
+    alignas(64) uint64_t read_offset; /**< Bytes ever released, written by the consumer */
+    uint32_t space_signal; /**< Bumped on release while the producer waits */
+    uint32_t producer_waiting; /**< Producer is about to sleep on space_signal */
+} SnSharedRingHeader;
+
+/**
+ * @struct SnSharedRing
+ * @brief Single producer single consumer ring of messages in shared memory.
+ *
+ * One process creates the ring under a name and the other opens it. The
+ * producer reserves space for a message, writes it in place and commits
+ * it. The consumer peeks at the oldest message, reads it in place and
+ * releases it. Messages are never copied by the ring.
+ *
+ * An empty or full ring puts the waiting side to sleep on a futex in the
+ * shared header (a short sleep loop where no cross-process futex exists).
+ * The other side only makes a wake up call while someone waits.
+ *
+ * @note
+ * - Exactly one producer and one consumer, in the same or in different processes
+ * - Messages are at most half the capacity
+ */
+typedef struct SnSharedRing {
+    SnSharedRingHeader *header; /**< Shared header */
+    uint8_t *data; /**< Shared data, capacity bytes */
+    uint64_t mask; /**< capacity - 1 */
+
+    uint64_t mapped_size; /**< Size of the mapping */
+    intptr_t handle; /**< Shared memory descriptor or handle */
+
+    uint64_t pending; /**< Size of the reserved or peeked record */
+    uint64_t pending_skip; /**< Padding before the pending record */
+
+    bool owner; /**< Created the ring, removes the name on close */
+    char name[SN_SHARED_RING_NAME_MAX]; /**< Name of the shared memory */
+} SnSharedRing;
+
+/**
+ * @brief Create a ring in new named shared memory.
+ *
+ * @param ring Receives the ring.
+ * @param name Name of the shared memory, "/name" on POSIX systems.
+ * @param capacity Size of the data, rounded up to a power of two.
+ *
+ * @return Returns true on success, false if the name exists or on failure.
+ */
+SN_MEMORY_API bool sn_shared_ring_create(SnSharedRing *ring, const char *name, uint64_t capacity);
+
+/**
+ * @brief Open a ring created by another process.
+ *
+ * @param ring Receives the ring.
+ * @param name Name passed to @ref sn_shared_ring_create.
+ *
+ * @return Returns true on success, false if there is no ring with the name.
+ */
+SN_MEMORY_API bool sn_shared_ring_open(SnSharedRing *ring, const char *name);
+
+/**
+ * @brief Unmap the ring, the creator also removes the name.
+ *
+ * @note The memory lives until every process closed the ring.
+ */
+SN_MEMORY_API void sn_shared_ring_close(SnSharedRing *ring);
+
+/**
+ * @brief Reserve space for a message, producer side.
+ *
+ * @param ring Pointer to the ring.
+ * @param size Size of the message.
+ * @param timeout_ms Longest wait for space, 0 to not wait, SN_SHARED_RING_WAIT_FOREVER to wait forever.
+ *
+ * @return Returns pointer to write the message to, aligned to SN_SHARED_RING_ALIGNMENT,
+ *         or NULL on timeout or if the message is too large.
+ *
+ * @note The message is not visible until @ref sn_shared_ring_commit.
+ */
+SN_MEMORY_API void *sn_shared_ring_reserve(SnSharedRing *ring, uint64_t size, uint32_t timeout_ms);
+
+/**
+ * @brief Publish the reserved message and wake the consumer if it sleeps.
+ *
+ * @param ring Pointer to the ring.
+ */
+SN_MEMORY_API void sn_shared_ring_commit(SnSharedRing *ring);
+
+/**
+ * @brief Get the oldest message, consumer side.
+ *
+ * @param ring Pointer to the ring.
+ * @param out_size Receives the size of the message, can be NULL.
+ * @param timeout_ms Longest wait for a message, 0 to not wait, SN_SHARED_RING_WAIT_FOREVER to wait forever.
+ *
+ * @return Returns pointer to the message or NULL on timeout.
+ *
+ * @note Peeking again before @ref sn_shared_ring_release returns the same message.
+ */
+SN_MEMORY_API void *sn_shared_ring_peek(SnSharedRing *ring, uint64_t *out_size, uint32_t timeout_ms);
+
+/**
+ * @brief Hand the space of the peeked message back and wake the producer if it sleeps.
+ *
+ * @param ring Pointer to the ring.
+ */
+SN_MEMORY_API void sn_shared_ring_release(SnSharedRing *ring);
+
+/**
+ * @brief Get the largest message the ring takes.
+ *
+ * @param ring Pointer to the ring.
+ */
+SN_FORCE_INLINE uint64_t sn_shared_ring_get_max_message_size(SnSharedRing *ring) {
+    if (!ring || !ring->header) return 0;
+    return (ring->mask + 1) / 2 - SN_SHARED_RING_ALIGNMENT;
+}
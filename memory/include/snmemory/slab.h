@@ -0,0 +1,234 @@
+#pragma once
+
+#include "snmemory/adapter.h"
+#include "snmemory/api.h"
+#include "snmemory/pool.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+#ifndef SN_SLAB_SIZE
+    #define SN_SLAB_SIZE (64 * 1024)
+#endif
+
+/**
+ * @brief Number of size classes.
+ */
+#define SN_SLAB_CLASS_COUNT 28
+
+/**
+ * @brief Largest size served by the slab allocator.
+ */
+#define SN_SLAB_MAX_SIZE 4096
+
+/**
+ * @struct SnSlab
+ * @brief Header at the start of every slab.
+ *
+ * A slab is SN_SLAB_SIZE bytes aligned to SN_SLAB_SIZE, so the header of any
+ * block is found by masking the block address.
+ */
+typedef struct SnSlab {
+    SnPoolAllocator pool; /**< Blocks of one size class */
+    struct SnSlab *next; /**< Next slab in the list */
+    struct SnSlab *previous; /**< Previous slab in the list */
+    uint32_t class_index; /**< Size class of the slab */
+} SnSlab;
+
+/**
+ * @struct SnSlabAllocator
+ * @brief Small object allocator built from pool allocators.
+ *
+ * Manages a user-provided memory buffer split into slabs. Each slab is a
+ * SnPoolAllocator for one size class (16, 32, 48, ... 4096 bytes).
+ * Allocation picks the class with a lookup table and free finds the slab
+ * from the pointer, both are O(1).
+ *
+ * @note
+ * - Not thread-safe
+ * - No OS allocations
+ * - Blocks are aligned to the largest power of two dividing their class size
+ */
+typedef struct SnSlabAllocator {
+    uint8_t *mem; /**< Base memory pointer */
+    uint64_t size; /**< Total size of managed memory */
+
+    SnSlab *free_slabs; /**< Slabs not used by any class */
+    SnSlab *partial[SN_SLAB_CLASS_COUNT]; /**< Per class slabs having free blocks */
+
+    uint64_t slab_count; /**< Total number of slabs */
+    uint64_t free_slab_count; /**< Number of unused slabs */
+} SnSlabAllocator;
+
+/**
+ * @brief Initialize slab allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param mem Memory buffer to manage
+ * @param size Size of memory buffer
+ *
+ * @note Only whole SN_SLAB_SIZE aligned slabs inside the buffer are used.
+ *
+ * @return true on success, false on failure
+ */
+SN_MEMORY_API bool sn_slab_allocator_init(SnSlabAllocator *alloc, void *mem, uint64_t size);
+
+/**
+ * @brief Deinitialize slab allocator.
+ *
+ * @param alloc Pointer to allocator context
+ *
+ * @note Does not free memory buffer
+ */
+SN_FORCE_INLINE void sn_slab_allocator_deinit(SnSlabAllocator *alloc) {
+    if (!alloc) return;
+    *alloc = (SnSlabAllocator){0};
+}
+
+/**
+ * @brief Allocate memory from slab allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param size Number of bytes to allocate (at most SN_SLAB_MAX_SIZE)
+ * @param align Alignment requirement
+ *
+ * @return Pointer to allocated memory or NULL on failure
+ */
+SN_MEMORY_API void *sn_slab_allocator_allocate(SnSlabAllocator *alloc, uint64_t size, uint64_t align);
+
+/**
+ * @brief Free memory allocated by slab allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to memory to free
+ *
+ * @note
+ * - ptr must be returned by this allocator
+ * - ptr must not be freed twice
+ */
+SN_MEMORY_API void sn_slab_allocator_free(SnSlabAllocator *alloc, void *ptr);
+
+/**
+ * @brief Reallocate memory allocated by slab allocator.
+ *
+ * @param alloc Pointer to allocator context.
+ * @param ptr Pointer to memory to reallocate.
+ * @param new_size The new size.
+ * @param align The alignment.
+ *
+ * @note
+ * - ptr must be returned by this allocator
+ * - Returns ptr as is if the new size still fits its size class
+ */
+SN_MEMORY_API void *sn_slab_allocator_reallocate(
+    SnSlabAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align);
+
+/**
+ * @brief Get the size class index serving the size.
+ *
+ * @param size Size in bytes.
+ *
+ * @return Returns class index or SN_SLAB_CLASS_COUNT if size is too big.
+ */
+SN_MEMORY_API uint32_t sn_slab_get_class_index(uint64_t size);
+
+/**
+ * @brief Get the block size of a size class.
+ *
+ * @param class_index Size class index.
+ *
+ * @return Returns block size or 0 for invalid index.
+ */
+SN_MEMORY_API uint64_t sn_slab_get_class_size(uint32_t class_index);
+
+/**
+ * @brief Get the usable size of an allocation.
+ *
+ * @param ptr Pointer returned by the slab allocator.
+ *
+ * @return Returns the block size of the slab holding ptr.
+ */
+SN_FORCE_INLINE uint64_t sn_slab_allocator_get_usable_size(void *ptr) {
+    if (!ptr) return 0;
+    SnSlab *slab = (SnSlab *)(((uint64_t)ptr) & ~((uint64_t)SN_SLAB_SIZE - 1));
+    return slab->pool.block_size;
+}
+
+/**
+ * @brief Free memory of known size allocated by slab allocator.
+ *
+ * @param alloc Pointer to allocator context
+ * @param ptr Pointer to memory to free
+ * @param size Size passed when allocating ptr
+ * @param align Alignment passed when allocating ptr
+ *
+ * @note Blocks have no header, this only validates size and align in debug builds.
+ */
+SN_FORCE_INLINE void sn_slab_allocator_free_sized(SnSlabAllocator *alloc, void *ptr, uint64_t size, uint64_t align) {
+    SN_ASSERT(!ptr || sn_slab_allocator_get_usable_size(ptr) >= size);
+    SN_ASSERT(SN_IS_ALIGNED(ptr, align));
+    SN_UNUSED(size);
+    SN_UNUSED(align);
+
+    sn_slab_allocator_free(alloc, ptr);
+}
+
+/**
+ * @brief Get number of unused slabs.
+ *
+ * @param alloc Pointer to allocator context
+ */
+SN_FORCE_INLINE uint64_t sn_slab_allocator_get_free_slab_count(SnSlabAllocator *alloc) {
+    if (!alloc) return 0;
+    return alloc->free_slab_count;
+}
+
+/**
+ * @brief Get total number of slabs.
+ *
+ * @param alloc Pointer to allocator context
+ */
+SN_FORCE_INLINE uint64_t sn_slab_allocator_get_slab_count(SnSlabAllocator *alloc) {
+    if (!alloc) return 0;
+    return alloc->slab_count;
+}
+
+/**
+ * @brief Check if ptr lies in the memory managed by the allocator.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param ptr Pointer to check.
+ *
+ * @return Returns true if ptr is inside the managed buffer.
+ */
+SN_FORCE_INLINE bool sn_slab_allocator_owns(SnSlabAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return (const uint8_t *)ptr >= alloc->mem && (const uint8_t *)ptr < alloc->mem + alloc->size;
+}
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param alloc Pointer to slab allocator.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_slab_allocator_get_allocator(SnSlabAllocator *alloc) {
+    return (SnMemoryAllocator){
+        .data = alloc,
+        .alloc = (SnMemoryAllocateFn)sn_slab_allocator_allocate,
+        .realloc = (SnMemoryReallocateFn)sn_slab_allocator_reallocate,
+        .free = (SnMemoryFreeFn)sn_slab_allocator_free,
+    };
+}
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to slab allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_slab_allocator_get_adapter(SnSlabAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_slab_allocator_get_allocator(alloc),
+        .free_sized = (SnMemoryFreeSizedFn)sn_slab_allocator_free_sized,
+        .owns = (SnMemoryOwnsFn)sn_slab_allocator_owns,
+    };
+}
@@ -1,10 +1,23 @@
 #pragma once
 
+#include "snmemory/adapter.h"
+#include "snmemory/compose.h"
 #include "snmemory/frame.h"
 #include "snmemory/freelist.h"
+#include "snmemory/handle.h"
+#include "snmemory/latency.h"
 #include "snmemory/linear.h"
+#include "snmemory/locked.h"
+#include "snmemory/mapped.h"
+#include "snmemory/owned.h"
+#include "snmemory/packed.h"
+#include "snmemory/percpu.h"
 #include "snmemory/pool.h"
 #include "snmemory/queue.h"
+#include "snmemory/reloc.h"
 #include "snmemory/ring_buffer.h"
+#include "snmemory/shared_ring.h"
+#include "snmemory/slab.h"
 #include "snmemory/stack.h"
 #include "snmemory/vm.h"
+#include "snmemory/vm_arena.h"
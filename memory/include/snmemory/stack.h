@@ -1,5 +1,7 @@
 #pragma once
 
+#include "snmemory/adapter.h"
+
 #include <sncore/defines.h>
 #include <sncore/types.h>
 
@@ -108,6 +110,26 @@ SN_INLINE void sn_stack_allocator_free(SnStackAllocator *alloc, void *ptr) {
     alloc->top = footer->previous_top;
 }
 
+/**
+ * @brief Free the allocated memory of known size from stack allocator.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param ptr The pointer to free.
+ * @param size Size passed when allocating ptr.
+ * @param align Alignment passed when allocating ptr.
+ */
+SN_FORCE_INLINE void sn_stack_allocator_free_sized(SnStackAllocator *alloc, void *ptr, uint64_t size, uint64_t align) {
+    if (!ptr || !alloc) return;
+
+    // The footer directly follows the allocation
+    SN_ASSERT(SN_GET_ALIGNED_PTR(((uint8_t *)ptr) + size, SnStackAllocatorFooter) + 1
+              == (SnStackAllocatorFooter *)alloc->top);
+    SN_UNUSED(size);
+    SN_UNUSED(align);
+
+    sn_stack_allocator_free(alloc, ptr);
+}
+
 /**
  * @brief Clear all allocations from the stack allocator.
  *
@@ -145,6 +167,19 @@ SN_FORCE_INLINE uint64_t sn_stack_allocator_get_remaining_size(SnStackAllocator
     return SN_PTR_DIFF(alloc->mem + alloc->size, alloc->top);
 }
 
+/**
+ * @brief Check if ptr lies in the memory managed by the allocator.
+ *
+ * @param alloc Pointer to the allocator context.
+ * @param ptr Pointer to check.
+ *
+ * @return Returns true if ptr is inside the managed buffer.
+ */
+SN_FORCE_INLINE bool sn_stack_allocator_owns(SnStackAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return (const uint8_t *)ptr >= alloc->mem && (const uint8_t *)ptr < alloc->mem + alloc->size;
+}
+
 /**
  * @brief Get the SnMemoryAllocator.
  *
@@ -158,3 +193,16 @@ SN_FORCE_INLINE SnMemoryAllocator sn_stack_allocator_get_allocator(SnStackAlloca
         .free = (SnMemoryFreeFn)sn_stack_allocator_free,
     };
 }
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param alloc Pointer to stack allocator.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_stack_allocator_get_adapter(SnStackAllocator *alloc) {
+    return (SnMemoryAdapter){
+        .allocator = sn_stack_allocator_get_allocator(alloc),
+        .free_sized = (SnMemoryFreeSizedFn)sn_stack_allocator_free_sized,
+        .owns = (SnMemoryOwnsFn)sn_stack_allocator_owns,
+    };
+}
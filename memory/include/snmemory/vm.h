@@ -4,6 +4,35 @@
 
 #include <sncore/defines.h>
 
+/**
+ * @brief Large page size used when the OS does not report one.
+ */
+#define SN_VM_DEFAULT_LARGE_PAGE_SIZE (2ULL * 1024ULL * 1024ULL)
+
+/**
+ * @enum SnVmFlags
+ * @brief Flags for @ref sn_vm_commit_range.
+ */
+typedef enum SnVmFlags {
+    SN_VM_FLAG_NONE = 0, /**< No flags */
+    SN_VM_FLAG_PREFAULT = 1 << 0, /**< Fault all pages in during commit */
+} SnVmFlags;
+
+#ifndef SN_VM_LAZY_DECOMMIT_CAPACITY
+    /** Maximum number of queued lazy decommits, more are applied synchronously */
+    #define SN_VM_LAZY_DECOMMIT_CAPACITY 256
+#endif
+
+#ifndef SN_VM_LAZY_DECOMMIT_BATCH
+    /** Number of queued decommits that wakes the background thread early */
+    #define SN_VM_LAZY_DECOMMIT_BATCH 32
+#endif
+
+#ifndef SN_VM_LAZY_DECOMMIT_INTERVAL_MS
+    /** Longest time a queued decommit waits before being applied */
+    #define SN_VM_LAZY_DECOMMIT_INTERVAL_MS 10
+#endif
+
 /**
  * @brief Reserve address space.
  *
@@ -35,6 +64,9 @@ SN_MEMORY_API bool sn_vm_commit(void *ptr, uint32_t pages);
 /**
  * @brief Decommits the commited memory.
  *
+ * Physical pages are returned to the OS (MADV_DONTNEED on Linux), so they
+ * no longer count towards the resident set, and the range becomes inaccessible.
+ *
  * @param ptr The address to decommit from.
  * @param pages Pages to commit.
  *
@@ -46,6 +78,24 @@ SN_MEMORY_API bool sn_vm_commit(void *ptr, uint32_t pages);
  */
 SN_MEMORY_API bool sn_vm_decommit(void *ptr, uint32_t pages);
 
+/**
+ * @brief Tell the OS the contents of the committed pages are no longer needed.
+ *
+ * Unlike @ref sn_vm_decommit, the range stays accessible and can be reused
+ * without a commit. The OS reclaims the pages only under memory pressure
+ * (MADV_FREE on Linux and macOS, MEM_RESET on Windows), so this is cheaper
+ * when the memory is likely to be reused soon.
+ *
+ * @param ptr The address to discard from.
+ * @param pages Pages to discard.
+ *
+ * @note @ref ptr must be page aligned.
+ * @note Contents of the range are undefined afterwards.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_discard(void *ptr, uint32_t pages);
+
 /**
  * @brief Release reserved address space.
  *
@@ -65,3 +115,200 @@ SN_MEMORY_API bool sn_vm_release(void *ptr, uint32_t pages);
  */
 SN_MEMORY_API uint64_t sn_vm_get_page_size(void);
 
+/**
+ * @brief Reserve address space by size in bytes.
+ *
+ * @param address Preferred address for the region (hint). Pass NULL to let the OS pick.
+ * @param size Size in bytes, rounded up to page size.
+ *
+ * @return Returns pointer to reserved address or NULL on failure.
+ *
+ * @note Same as @ref sn_vm_reserve without the 32 bit page count limit.
+ */
+SN_MEMORY_API void *sn_vm_reserve_range(void *address, uint64_t size);
+
+/**
+ * @brief Make a byte range of the reserved region usable.
+ *
+ * With SN_VM_FLAG_PREFAULT every page is faulted in before returning, so
+ * latency critical memory does not page fault later on the request path.
+ *
+ * @param ptr The address to commit from.
+ * @param size Size in bytes, rounded up to page size.
+ * @param flags Combination of @ref SnVmFlags.
+ *
+ * @note @ref ptr must be page aligned.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_commit_range(void *ptr, uint64_t size, uint32_t flags);
+
+/**
+ * @brief Decommit a byte range.
+ *
+ * @param ptr The address to decommit from.
+ * @param size Size in bytes, rounded up to page size.
+ *
+ * @note @ref ptr must be page aligned.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_decommit_range(void *ptr, uint64_t size);
+
+/**
+ * @brief Release address space reserved with @ref sn_vm_reserve_range.
+ *
+ * @param ptr The reserved address space.
+ * @param size Size in bytes that was reserved.
+ *
+ * @return Returns true on succes, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_release_range(void *ptr, uint64_t size);
+
+/**
+ * @brief Resize a committed range, moving it if it can not change in place.
+ *
+ * Contents up to the smaller size are kept and grown pages are committed.
+ * On Linux mremap(MREMAP_MAYMOVE) moves the page mappings, so page
+ * contents are never copied. Elsewhere the range grows in place when the
+ * address space after it is free, otherwise it is copied to a new range.
+ *
+ * @param ptr Start of a range reserved with @ref sn_vm_reserve_range.
+ * @param old_size Size in bytes, the whole range must be committed.
+ * @param new_size New size in bytes, rounded up to page size.
+ *
+ * @return Returns the new start of the range or NULL on failure, in which case the range is unchanged.
+ *
+ * @note On Windows a shrunk range stays reserved up to its old size.
+ */
+SN_MEMORY_API void *sn_vm_resize(void *ptr, uint64_t old_size, uint64_t new_size);
+
+/**
+ * @brief Fault in every page of a committed range.
+ *
+ * Uses MADV_POPULATE_WRITE where available, otherwise touches each page.
+ *
+ * @param ptr Start of the committed range.
+ * @param size Size in bytes.
+ *
+ * @note Must not race with writes to the range.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_prefault(void *ptr, uint64_t size);
+
+/**
+ * @brief Zero a committed range by giving its pages back to the OS.
+ *
+ * The range stays accessible and reads back as zeros without being written,
+ * pages are faulted in again on the next touch (MADV_DONTNEED on Linux).
+ *
+ * @param ptr Start of the committed range.
+ * @param size Size in bytes, rounded up to page size.
+ *
+ * @note @ref ptr must be page aligned and the range committed with sn_vm_*.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_zero_range(void *ptr, uint64_t size);
+
+/**
+ * @brief Get the large (huge) page size.
+ *
+ * @return Returns large page size, SN_VM_DEFAULT_LARGE_PAGE_SIZE if the OS
+ * does not report one.
+ */
+SN_MEMORY_API uint64_t sn_vm_get_large_page_size(void);
+
+/**
+ * @brief Reserve address space backed by large pages.
+ *
+ * Tries explicit large pages first (MAP_HUGETLB on Linux, MEM_LARGE_PAGES on
+ * Windows). If none are available, reserves a large page aligned region and
+ * asks for transparent huge pages (MADV_HUGEPAGE) where supported.
+ *
+ * @param address Preferred address for the region (hint). Pass NULL to let the OS pick.
+ * @param pages Number of large pages to reserve.
+ *
+ * @return Returns pointer to reserved address or NULL on failure.
+ *
+ * @note Address will be aligned to large page.
+ * @note On Windows explicit large pages are committed at reserve time.
+ * @note The returned region can be committed and handed to any sn_*_allocator_init.
+ */
+SN_MEMORY_API void *sn_vm_reserve_large(void *address, uint32_t pages);
+
+/**
+ * @brief Make the region reserved with @ref sn_vm_reserve_large usable.
+ *
+ * @param ptr The address to commit from.
+ * @param pages Large pages to commit.
+ *
+ * @note @ref ptr must be large page aligned.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_commit_large(void *ptr, uint32_t pages);
+
+/**
+ * @brief Decommit memory committed with @ref sn_vm_commit_large.
+ *
+ * @param ptr The address to decommit from.
+ * @param pages Large pages to decommit.
+ *
+ * @note @ref ptr must be large page aligned.
+ * @note Fails for explicit large pages on Windows, they can only be released.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_decommit_large(void *ptr, uint32_t pages);
+
+/**
+ * @brief Release address space reserved with @ref sn_vm_reserve_large.
+ *
+ * @param ptr The reserved address space.
+ * @param pages Number of large pages.
+ *
+ * @return Returns true on succes, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_release_large(void *ptr, uint32_t pages);
+
+/**
+ * @brief Start the background thread applying lazy decommits.
+ *
+ * @return Returns true on success (or if already started), false otherwise.
+ *
+ * @note Start and stop must not race with each other.
+ */
+SN_MEMORY_API bool sn_vm_lazy_decommit_start(void);
+
+/**
+ * @brief Apply all queued decommits and stop the background thread.
+ */
+SN_MEMORY_API void sn_vm_lazy_decommit_stop(void);
+
+/**
+ * @brief Queue a decommit to be applied by the background thread.
+ *
+ * Costs a lock and a store on the calling thread instead of the syscalls.
+ * Decommits are applied in batches every SN_VM_LAZY_DECOMMIT_INTERVAL_MS or
+ * once SN_VM_LAZY_DECOMMIT_BATCH are queued.
+ *
+ * @param ptr The address to decommit from.
+ * @param pages Pages to decommit.
+ *
+ * @note The range must be treated as decommitted right away, but it stays
+ *      resident until the background thread gets to it.
+ * @note Committing or releasing an overlapping range applies the pending
+ *      decommit first, so the usual commit/decommit rules still hold.
+ * @note Falls back to @ref sn_vm_decommit if the background thread is not
+ *      running or the queue is full.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_decommit_lazy(void *ptr, uint32_t pages);
+
+/**
+ * @brief Apply all queued decommits now.
+ */
+SN_MEMORY_API void sn_vm_lazy_decommit_flush(void);
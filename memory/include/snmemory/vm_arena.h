@@ -0,0 +1,156 @@
+#pragma once
+
+#include "snmemory/adapter.h"
+#include "snmemory/api.h"
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+/**
+ * @enum SnVmArenaFlags
+ * @brief Flags for @ref sn_vm_arena_init.
+ */
+typedef enum SnVmArenaFlags {
+    SN_VM_ARENA_FLAG_NONE = 0, /**< Chunks are committed back to back */
+    SN_VM_ARENA_FLAG_GUARD_PAGES = 1 << 0, /**< Leave an inaccessible page after every chunk */
+} SnVmArenaFlags;
+
+/**
+ * @struct SnVmArena
+ * @brief Linear allocator that reserves address space and commits it in chunks.
+ *
+ * With SN_VM_ARENA_FLAG_GUARD_PAGES every chunk is followed by a page that
+ * is never committed, so running off the end of a chunk faults right away.
+ * An allocation that does not fit the rest of its chunk starts a new one.
+ *
+ * Allocations of at least fence_threshold bytes get their own pages, placed
+ * so that they end right before an inaccessible page (electric fence). Small
+ * allocations keep using the current chunk.
+ *
+ * The guards are set up when a chunk is committed, the allocation fast path
+ * is the same bump as @ref SnLinearAllocator.
+ *
+ * @note
+ * - The page after the reservation is never committed either, so the
+ *   arena always ends in a guard page
+ * - None of the sn_vm_arena* functions are thread-safe
+ */
+typedef struct SnVmArena {
+    uint8_t *base; /**< Start of the reservation */
+    uint8_t *end; /**< End of the usable reservation, a guard page follows */
+
+    uint8_t *top; /**< Bump pointer */
+    uint8_t *chunk_end; /**< End of the chunk top is in */
+    uint8_t *high_water; /**< End of the furthest committed chunk or fenced allocation */
+
+    uint64_t chunk_size; /**< Size committed at a time */
+    uint64_t fence_threshold; /**< Smallest fenced allocation, UINT64_MAX if fencing is off */
+    uint64_t committed_size; /**< Bytes committed */
+    uint32_t flags; /**< SnVmArenaFlags */
+} SnVmArena;
+
+/**
+ * @brief Initialize a VM arena and commit its first chunk.
+ *
+ * @param arena Pointer to the arena.
+ * @param reserve_size Address space to reserve, rounded up to page size.
+ * @param chunk_size Size to commit at a time, rounded up to page size.
+ * @param flags Combination of SnVmArenaFlags.
+ * @param fence_threshold Allocations at least this large are fenced, 1 fences every allocation, 0 none.
+ *
+ * @return Returns true on success, false otherwise.
+ */
+SN_MEMORY_API bool sn_vm_arena_init(
+    SnVmArena *arena, uint64_t reserve_size, uint64_t chunk_size, uint32_t flags, uint64_t fence_threshold);
+
+/**
+ * @brief Release the reservation.
+ *
+ * @param arena Pointer to the arena.
+ */
+SN_MEMORY_API void sn_vm_arena_deinit(SnVmArena *arena);
+
+/**
+ * @brief Allocate when the current chunk is full or the allocation is fenced.
+ *
+ * @note Use @ref sn_vm_arena_allocate, it falls back to this.
+ */
+SN_MEMORY_API void *sn_vm_arena_allocate_slow(SnVmArena *arena, uint64_t size, uint64_t align);
+
+/**
+ * @brief Allocate from the arena.
+ *
+ * @param arena Pointer to the arena.
+ * @param size Number of bytes to allocate.
+ * @param align The alignment.
+ *
+ * @return Returns pointer to allocated memory or NULL on failure.
+ *
+ * @note A fenced allocation ends less than align bytes before its guard page.
+ */
+SN_INLINE void *sn_vm_arena_allocate(SnVmArena *arena, uint64_t size, uint64_t align) {
+    if (!size || !align || !arena) return NULL;
+
+    uint8_t *aligned = (uint8_t *)SN_GET_ALIGNED(arena->top, align);
+
+    if (size >= arena->fence_threshold || aligned + size > arena->chunk_end)
+        return sn_vm_arena_allocate_slow(arena, size, align);
+
+    arena->top = aligned + size;
+
+    return aligned;
+}
+
+/**
+ * @brief Clear all allocations and decommit everything past the first chunk.
+ *
+ * @param arena Pointer to the arena.
+ */
+SN_MEMORY_API void sn_vm_arena_reset(SnVmArena *arena);
+
+/**
+ * @brief Check if ptr lies in the part of the reservation the arena used.
+ *
+ * @param arena Pointer to the arena.
+ * @param ptr Pointer to check.
+ */
+SN_FORCE_INLINE bool sn_vm_arena_owns(SnVmArena *arena, const void *ptr) {
+    if (!arena) return false;
+    return (const uint8_t *)ptr >= arena->base && (const uint8_t *)ptr < arena->high_water;
+}
+
+/**
+ * @brief Get number of committed bytes, guard pages excluded.
+ *
+ * @param arena Pointer to the arena.
+ */
+SN_FORCE_INLINE uint64_t sn_vm_arena_get_committed_size(SnVmArena *arena) {
+    if (!arena) return 0;
+    return arena->committed_size;
+}
+
+/**
+ * @brief Get the SnMemoryAllocator.
+ *
+ * @param arena Pointer to the arena.
+ */
+SN_FORCE_INLINE SnMemoryAllocator sn_vm_arena_get_allocator(SnVmArena *arena) {
+    return (SnMemoryAllocator){
+        .data = arena,
+        .alloc = (SnMemoryAllocateFn)sn_vm_arena_allocate,
+        .realloc = NULL,
+        .free = NULL,
+    };
+}
+
+/**
+ * @brief Get the SnMemoryAdapter.
+ *
+ * @param arena Pointer to the arena.
+ */
+SN_FORCE_INLINE SnMemoryAdapter sn_vm_arena_get_adapter(SnVmArena *arena) {
+    return (SnMemoryAdapter){
+        .allocator = sn_vm_arena_get_allocator(arena),
+        .owns = (SnMemoryOwnsFn)sn_vm_arena_owns,
+    };
+}
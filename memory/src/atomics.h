@@ -0,0 +1,102 @@
+#pragma once
+
+#include <sncore/defines.h>
+
+// Minimal atomic helpers on plain integer and pointer fields.
+// Public structs keep plain types so headers stay usable from compilers
+// without C11 atomics (MSVC), only translation units use these helpers.
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+    #include <intrin.h>
+
+SN_FORCE_INLINE uint64_t sn_atomic_load_u64(volatile uint64_t *ptr) {
+    return (uint64_t)_InterlockedOr64((volatile long long *)ptr, 0);
+}
+
+// Plain aligned loads are atomic on every target MSVC supports
+SN_FORCE_INLINE uint64_t sn_atomic_load_relaxed_u64(volatile uint64_t *ptr) {
+    return *ptr;
+}
+
+SN_FORCE_INLINE void sn_atomic_store_u64(volatile uint64_t *ptr, uint64_t value) {
+    _InterlockedExchange64((volatile long long *)ptr, (long long)value);
+}
+
+SN_FORCE_INLINE uint64_t sn_atomic_add_u64(volatile uint64_t *ptr, uint64_t value) {
+    return (uint64_t)_InterlockedExchangeAdd64((volatile long long *)ptr, (long long)value);
+}
+
+SN_FORCE_INLINE uint64_t sn_atomic_exchange_u64(volatile uint64_t *ptr, uint64_t value) {
+    return (uint64_t)_InterlockedExchange64((volatile long long *)ptr, (long long)value);
+}
+
+SN_FORCE_INLINE bool sn_atomic_cas_u64(volatile uint64_t *ptr, uint64_t *expected, uint64_t desired) {
+    uint64_t previous = (uint64_t)_InterlockedCompareExchange64(
+        (volatile long long *)ptr, (long long)desired, (long long)*expected);
+    if (previous == *expected) return true;
+    *expected = previous;
+    return false;
+}
+
+SN_FORCE_INLINE uint32_t sn_atomic_load_u32(volatile uint32_t *ptr) {
+    return (uint32_t)_InterlockedOr((volatile long *)ptr, 0);
+}
+
+SN_FORCE_INLINE void sn_atomic_store_u32(volatile uint32_t *ptr, uint32_t value) {
+    _InterlockedExchange((volatile long *)ptr, (long)value);
+}
+
+SN_FORCE_INLINE uint32_t sn_atomic_add_u32(volatile uint32_t *ptr, uint32_t value) {
+    return (uint32_t)_InterlockedExchangeAdd((volatile long *)ptr, (long)value);
+}
+
+// Interlocked operations are full barriers
+SN_FORCE_INLINE void sn_atomic_fence(void) {
+    volatile long barrier = 0;
+    _InterlockedOr(&barrier, 0);
+}
+
+#else
+
+SN_FORCE_INLINE uint64_t sn_atomic_load_u64(volatile uint64_t *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+SN_FORCE_INLINE uint64_t sn_atomic_load_relaxed_u64(volatile uint64_t *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+}
+
+SN_FORCE_INLINE void sn_atomic_store_u64(volatile uint64_t *ptr, uint64_t value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+SN_FORCE_INLINE uint64_t sn_atomic_add_u64(volatile uint64_t *ptr, uint64_t value) {
+    return __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+}
+
+SN_FORCE_INLINE uint64_t sn_atomic_exchange_u64(volatile uint64_t *ptr, uint64_t value) {
+    return __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+SN_FORCE_INLINE bool sn_atomic_cas_u64(volatile uint64_t *ptr, uint64_t *expected, uint64_t desired) {
+    return __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+SN_FORCE_INLINE uint32_t sn_atomic_load_u32(volatile uint32_t *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+SN_FORCE_INLINE void sn_atomic_store_u32(volatile uint32_t *ptr, uint32_t value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+SN_FORCE_INLINE uint32_t sn_atomic_add_u32(volatile uint32_t *ptr, uint32_t value) {
+    return __atomic_fetch_add(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+SN_FORCE_INLINE void sn_atomic_fence(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include "snmemory/compose.h"
+
+#include <string.h>
+
+static SnPoolAllocator *find_bucket(SnBucketizerAllocator *alloc, uint64_t size, uint64_t align);
+
+static SnPoolAllocator *find_owner(SnBucketizerAllocator *alloc, const void *ptr);
+
+void *sn_fallback_allocator_allocate(SnFallbackAllocator *alloc, uint64_t size, uint64_t align) {
+    if (!alloc) return NULL;
+
+    void *ptr = sn_memory_adapter_allocate(&alloc->primary, size, align);
+    if (!ptr) ptr = sn_memory_adapter_allocate(&alloc->secondary, size, align);
+
+    return ptr;
+}
+
+void *sn_fallback_allocator_reallocate(SnFallbackAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align) {
+    if (!ptr || !alloc) return NULL;
+
+    SnMemoryAdapter *owner = sn_memory_adapter_owns(&alloc->primary, ptr) ? &alloc->primary : &alloc->secondary;
+    if (!owner->allocator.realloc) return NULL;
+
+    return owner->allocator.realloc(owner->allocator.data, ptr, new_size, align);
+}
+
+void sn_fallback_allocator_free(SnFallbackAllocator *alloc, void *ptr) {
+    if (!ptr || !alloc) return;
+
+    if (sn_memory_adapter_owns(&alloc->primary, ptr)) sn_memory_adapter_free(&alloc->primary, ptr);
+    else sn_memory_adapter_free(&alloc->secondary, ptr);
+}
+
+void sn_fallback_allocator_free_sized(SnFallbackAllocator *alloc, void *ptr, uint64_t size, uint64_t align) {
+    if (!ptr || !alloc) return;
+
+    if (sn_memory_adapter_owns(&alloc->primary, ptr)) sn_memory_adapter_free_sized(&alloc->primary, ptr, size, align);
+    else sn_memory_adapter_free_sized(&alloc->secondary, ptr, size, align);
+}
+
+bool sn_fallback_allocator_owns(SnFallbackAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return sn_memory_adapter_owns(&alloc->primary, ptr) || sn_memory_adapter_owns(&alloc->secondary, ptr);
+}
+
+void *sn_segregator_allocator_reallocate(SnSegregatorAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align) {
+    if (!ptr || !alloc) return NULL;
+
+    bool owned_by_small = alloc->small.owns ? sn_memory_adapter_owns(&alloc->small, ptr)
+                                            : !sn_memory_adapter_owns(&alloc->large, ptr);
+    bool fits_small = new_size <= alloc->threshold;
+
+    if (owned_by_small == fits_small) {
+        SnMemoryAdapter *owner = owned_by_small ? &alloc->small : &alloc->large;
+        if (!owner->allocator.realloc) return NULL;
+        return owner->allocator.realloc(owner->allocator.data, ptr, new_size, align);
+    }
+
+    // The size moves to the other side. Sized frees route by size, so the
+    // block has to move too. Only a shrink knows how much to copy.
+    if (owned_by_small) return NULL;
+
+    void *new_ptr = sn_memory_adapter_allocate(&alloc->small, new_size, align);
+    if (!new_ptr) return NULL;
+
+    memcpy(new_ptr, ptr, new_size);
+
+    sn_memory_adapter_free(&alloc->large, ptr);
+
+    return new_ptr;
+}
+
+void sn_segregator_allocator_free(SnSegregatorAllocator *alloc, void *ptr) {
+    if (!ptr || !alloc) return;
+
+    SN_ASSERT(alloc->small.owns || alloc->large.owns);
+
+    if (alloc->small.owns) {
+        if (sn_memory_adapter_owns(&alloc->small, ptr)) sn_memory_adapter_free(&alloc->small, ptr);
+        else sn_memory_adapter_free(&alloc->large, ptr);
+    } else {
+        if (sn_memory_adapter_owns(&alloc->large, ptr)) sn_memory_adapter_free(&alloc->large, ptr);
+        else sn_memory_adapter_free(&alloc->small, ptr);
+    }
+}
+
+bool sn_bucketizer_allocator_init(SnBucketizerAllocator *alloc, SnPoolAllocator *pools, uint32_t pool_count) {
+    if (!alloc || !pools || !pool_count) return false;
+
+    for (uint32_t i = 1; i < pool_count; ++i) {
+        if (pools[i].block_size <= pools[i - 1].block_size) return false;
+    }
+
+    *alloc = (SnBucketizerAllocator){.pools = pools, .pool_count = pool_count};
+
+    return true;
+}
+
+void *sn_bucketizer_allocator_allocate(SnBucketizerAllocator *alloc, uint64_t size, uint64_t align) {
+    if (!size || !align || !alloc) return NULL;
+
+    SnPoolAllocator *pool = find_bucket(alloc, size, align);
+    if (!pool) return NULL;
+
+    return sn_pool_allocator_allocate(pool);
+}
+
+void *sn_bucketizer_allocator_reallocate(SnBucketizerAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align) {
+    if (!ptr || !new_size || !align || !alloc) return NULL;
+
+    SnPoolAllocator *owner = find_owner(alloc, ptr);
+    SN_ASSERT(owner);
+
+    if (new_size <= owner->block_size && SN_IS_ALIGNED(ptr, align)) return ptr;
+
+    void *new_ptr = sn_bucketizer_allocator_allocate(alloc, new_size, align);
+    if (!new_ptr) return NULL;
+
+    memcpy(new_ptr, ptr, SN_MIN(new_size, owner->block_size));
+
+    sn_pool_allocator_free(owner, ptr);
+
+    return new_ptr;
+}
+
+void sn_bucketizer_allocator_free(SnBucketizerAllocator *alloc, void *ptr) {
+    if (!ptr || !alloc) return;
+
+    SnPoolAllocator *owner = find_owner(alloc, ptr);
+    SN_ASSERT(owner);
+
+    sn_pool_allocator_free(owner, ptr);
+}
+
+bool sn_bucketizer_allocator_owns(SnBucketizerAllocator *alloc, const void *ptr) {
+    if (!alloc) return false;
+    return find_owner(alloc, ptr) != NULL;
+}
+
+static SnPoolAllocator *find_bucket(SnBucketizerAllocator *alloc, uint64_t size, uint64_t align) {
+    for (uint32_t i = 0; i < alloc->pool_count; ++i) {
+        SnPoolAllocator *pool = &alloc->pools[i];
+        if (pool->block_size >= size && pool->block_align >= align) return pool;
+    }
+
+    return NULL;
+}
+
+static SnPoolAllocator *find_owner(SnBucketizerAllocator *alloc, const void *ptr) {
+    for (uint32_t i = 0; i < alloc->pool_count; ++i) {
+        if (sn_pool_allocator_owns(&alloc->pools[i], ptr)) return &alloc->pools[i];
+    }
+
+    return NULL;
+}
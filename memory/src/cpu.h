@@ -0,0 +1,48 @@
+#pragma once
+
+#include <sncore/defines.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    #include <intrin.h>
+#endif
+
+// Private CPU queries, implemented per platform in nix/ and win32/.
+
+// Cache line size used when the OS does not report one
+#define SN_CPU_DEFAULT_CACHE_LINE_SIZE 64
+
+/**
+ * @brief Get the number of configured CPUs.
+ */
+uint32_t sn_cpu_count(void);
+
+/**
+ * @brief Get the CPU the calling thread runs on.
+ *
+ * Uses the rseq area registered by glibc when available, then
+ * sched_getcpu. Platforms without either return a per thread index, so
+ * callers still spread over their slots.
+ *
+ * @note The thread may migrate right after the call, the result is a hint.
+ */
+uint32_t sn_cpu_current(void);
+
+/**
+ * @brief Get the L1 data cache line size.
+ */
+uint64_t sn_cpu_cache_line_size(void);
+
+/**
+ * @brief Hint the CPU that the caller is spinning.
+ */
+SN_FORCE_INLINE void sn_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    __yield();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
@@ -1,6 +1,7 @@
 #include "snmemory/freelist.h"
 
 #include <sncore/utils.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define SPLITTING_THRESHOLD (sizeof(SnFreeNode) + SN_FREELIST_SPLITTING_THRESHOLD)
@@ -8,38 +9,76 @@
 #define NODE_END(node) (((uint8_t *)((node) + 1)) + (node)->size)
 #define PADDING_BYTE(ptr) ((void *)(((uint8_t *)ptr) - 1))
 
-static SnFreeNode *first_fit(SnFreeNode *freenode, uint64_t size, SnFreeNode **previous_freenode);
+// Compact blocks have a single size word in front of the user pointer, it
+// is the size of the node or, with this bit set, the distance back to it
+#define COMPACT_HEADER_SIZE sizeof(uint64_t)
+#define COMPACT_PADDED_FLAG 1ULL
+#define COMPACT_HEADER(ptr) (((uint64_t *)(ptr)) - 1)
+
+#define IN_BUFFER(alloc, ptr) \
+    ((uint8_t *)(ptr) >= (alloc)->mem && (uint8_t *)(ptr) < (alloc)->mem + (alloc)->size)
+
+// Large blocks reserve this many times their size, to grow in place
+#define LARGE_RESERVE_FACTOR 2
+
+static SnFreeNode *find_free_node(SnFreeListAllocator *alloc, uint64_t size, SnFreeNode **previous_freenode);
+
+static SnFreeNode *first_fit(
+    SnFreeListAllocator *alloc, SnFreeNode *previous, SnFreeNode *end, uint64_t size, SnFreeNode **previous_freenode);
+
+static SnFreeNode *best_fit(SnFreeListAllocator *alloc, uint64_t size, SnFreeNode **previous_freenode);
+
+static void absorb_next(SnFreeListAllocator *alloc, SnFreeNode *node);
+
+static uint64_t get_request_size(SnFreeListAllocator *alloc, uint64_t size, uint64_t align);
+
+static void *take_node(
+    SnFreeListAllocator *alloc, SnFreeNode *node, SnFreeNode **previous, uint64_t size, uint64_t align);
+
+static SnFreeNode *get_node(SnFreeListAllocator *alloc, void *ptr);
+
+static void *allocate_large(SnFreeListAllocator *alloc, uint64_t size, uint64_t align);
+
+static void insert_large(SnFreeListAllocator *alloc, SnFreeListLargeBlock block);
+
+static void remove_large(SnFreeListAllocator *alloc, SnFreeListLargeBlock *block);
+
+static void free_large(SnFreeListAllocator *alloc, SnFreeListLargeBlock *block);
+
+static void *reallocate_large(SnFreeListAllocator *alloc, SnFreeListLargeBlock *block, uint64_t new_size);
 
 static void sn_write_to_bytes(void *bytes, uint64_t value, bool reverse);
 
 static uint64_t sn_read_from_bytes(void *bytes, bool reverse);
 
-static void try_merge(SnFreeNode *previous_node, SnFreeNode *node);
+static void try_merge(SnFreeListAllocator *alloc, SnFreeNode *previous_node, SnFreeNode *node);
 
 static SnFreeNode *get_previous_free_node(SnFreeNode *freelist, SnFreeNode *node);
 
 static void split_node_if_possible(SnFreeNode *node, uint64_t allocated_size);
 
+static void insert_free_node(SnFreeListAllocator *alloc, SnFreeNode *node);
+
+static int compare_pointers(const void *a, const void *b);
+
 void *sn_freelist_allocator_allocate(SnFreeListAllocator *alloc, uint64_t size, uint64_t align) {
     if (!size || !align || !alloc) return NULL;
 
-    if (!alloc->free_list) return NULL;
+    if (size >= alloc->large_threshold) {
+        void *ptr = allocate_large(alloc, size, align);
+        if (ptr) return ptr;
+    }
 
-    size = SN_GET_ALIGNED(size, align);
-    size += align;
+    if (!alloc->free_list) return NULL;
 
     SnFreeNode *previous_freenode = NULL;
-    SnFreeNode *node = first_fit(alloc->free_list, size, &previous_freenode);
+    SnFreeNode *node = find_free_node(alloc, get_request_size(alloc, size, align), &previous_freenode);
     if (!node) return NULL;
 
-    // Get next aligned number (ensures we have padding before user pointer)
-    void *aligned = (void *)SN_GET_NEXT_ALIGNED(node + 1, align);
-    sn_write_to_bytes(PADDING_BYTE(aligned), SN_PTR_DIFF(aligned, node), true);
+    void *aligned = take_node(alloc, node, &previous_freenode, size, align);
 
-    split_node_if_possible(node, size);
-
-    if (previous_freenode) previous_freenode->next = node->next;
-    else alloc->free_list = node->next;
+    // Next fit continues with the split remainder (or the next node)
+    alloc->rover = previous_freenode;
 
     return aligned;
 }
@@ -47,32 +86,167 @@ void *sn_freelist_allocator_allocate(SnFreeListAllocator *alloc, uint64_t size,
 void sn_freelist_allocator_free(SnFreeListAllocator *alloc, void *ptr) {
     if (!ptr || !alloc) return;
 
-    uint64_t diff_to_node = sn_read_from_bytes(PADDING_BYTE(ptr), true);
-    SnFreeNode *node = (SnFreeNode *)(((uint8_t *)ptr) - diff_to_node);
+    if (alloc->large_count && !IN_BUFFER(alloc, ptr)) {
+        free_large(alloc, sn_freelist_allocator_find_large_block(alloc, ptr));
+        return;
+    }
+
+    insert_free_node(alloc, get_node(alloc, ptr));
+}
+
+void sn_freelist_allocator_free_sized(SnFreeListAllocator *alloc, void *ptr, uint64_t size, uint64_t align) {
+    if (!ptr || !alloc) return;
+
+    // Large blocks are told apart by where they live, a shrunk one is small by now
+    if (alloc->large_count && !IN_BUFFER(alloc, ptr)) {
+        free_large(alloc, sn_freelist_allocator_find_large_block(alloc, ptr));
+        return;
+    }
 
-    SnFreeNode *previous_freenode = get_previous_free_node(alloc->free_list, node);
+    // Nodes are aligned to SnFreeNode, so for small alignments the user
+    // pointer is always exactly align bytes after the node header.
+    // Compact headers are decoded without a loop anyway.
+    if (align > alignof(SnFreeNode) || alloc->compact || size >= alloc->large_threshold) {
+        sn_freelist_allocator_free(alloc, ptr);
+        return;
+    }
 
-    if (!previous_freenode) {
-        node->next = alloc->free_list;
-        previous_freenode = alloc->free_list = node;
-        node = node->next;
-    } else {
-        node->next = previous_freenode->next;
-        previous_freenode->next = node;
+    SnFreeNode *node = (SnFreeNode *)(((uint8_t *)ptr) - align - sizeof(SnFreeNode));
+
+    SN_ASSERT(sn_read_from_bytes(PADDING_BYTE(ptr), true) == align + sizeof(SnFreeNode));
+    SN_ASSERT(SN_PTR_DIFF(NODE_END(node), ptr) >= size);
+    SN_UNUSED(size);
+
+    insert_free_node(alloc, node);
+}
+
+uint64_t sn_freelist_allocator_allocate_batch(
+    SnFreeListAllocator *alloc, void **out_ptrs, uint64_t count, uint64_t size, uint64_t align) {
+    if (!size || !align || !alloc || !out_ptrs) return 0;
+
+    if (size >= alloc->large_threshold) {
+        uint64_t allocated = 0;
+        for (; allocated < count; ++allocated) {
+            out_ptrs[allocated] = sn_freelist_allocator_allocate(alloc, size, align);
+            if (!out_ptrs[allocated]) break;
+        }
+        return allocated;
+    }
+
+    uint64_t request_size = get_request_size(alloc, size, align);
+    uint64_t allocated = 0;
+
+    if (alloc->policy != SN_FREELIST_FIRST_FIT) {
+        // Next fit and best fit place every block through the policy
+        for (; allocated < count; ++allocated) {
+            if (!alloc->free_list) break;
+
+            SnFreeNode *previous_freenode = NULL;
+            SnFreeNode *node = find_free_node(alloc, request_size, &previous_freenode);
+            if (!node) break;
+
+            out_ptrs[allocated] = take_node(alloc, node, &previous_freenode, size, align);
+            alloc->rover = previous_freenode;
+        }
+        return allocated;
+    }
+
+    // Every block has the same size, so nodes skipped for one block are
+    // too small for the rest as well and the scan resumes where it stopped.
+    SnFreeNode *previous_freenode = NULL;
+    SnFreeNode *node = alloc->free_list;
+
+    uint64_t scanned = 0;
+    while (node && allocated < count) {
+        scanned++;
+        if (node->size < request_size) {
+            previous_freenode = node;
+            node = node->next;
+            continue;
+        }
+
+        out_ptrs[allocated++] = take_node(alloc, node, &previous_freenode, size, align);
+
+        // Continue from the split remainder (or the next node)
+        node = previous_freenode ? previous_freenode->next : alloc->free_list;
     }
 
-    try_merge(previous_freenode, node);
+    alloc->rover = previous_freenode;
+    alloc->scanned_nodes += scanned;
+
+    return allocated;
+}
+
+void sn_freelist_allocator_free_batch(SnFreeListAllocator *alloc, void **ptrs, uint64_t count) {
+    if (!alloc || !ptrs || !count) return;
+
+    qsort(ptrs, count, sizeof(void *), compare_pointers);
+
+    SnFreeNode *previous_freenode = NULL;
+    SnFreeNode *freenode = alloc->free_list;
+
+    for (uint64_t i = 0; i < count; ++i) {
+        if (!ptrs[i]) continue;
+
+        if (alloc->large_count && !IN_BUFFER(alloc, ptrs[i])) {
+            free_large(alloc, sn_freelist_allocator_find_large_block(alloc, ptrs[i]));
+            continue;
+        }
+
+        SnFreeNode *node = get_node(alloc, ptrs[i]);
+
+        while (freenode && freenode < node) {
+            previous_freenode = freenode;
+            freenode = freenode->next;
+        }
+
+        // Merge with the previous free node or link after it
+        if (previous_freenode && NODE_END(previous_freenode) == (uint8_t *)node) {
+            previous_freenode->size += sizeof(SnFreeNode) + node->size;
+            node = previous_freenode;
+        } else {
+            if (previous_freenode) previous_freenode->next = node;
+            else alloc->free_list = node;
+        }
+        node->next = freenode;
+
+        // Merge with the next free node
+        if (freenode && NODE_END(node) == (uint8_t *)freenode) {
+            absorb_next(alloc, node);
+            freenode = node->next;
+        }
+
+        previous_freenode = node;
+    }
 }
 
 void *sn_freelist_allocator_reallocate(SnFreeListAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align) {
     if (!ptr || !new_size || !align || !alloc) return NULL;
 
-    uint64_t diff_to_node = sn_read_from_bytes(PADDING_BYTE(ptr), true);
-    SnFreeNode *node = (SnFreeNode *)(((uint8_t *)ptr) - diff_to_node);
+    if (alloc->large_count && !IN_BUFFER(alloc, ptr)) {
+        SnFreeListLargeBlock *block = sn_freelist_allocator_find_large_block(alloc, ptr);
+        if (SN_IS_ALIGNED(ptr, align)) return reallocate_large(alloc, block, new_size);
+
+        // Unreachable for page or smaller alignments
+        void *new_ptr = sn_freelist_allocator_allocate(alloc, new_size, align);
+        if (!new_ptr) return NULL;
+
+        memcpy(new_ptr, ptr, SN_MIN(new_size, block->size));
+        free_large(alloc, block);
+        return new_ptr;
+    }
+
+    SnFreeNode *node = get_node(alloc, ptr);
 
     uint64_t current_size = SN_PTR_DIFF(NODE_END(node), ptr);
 
-    if (!SN_IS_ALIGNED(ptr, align)) goto alloc_copy_free;
+    // Node size needed to keep the padding in front of ptr, compact blocks
+    // keep following nodes aligned with a whole number of size words
+    uint64_t payload_size = alloc->compact ? SN_GET_ALIGNED(new_size, COMPACT_HEADER_SIZE) : new_size;
+    uint64_t required_size = SN_PTR_DIFF(ptr, node) + payload_size - sizeof(SnFreeNode);
+
+    // Blocks growing past the threshold move to their own mapping
+    if (!SN_IS_ALIGNED(ptr, align) || new_size >= alloc->large_threshold) goto alloc_copy_free;
 
     SnFreeNode *previous_freenode = NULL;
     SnFreeNode *freenode = alloc->free_list;
@@ -82,39 +256,48 @@ void *sn_freelist_allocator_reallocate(SnFreeListAllocator *alloc, void *ptr, ui
         freenode = freenode->next;
     }
 
+    // The next pointer of a compact block holds its header or user data,
+    // keep it while the node is faked as a free node
+    uint64_t next_word;
+    memcpy(&next_word, &node->next, sizeof(next_word));
+
     if (current_size >= new_size) {
         // Fake this node as freenode and make it point to next free node
         if (previous_freenode) node->next = previous_freenode->next;
         else node->next = alloc->free_list;
 
-        split_node_if_possible(node, new_size + align);
+        split_node_if_possible(node, required_size);
 
         // try to merge that new freenode with next node
-        if (node->next) try_merge(node->next, node->next->next);
+        if (node->next) try_merge(alloc, node->next, node->next->next);
 
         // Whether it was split or not, this works
         if (previous_freenode) previous_freenode->next = node->next;
         else alloc->free_list = node->next;
 
+        memcpy(&node->next, &next_word, sizeof(next_word));
         return ptr;
     }
 
     // Try to extend
-    if (freenode == (SnFreeNode *)NODE_END(node) && (node->size + freenode->size + sizeof(SnFreeNode)) > new_size) {
+    if (freenode == (SnFreeNode *)NODE_END(node)
+        && (node->size + freenode->size + sizeof(SnFreeNode)) >= required_size) {
         // We have a freenode right next to this node
 
-        // Merge both nodes
+        // Merge both nodes, node is not on the list so the rover can not stay on freenode
         node->size += sizeof(SnFreeNode) + freenode->size;
+        if (alloc->rover == freenode) alloc->rover = previous_freenode;
 
         // Fake this node as freenode and make it point to next freenode
         node->next = freenode->next;
 
-        split_node_if_possible(node, new_size + align);
+        split_node_if_possible(node, required_size);
 
         // Remove that merged node from freelist
         if (previous_freenode) previous_freenode->next = node->next;
         else alloc->free_list = node->next;
 
+        memcpy(&node->next, &next_word, sizeof(next_word));
         return ptr;
     }
 
@@ -144,6 +327,7 @@ void sn_freelist_allocator_increase_memory_size(SnFreeListAllocator *alloc, void
             .size = SN_PTR_DIFF(((uint8_t *)mem) + size, alloc->free_list + 1),
             .next = NULL,
         };
+        if (alloc->compact) alloc->free_list->size &= ~(COMPACT_HEADER_SIZE - 1);
         return;
     }
 
@@ -156,6 +340,7 @@ void sn_freelist_allocator_increase_memory_size(SnFreeListAllocator *alloc, void
             SN_ASSERT(cur_node->next == NULL);
             // We found it, just add the size
             cur_node->size += size;
+            if (alloc->compact) cur_node->size &= ~(COMPACT_HEADER_SIZE - 1);
             return;
         }
 
@@ -174,23 +359,249 @@ void sn_freelist_allocator_increase_memory_size(SnFreeListAllocator *alloc, void
         .size = SN_PTR_DIFF(((uint8_t *)mem) + size, new_node + 1),
         .next = NULL,
     };
+    if (alloc->compact) new_node->size &= ~(COMPACT_HEADER_SIZE - 1);
     last_node->next = new_node;
 }
 
-static SnFreeNode *first_fit(SnFreeNode *freenode, uint64_t size, SnFreeNode **previous_freenode) {
+static uint64_t get_request_size(SnFreeListAllocator *alloc, uint64_t size, uint64_t align) {
+    if (!alloc->compact) return SN_GET_ALIGNED(size, align) + align;
+
+    // The user pointer takes the place of the next pointer, nodes are only
+    // size word aligned so a larger alignment may need that much padding
+    uint64_t padding = align > COMPACT_HEADER_SIZE ? align - COMPACT_HEADER_SIZE : 0;
+    return SN_GET_ALIGNED(size, COMPACT_HEADER_SIZE) + padding - COMPACT_HEADER_SIZE;
+}
+
+static void *take_node(
+    SnFreeListAllocator *alloc, SnFreeNode *node, SnFreeNode **previous, uint64_t size, uint64_t align) {
+    uint8_t *aligned;
+
+    if (!alloc->compact) {
+        // Get next aligned number (ensures we have padding before user pointer)
+        aligned = (uint8_t *)SN_GET_NEXT_ALIGNED(node + 1, align);
+        sn_write_to_bytes(PADDING_BYTE(aligned), SN_PTR_DIFF(aligned, node), true);
+
+        split_node_if_possible(node, SN_GET_ALIGNED(size, align) + align);
+    } else {
+        aligned = (uint8_t *)SN_GET_ALIGNED(((uint8_t *)node) + COMPACT_HEADER_SIZE, align);
+        uint64_t padding = SN_PTR_DIFF(aligned, node) - COMPACT_HEADER_SIZE;
+
+        if (padding >= SPLITTING_THRESHOLD) {
+            // Large alignment, keep the padding as a free node of its own
+            SnFreeNode *block = (SnFreeNode *)(aligned - COMPACT_HEADER_SIZE);
+            *block = (SnFreeNode){.size = SN_PTR_DIFF(NODE_END(node), block + 1), .next = node->next};
+            *node = (SnFreeNode){.size = SN_PTR_DIFF(block, node + 1), .next = block};
+
+            *previous = node;
+            node = block;
+        }
+
+        uint64_t payload_size = SN_GET_ALIGNED(size, COMPACT_HEADER_SIZE);
+        split_node_if_possible(node, SN_PTR_DIFF(aligned, node) + payload_size - sizeof(SnFreeNode));
+    }
+
+    if (*previous) (*previous)->next = node->next;
+    else alloc->free_list = node->next;
+
+    // Without padding the size word of the node is the header, the header
+    // of a padded block overwrites the next pointer so it goes in last
+    if (alloc->compact && aligned != ((uint8_t *)node) + COMPACT_HEADER_SIZE)
+        *COMPACT_HEADER(aligned) = SN_PTR_DIFF(aligned, node) | COMPACT_PADDED_FLAG;
+
+    return aligned;
+}
+
+static SnFreeNode *get_node(SnFreeListAllocator *alloc, void *ptr) {
+    uint64_t diff_to_node;
+
+    if (!alloc->compact) {
+        diff_to_node = sn_read_from_bytes(PADDING_BYTE(ptr), true);
+    } else {
+        uint64_t header = *COMPACT_HEADER(ptr);
+        diff_to_node = header & COMPACT_PADDED_FLAG ? header & ~COMPACT_PADDED_FLAG : COMPACT_HEADER_SIZE;
+    }
+
+    return (SnFreeNode *)(((uint8_t *)ptr) - diff_to_node);
+}
+
+static void *allocate_large(SnFreeListAllocator *alloc, uint64_t size, uint64_t align) {
+    uint64_t page_size = sn_vm_get_page_size();
+    if (alloc->large_count == alloc->large_capacity || align > page_size) return NULL;
+
+    size = SN_GET_ALIGNED(size, page_size);
+    uint64_t reserved_size = size * LARGE_RESERVE_FACTOR;
+
+    uint8_t *ptr = sn_vm_reserve_range(NULL, reserved_size);
+    if (!ptr) return NULL;
+
+    if (!sn_vm_commit_range(ptr, size, SN_VM_FLAG_NONE)) {
+        sn_vm_release_range(ptr, reserved_size);
+        return NULL;
+    }
+
+    insert_large(alloc, (SnFreeListLargeBlock){
+        .ptr = ptr,
+        .size = size,
+        .reserved_size = reserved_size,
+    });
+
+    return ptr;
+}
+
+static void insert_large(SnFreeListAllocator *alloc, SnFreeListLargeBlock block) {
+    SN_ASSERT(alloc->large_count < alloc->large_capacity);
+
+    uint32_t i = sn_freelist_allocator_get_large_slot(alloc, block.ptr);
+    while (alloc->large_blocks[i].ptr)
+        if (++i == alloc->large_capacity) i = 0;
+
+    alloc->large_blocks[i] = block;
+    alloc->large_count++;
+}
+
+static void remove_large(SnFreeListAllocator *alloc, SnFreeListLargeBlock *block) {
+    uint32_t capacity = alloc->large_capacity;
+    uint32_t hole = (uint32_t)(block - alloc->large_blocks);
+    uint32_t i = hole;
+
+    // Shift later entries of the probe run back so that no lookup stops at the hole
+    for (uint32_t probed = 1; probed < capacity; ++probed) {
+        if (++i == capacity) i = 0;
+        if (!alloc->large_blocks[i].ptr) break;
+
+        // Entries whose probe starts after the hole are still reachable
+        uint32_t slot = sn_freelist_allocator_get_large_slot(alloc, alloc->large_blocks[i].ptr);
+        bool reachable = hole < i ? (slot > hole && slot <= i) : (slot > hole || slot <= i);
+        if (reachable) continue;
+
+        alloc->large_blocks[hole] = alloc->large_blocks[i];
+        hole = i;
+    }
+
+    alloc->large_blocks[hole] = (SnFreeListLargeBlock){0};
+    alloc->large_count--;
+}
+
+static void free_large(SnFreeListAllocator *alloc, SnFreeListLargeBlock *block) {
+    SN_ASSERT(block);  // ptr was not returned by this allocator
+    if (!block) return;
+
+    sn_vm_release_range(block->ptr, block->reserved_size);
+    remove_large(alloc, block);
+}
+
+static void *reallocate_large(SnFreeListAllocator *alloc, SnFreeListLargeBlock *block, uint64_t new_size) {
+    SN_ASSERT(block);
+    if (!block) return NULL;
+
+    uint64_t size = SN_GET_ALIGNED(new_size, sn_vm_get_page_size());
+
+    if (size <= block->size) {
+        // Hand the tail pages back, the range stays reserved for regrowth
+        if (size < block->size && !sn_vm_decommit_range(block->ptr + size, block->size - size)) return NULL;
+        block->size = size;
+        return block->ptr;
+    }
+
+    if (size <= block->reserved_size) {
+        if (!sn_vm_commit_range(block->ptr + block->size, size - block->size, SN_VM_FLAG_NONE)) return NULL;
+        block->size = size;
+        return block->ptr;
+    }
+
+    // Outgrew the reservation, resize it as one committed range so that the
+    // pages are remapped rather than copied where the platform allows
+    uint64_t reserved_size = size * LARGE_RESERVE_FACTOR;
+    uint64_t headroom = block->reserved_size - block->size;
+    if (headroom && !sn_vm_commit_range(block->ptr + block->size, headroom, SN_VM_FLAG_NONE)) return NULL;
+
+    uint8_t *ptr = sn_vm_resize(block->ptr, block->reserved_size, reserved_size);
+    if (!ptr) {
+        if (headroom) sn_vm_decommit_range(block->ptr + block->size, headroom);
+        return NULL;
+    }
+
+    sn_vm_decommit_range(ptr + size, reserved_size - size);
+
+    // The registry is keyed by the start, a moved block goes in under the new one
+    remove_large(alloc, block);
+    insert_large(alloc, (SnFreeListLargeBlock){
+        .ptr = ptr,
+        .size = size,
+        .reserved_size = reserved_size,
+    });
+
+    return ptr;
+}
+
+static SnFreeNode *find_free_node(SnFreeListAllocator *alloc, uint64_t size, SnFreeNode **previous_freenode) {
+    switch (alloc->policy) {
+        case SN_FREELIST_NEXT_FIT: {
+            // Scan on from the rover, then wrap around up to it
+            SnFreeNode *rover = alloc->rover;
+            SnFreeNode *node = first_fit(alloc, rover, NULL, size, previous_freenode);
+            if (!node && rover) node = first_fit(alloc, NULL, rover->next, size, previous_freenode);
+            return node;
+        }
+        case SN_FREELIST_BEST_FIT:
+            return best_fit(alloc, size, previous_freenode);
+        case SN_FREELIST_FIRST_FIT:
+        default:
+            return first_fit(alloc, NULL, NULL, size, previous_freenode);
+    }
+}
+
+static SnFreeNode *first_fit(
+    SnFreeListAllocator *alloc, SnFreeNode *previous, SnFreeNode *end, uint64_t size, SnFreeNode **previous_freenode) {
+    SnFreeNode *freenode = previous ? previous->next : alloc->free_list;
+    uint64_t scanned = 0;
+
+    while (freenode != end) {
+        scanned++;
+        if (freenode->size >= size) {
+            *previous_freenode = previous;
+            break;
+        }
+
+        previous = freenode;
+        freenode = freenode->next;
+    }
+
+    alloc->scanned_nodes += scanned;
+    return freenode == end ? NULL : freenode;
+}
+
+static SnFreeNode *best_fit(SnFreeListAllocator *alloc, uint64_t size, SnFreeNode **previous_freenode) {
+    SnFreeNode *best = NULL;
     SnFreeNode *previous = NULL;
+    SnFreeNode *freenode = alloc->free_list;
+    uint64_t scanned = 0;
 
     while (freenode) {
-        if (freenode->size >= size) {
-            if (previous_freenode) *previous_freenode = previous;
-            return freenode;
+        scanned++;
+        if (freenode->size >= size && (!best || freenode->size < best->size)) {
+            best = freenode;
+            *previous_freenode = previous;
+
+            // Nothing fits better than an exact fit
+            if (freenode->size == size) break;
         }
 
         previous = freenode;
         freenode = freenode->next;
     }
 
-    return NULL;
+    alloc->scanned_nodes += scanned;
+    return best;
+}
+
+static void absorb_next(SnFreeListAllocator *alloc, SnFreeNode *node) {
+    SnFreeNode *next = node->next;
+    node->size += sizeof(SnFreeNode) + next->size;
+    node->next = next->next;
+
+    // Keep the rover on the list
+    if (alloc->rover == next) alloc->rover = node;
 }
 
 static SnFreeNode *get_previous_free_node(SnFreeNode *freelist, SnFreeNode *node) {
@@ -204,21 +615,20 @@ static SnFreeNode *get_previous_free_node(SnFreeNode *freelist, SnFreeNode *node
     return previous_node;
 }
 
-static void try_merge(SnFreeNode *previous_node, SnFreeNode *node) {
+static void try_merge(SnFreeListAllocator *alloc, SnFreeNode *previous_node, SnFreeNode *node) {
     // Previous node is never NULL, node can be NULL
     if (NODE_END(previous_node) == ((uint8_t *)node)) {
-        previous_node->size += sizeof(SnFreeNode) + node->size;
-        previous_node->next = node->next;
+        absorb_next(alloc, previous_node);
 
-        try_merge(previous_node, previous_node->next);
+        try_merge(alloc, previous_node, previous_node->next);
     } else if (node && NODE_END(node) == (uint8_t *)node->next) {
-        node->size += sizeof(SnFreeNode) + node->next->size;
-        node->next = node->next->next;
+        absorb_next(alloc, node);
     }
 }
 
 static void split_node_if_possible(SnFreeNode *node, uint64_t allocated_size) {
-    if (node->size - allocated_size < SPLITTING_THRESHOLD) return;  // Not enough space to split
+    if (node->size < allocated_size || node->size - allocated_size < SPLITTING_THRESHOLD)
+        return;  // Not enough space to split
 
     SnFreeNode *new_node = SN_GET_ALIGNED_PTR(((uint8_t *)(node + 1)) + allocated_size, SnFreeNode);
 
@@ -227,3 +637,23 @@ static void split_node_if_possible(SnFreeNode *node, uint64_t allocated_size) {
     *node = (SnFreeNode){.next = new_node, .size = SN_PTR_DIFF(new_node, node + 1)};
 }
 
+static void insert_free_node(SnFreeListAllocator *alloc, SnFreeNode *node) {
+    SnFreeNode *previous_freenode = get_previous_free_node(alloc->free_list, node);
+
+    if (!previous_freenode) {
+        node->next = alloc->free_list;
+        previous_freenode = alloc->free_list = node;
+        node = node->next;
+    } else {
+        node->next = previous_freenode->next;
+        previous_freenode->next = node;
+    }
+
+    try_merge(alloc, previous_freenode, node);
+}
+
+static int compare_pointers(const void *a, const void *b) {
+    uint64_t left = (uint64_t)*(void *const *)a;
+    uint64_t right = (uint64_t)*(void *const *)b;
+    return (left > right) - (left < right);
+}
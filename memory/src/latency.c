@@ -0,0 +1,139 @@
+#include "snmemory/latency.h"
+
+#include "src/atomics.h"
+
+#include <string.h>
+#include <time.h>
+
+#define SUB_BUCKET_COUNT (1U << SN_LATENCY_SUB_BUCKET_BITS)
+#define SUB_BUCKET_MASK (SUB_BUCKET_COUNT - 1)
+
+static uint32_t highest_bit(uint64_t value);
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+static uint64_t now_ns(void);
+#endif
+
+uint64_t sn_cycle_counter_frequency(void) {
+    static uint64_t frequency = 0;
+    if (frequency) return frequency;
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    // TSC rate is not architecturally exposed, measure it against the wall clock
+    uint64_t start_ns = now_ns(), start_ticks = sn_cycle_counter();
+    uint64_t elapsed_ns;
+    do {
+        elapsed_ns = now_ns() - start_ns;
+    } while (elapsed_ns < 10000000ULL);
+    uint64_t elapsed_ticks = sn_cycle_counter() - start_ticks;
+
+    frequency = (uint64_t)((double)elapsed_ticks * 1e9 / (double)elapsed_ns);
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    frequency = (uint64_t)_ReadStatusReg(ARM64_CNTFRQ_EL0);
+#elif defined(__aarch64__)
+    uint64_t value;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(value));
+    frequency = value;
+#else
+    frequency = 1000000000ULL;
+#endif
+
+    SN_ASSERT(frequency > 0);
+    return frequency;
+}
+
+void sn_latency_histogram_init(SnLatencyHistogram *histogram) {
+    if (!histogram) return;
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void sn_latency_histogram_record(SnLatencyHistogram *histogram, uint64_t ticks) {
+    if (!histogram) return;
+
+    sn_atomic_add_u64(&histogram->counts[sn_latency_bucket_index(ticks)], 1);
+    sn_atomic_add_u64(&histogram->count, 1);
+    sn_atomic_add_u64(&histogram->sum, ticks);
+
+    uint64_t max = sn_atomic_load_u64(&histogram->max);
+    while (ticks > max && !sn_atomic_cas_u64(&histogram->max, &max, ticks));
+}
+
+void sn_latency_histogram_snapshot(SnLatencyHistogram *histogram, SnLatencySnapshot *snapshot, bool reset) {
+    if (!histogram || !snapshot) return;
+
+    // Total count is rebuilt from the copied buckets so that a snapshot
+    // taken while recording is still self-consistent.
+    snapshot->count = 0;
+    for (uint32_t i = 0; i < SN_LATENCY_BUCKET_COUNT; ++i) {
+        snapshot->counts[i] = reset ? sn_atomic_exchange_u64(&histogram->counts[i], 0)
+                                    : sn_atomic_load_u64(&histogram->counts[i]);
+        snapshot->count += snapshot->counts[i];
+    }
+
+    if (reset) {
+        sn_atomic_exchange_u64(&histogram->count, 0);
+        snapshot->sum = sn_atomic_exchange_u64(&histogram->sum, 0);
+        snapshot->max = sn_atomic_exchange_u64(&histogram->max, 0);
+    } else {
+        snapshot->sum = sn_atomic_load_u64(&histogram->sum);
+        snapshot->max = sn_atomic_load_u64(&histogram->max);
+    }
+}
+
+uint32_t sn_latency_bucket_index(uint64_t ticks) {
+    if (ticks < SUB_BUCKET_COUNT) return (uint32_t)ticks;
+
+    uint32_t exponent = highest_bit(ticks);
+    uint32_t sub_bucket = (uint32_t)(ticks >> (exponent - SN_LATENCY_SUB_BUCKET_BITS)) & SUB_BUCKET_MASK;
+
+    return ((exponent - SN_LATENCY_SUB_BUCKET_BITS + 1) << SN_LATENCY_SUB_BUCKET_BITS) | sub_bucket;
+}
+
+uint64_t sn_latency_bucket_lower_bound(uint32_t index) {
+    if (index < SUB_BUCKET_COUNT) return index;
+
+    uint32_t exponent = (index >> SN_LATENCY_SUB_BUCKET_BITS) + SN_LATENCY_SUB_BUCKET_BITS - 1;
+    uint64_t sub_bucket = index & SUB_BUCKET_MASK;
+
+    return (SUB_BUCKET_COUNT | sub_bucket) << (exponent - SN_LATENCY_SUB_BUCKET_BITS);
+}
+
+uint64_t sn_latency_snapshot_percentile(SnLatencySnapshot *snapshot, double percentile) {
+    if (!snapshot || !snapshot->count) return 0;
+
+    percentile = SN_MIN(SN_MAX(percentile, 0.0), 100.0);
+    uint64_t target = (uint64_t)((double)snapshot->count * percentile / 100.0);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < SN_LATENCY_BUCKET_COUNT; ++i) {
+        seen += snapshot->counts[i];
+        if (seen < target) continue;
+
+        uint64_t upper = UINT64_MAX;
+        if (i + 1 < SN_LATENCY_BUCKET_COUNT) upper = sn_latency_bucket_lower_bound(i + 1) - 1;
+
+        // Never report more than what was actually seen
+        return snapshot->max ? SN_MIN(upper, snapshot->max) : upper;
+    }
+
+    return snapshot->max;
+}
+
+static uint32_t highest_bit(uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (uint32_t)index;
+#else
+    return 63 - (uint32_t)__builtin_clzll(value);
+#endif
+}
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
@@ -0,0 +1,76 @@
+#include "snmemory/linear.h"
+
+#include "snmemory/vm.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+// Spans this large would push the working set out of the caches and are
+// streamed to memory, or given back to the OS when VM-backed
+#define LARGE_SPAN (256 * 1024)
+
+static void zero_bytes(uint8_t *start, uint8_t *end);
+
+bool sn_linear_allocator_init_with_flags(SnLinearAllocator *alloc, void *mem, uint64_t size, uint32_t flags) {
+    if (!sn_linear_allocator_init(alloc, mem, size)) return false;
+
+    alloc->flags = flags;
+    if (flags & SN_LINEAR_ALLOCATOR_FLAG_ZEROED) alloc->dirty_end = alloc->mem;
+
+    if (flags & SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET) {
+        sn_linear_allocator_zero_range(alloc, alloc->mem, alloc->dirty_end);
+        alloc->dirty_end = alloc->mem;
+    }
+
+    return true;
+}
+
+void sn_linear_allocator_zero_range(SnLinearAllocator *alloc, uint8_t *start, uint8_t *end) {
+    if (!alloc || start >= end) return;
+
+    if (SN_PTR_DIFF(end, start) >= LARGE_SPAN && (alloc->flags & SN_LINEAR_ALLOCATOR_FLAG_VM_BACKED)) {
+        // Whole pages come back zero filled, only the partial pages at the ends are written
+        uint64_t page_size = sn_vm_get_page_size();
+        uint8_t *first = (uint8_t *)SN_GET_ALIGNED(start, page_size);
+        uint8_t *last = (uint8_t *)((uintptr_t)end & ~(page_size - 1));
+
+        if (first < last && sn_vm_zero_range(first, SN_PTR_DIFF(last, first))) {
+            zero_bytes(start, first);
+            zero_bytes(last, end);
+            return;
+        }
+    }
+
+    zero_bytes(start, end);
+}
+
+static void zero_bytes(uint8_t *start, uint8_t *end) {
+    uint64_t size = SN_PTR_DIFF(end, start);
+
+#if defined(__SSE2__) || defined(_M_X64)
+    if (size >= LARGE_SPAN) {
+        uint8_t *aligned = (uint8_t *)SN_GET_ALIGNED(start, 64);
+        memset(start, 0, SN_PTR_DIFF(aligned, start));
+
+        // Non-temporal stores write whole lines without reading them first
+        __m128i zero = _mm_setzero_si128();
+        uint8_t *ptr = aligned;
+        for (; ptr + 64 <= end; ptr += 64) {
+            _mm_stream_si128((__m128i *)ptr, zero);
+            _mm_stream_si128((__m128i *)(ptr + 16), zero);
+            _mm_stream_si128((__m128i *)(ptr + 32), zero);
+            _mm_stream_si128((__m128i *)(ptr + 48), zero);
+        }
+
+        // Streaming stores are weakly ordered, publish them before the memory is reused
+        _mm_sfence();
+        memset(ptr, 0, SN_PTR_DIFF(end, ptr));
+        return;
+    }
+#endif
+
+    memset(start, 0, size);
+}
@@ -0,0 +1,219 @@
+#include "snmemory/locked.h"
+
+#include "src/atomics.h"
+#include "src/cpu.h"
+#include "src/thread.h"
+
+// Polls of the ticket lock before giving the time slice away
+#define TICKET_YIELD_POLLS 16
+
+// Upper bound on one park, the waiter retries after it
+#define PARK_TIMEOUT_MS 100
+
+_Static_assert(sizeof(SnMutex) <= SN_LOCK_MUTEX_STORAGE, "SN_LOCK_MUTEX_STORAGE too small");
+_Static_assert(sizeof(SnCondition) <= SN_LOCK_CONDITION_STORAGE, "SN_LOCK_CONDITION_STORAGE too small");
+
+#define LOCK_MUTEX(lock) ((SnMutex *)(lock)->mutex)
+#define LOCK_CONDITION(lock) ((SnCondition *)(lock)->condition)
+
+static bool acquire_ticket(SnLock *lock);
+
+static bool acquire_adaptive(SnLock *lock);
+
+static uint64_t lock_allocator(SnLockedAllocator *alloc);
+
+static void unlock_allocator(SnLockedAllocator *alloc, uint64_t start);
+
+bool sn_lock_init(SnLock *lock, SnLockKind kind) {
+    if (!lock) return false;
+
+    *lock = (SnLock){.kind = kind};
+
+    switch (kind) {
+        case SN_LOCK_KIND_MUTEX:
+            return sn_mutex_init(LOCK_MUTEX(lock));
+        case SN_LOCK_KIND_TICKET:
+            return true;
+        case SN_LOCK_KIND_ADAPTIVE:
+            if (!sn_mutex_init(LOCK_MUTEX(lock))) return false;
+            if (!sn_condition_init(LOCK_CONDITION(lock))) {
+                sn_mutex_deinit(LOCK_MUTEX(lock));
+                return false;
+            }
+            return true;
+    }
+
+    return false;
+}
+
+void sn_lock_deinit(SnLock *lock) {
+    if (!lock) return;
+
+    switch (lock->kind) {
+        case SN_LOCK_KIND_MUTEX:
+            sn_mutex_deinit(LOCK_MUTEX(lock));
+            break;
+        case SN_LOCK_KIND_TICKET:
+            break;
+        case SN_LOCK_KIND_ADAPTIVE:
+            sn_condition_deinit(LOCK_CONDITION(lock));
+            sn_mutex_deinit(LOCK_MUTEX(lock));
+            break;
+    }
+
+    *lock = (SnLock){0};
+}
+
+bool sn_lock_acquire(SnLock *lock) {
+    switch (lock->kind) {
+        case SN_LOCK_KIND_MUTEX:
+            if (sn_mutex_try_lock(LOCK_MUTEX(lock))) return false;
+            sn_mutex_lock(LOCK_MUTEX(lock));
+            return true;
+        case SN_LOCK_KIND_TICKET:
+            return acquire_ticket(lock);
+        case SN_LOCK_KIND_ADAPTIVE:
+            return acquire_adaptive(lock);
+    }
+
+    return false;
+}
+
+void sn_lock_release(SnLock *lock) {
+    switch (lock->kind) {
+        case SN_LOCK_KIND_MUTEX:
+            sn_mutex_unlock(LOCK_MUTEX(lock));
+            break;
+        case SN_LOCK_KIND_TICKET:
+            // Only the holder writes now_serving
+            sn_atomic_store_u64(&lock->now_serving, lock->now_serving + 1);
+            break;
+        case SN_LOCK_KIND_ADAPTIVE:
+            if (sn_atomic_exchange_u64(&lock->state, 0) == 2) {
+                // Taking the mutex orders the wake up after a waiter
+                // started waiting, it can not be lost
+                sn_mutex_lock(LOCK_MUTEX(lock));
+                sn_condition_signal(LOCK_CONDITION(lock));
+                sn_mutex_unlock(LOCK_MUTEX(lock));
+            }
+            break;
+    }
+}
+
+bool sn_locked_allocator_init(
+    SnLockedAllocator *alloc, SnMemoryAllocator allocator, SnLockKind kind, bool instrument) {
+    if (!alloc || !allocator.alloc) return false;
+
+    *alloc = (SnLockedAllocator){.allocator = allocator, .instrument = instrument};
+    sn_latency_histogram_init(&alloc->hold_time);
+
+    return sn_lock_init(&alloc->lock, kind);
+}
+
+void sn_locked_allocator_deinit(SnLockedAllocator *alloc) {
+    if (!alloc) return;
+
+    sn_lock_deinit(&alloc->lock);
+    *alloc = (SnLockedAllocator){0};
+}
+
+void *sn_locked_allocator_allocate(SnLockedAllocator *alloc, uint64_t size, uint64_t align) {
+    if (!alloc) return NULL;
+
+    uint64_t start = lock_allocator(alloc);
+    void *ptr = alloc->allocator.alloc(alloc->allocator.data, size, align);
+    unlock_allocator(alloc, start);
+
+    return ptr;
+}
+
+void *sn_locked_allocator_reallocate(SnLockedAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align) {
+    if (!alloc || !alloc->allocator.realloc) return NULL;
+
+    uint64_t start = lock_allocator(alloc);
+    void *new_ptr = alloc->allocator.realloc(alloc->allocator.data, ptr, new_size, align);
+    unlock_allocator(alloc, start);
+
+    return new_ptr;
+}
+
+void sn_locked_allocator_free(SnLockedAllocator *alloc, void *ptr) {
+    if (!ptr || !alloc || !alloc->allocator.free) return;
+
+    uint64_t start = lock_allocator(alloc);
+    alloc->allocator.free(alloc->allocator.data, ptr);
+    unlock_allocator(alloc, start);
+}
+
+void sn_locked_allocator_get_stats(SnLockedAllocator *alloc, SnLockStats *stats, bool reset) {
+    if (!alloc || !stats) return;
+
+    if (reset) {
+        stats->acquire_count = sn_atomic_exchange_u64(&alloc->acquire_count, 0);
+        stats->contended_count = sn_atomic_exchange_u64(&alloc->contended_count, 0);
+    } else {
+        stats->acquire_count = sn_atomic_load_u64(&alloc->acquire_count);
+        stats->contended_count = sn_atomic_load_u64(&alloc->contended_count);
+    }
+
+    sn_latency_histogram_snapshot(&alloc->hold_time, &stats->hold_time, reset);
+}
+
+static bool acquire_ticket(SnLock *lock) {
+    uint64_t ticket = sn_atomic_add_u64(&lock->next_ticket, 1);
+    uint64_t serving = sn_atomic_load_u64(&lock->now_serving);
+    if (serving == ticket) return false;
+
+    // Back off in proportion to the number of threads ahead, each of
+    // them holds the lock for a while before it is our turn
+    uint64_t polls = 0;
+    while (serving != ticket) {
+        // The holder (or a thread ahead) may be preempted, past a few
+        // polls stop burning the time slice it needs
+        if (++polls > TICKET_YIELD_POLLS) sn_thread_yield();
+        else
+            for (uint64_t i = 0; i < (ticket - serving) * SN_LOCK_TICKET_BACKOFF; ++i) sn_cpu_relax();
+
+        serving = sn_atomic_load_u64(&lock->now_serving);
+    }
+
+    return true;
+}
+
+static bool acquire_adaptive(SnLock *lock) {
+    uint64_t expected = 0;
+    if (sn_atomic_cas_u64(&lock->state, &expected, 1)) return false;
+
+    for (uint32_t i = 0; i < SN_LOCK_SPIN_COUNT; ++i) {
+        sn_cpu_relax();
+
+        // Read before the CAS so spinning does not steal the cache line
+        expected = 0;
+        if (!sn_atomic_load_u64(&lock->state) && sn_atomic_cas_u64(&lock->state, &expected, 1)) return true;
+    }
+
+    // Park. The state stays 2 while anyone may be parked, so the holder
+    // knows to wake one up. Taking the lock with 2 is conservative, it
+    // costs at most one spurious wake up.
+    sn_mutex_lock(LOCK_MUTEX(lock));
+    while (sn_atomic_exchange_u64(&lock->state, 2) != 0)
+        sn_condition_wait(LOCK_CONDITION(lock), LOCK_MUTEX(lock), PARK_TIMEOUT_MS);
+    sn_mutex_unlock(LOCK_MUTEX(lock));
+
+    return true;
+}
+
+static uint64_t lock_allocator(SnLockedAllocator *alloc) {
+    bool contended = sn_lock_acquire(&alloc->lock);
+    if (!alloc->instrument) return 0;
+
+    sn_atomic_add_u64(&alloc->acquire_count, 1);
+    if (contended) sn_atomic_add_u64(&alloc->contended_count, 1);
+
+    return sn_cycle_counter();
+}
+
+static void unlock_allocator(SnLockedAllocator *alloc, uint64_t start) {
+    if (alloc->instrument) sn_latency_histogram_record(&alloc->hold_time, sn_cycle_counter() - start);
+    sn_lock_release(&alloc->lock);
+}
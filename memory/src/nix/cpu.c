@@ -0,0 +1,85 @@
+// sched_getcpu is a GNU extension
+#if !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
+#endif
+
+#include "src/cpu.h"
+#include "src/rseq.h"
+
+#if defined(SN_OS_LINUX) || defined(SN_OS_MAC)
+
+    #include <unistd.h>
+
+    #if defined(SN_OS_MAC)
+        #include <sys/sysctl.h>
+    #endif
+
+    #if defined(SN_OS_LINUX)
+        #include <sched.h>
+    #endif
+
+    #if defined(SN_HAS_RSEQ_CS)
+        #include <sys/syscall.h>
+
+        // membarrier commands from Linux 5.10, older headers do not have them
+        #define MEMBARRIER_RSEQ (1 << 7)
+        #define MEMBARRIER_REGISTER_RSEQ (1 << 8)
+    #endif
+
+uint32_t sn_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_CONF);
+    return count > 0 ? (uint32_t)count : 1;
+}
+
+uint64_t sn_cpu_cache_line_size(void) {
+    #if defined(_SC_LEVEL1_DCACHE_LINESIZE)
+    // 0 on some virtual machines and architectures
+    long size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (size > 0) return (uint64_t)size;
+    #endif
+
+    #if defined(SN_OS_MAC)
+    uint64_t line_size = 0;
+    size_t length = sizeof(line_size);
+    if (sysctlbyname("hw.cachelinesize", &line_size, &length, NULL, 0) == 0 && line_size) return line_size;
+    #endif
+
+    return SN_CPU_DEFAULT_CACHE_LINE_SIZE;
+}
+
+uint32_t sn_cpu_current(void) {
+    #if defined(SN_HAS_RSEQ)
+    // glibc registers rseq for every thread, the kernel keeps cpu_id current
+    // on every return to user space, so reading it is a plain load.
+    struct rseq *area = sn_rseq_area();
+    if (area) {
+        int32_t cpu = sn_rseq_cpu(area);
+        if (cpu >= 0) return (uint32_t)cpu;
+    }
+    #endif
+
+    #if defined(SN_OS_LINUX)
+    int cpu = sched_getcpu();
+    if (cpu >= 0) return (uint32_t)cpu;
+    #endif
+
+    // No CPU id, give each thread its own index instead
+    static uint32_t next_index = 0;
+    static _Thread_local uint32_t thread_index = UINT32_MAX;
+    if (thread_index == UINT32_MAX) thread_index = __atomic_fetch_add(&next_index, 1, __ATOMIC_RELAXED);
+
+    return thread_index;
+}
+
+    #if defined(SN_HAS_RSEQ_CS)
+bool sn_rseq_fence_register(void) {
+    // Registration is per process and can be repeated
+    return syscall(SYS_membarrier, MEMBARRIER_REGISTER_RSEQ, 0, 0) == 0;
+}
+
+void sn_rseq_fence(void) {
+    syscall(SYS_membarrier, MEMBARRIER_RSEQ, 0, 0);
+}
+    #endif
+
+#endif
@@ -0,0 +1,108 @@
+#include "snmemory/mapped.h"
+
+#if defined(SN_OS_LINUX) || defined(SN_OS_MAC)
+
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+    #include "snmemory/vm.h"
+
+static bool get_page_range(SnMappedFile *file, void **ptr, uint64_t *size);
+
+bool sn_mapped_file_open(SnMappedFile *file, const char *path, uint64_t size, uint32_t flags, void *address) {
+    if (!file || !path) return false;
+
+    bool read_only = flags & SN_MAPPED_FILE_FLAG_READ_ONLY;
+    int open_flags = read_only ? O_RDONLY : O_RDWR;
+    if (flags & SN_MAPPED_FILE_FLAG_CREATE) open_flags |= O_CREAT;
+
+    int fd = open(path, open_flags | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) goto fail;
+
+    if (!size) size = (uint64_t)st.st_size;
+    if (!size) goto fail;
+
+    if ((uint64_t)st.st_size < size) {
+        // Extending leaves a sparse zero filled tail, no disk blocks yet
+        if (read_only || ftruncate(fd, (off_t)size) != 0) goto fail;
+    }
+
+    int prot = read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+    int map_flags = (flags & SN_MAPPED_FILE_FLAG_PRIVATE) ? MAP_PRIVATE : MAP_SHARED;
+
+    void *base = mmap(address, size, prot, map_flags, fd, 0);
+    if (base == MAP_FAILED) goto fail;
+
+    *file = (SnMappedFile){
+        .base = base,
+        .size = size,
+        .file = fd,
+        .flags = flags,
+    };
+
+    return true;
+
+fail:
+    close(fd);
+    return false;
+}
+
+void sn_mapped_file_close(SnMappedFile *file) {
+    if (!file || !file->base) return;
+
+    munmap(file->base, file->size);
+    close((int)file->file);
+
+    *file = (SnMappedFile){0};
+}
+
+bool sn_mapped_file_sync(SnMappedFile *file, void *ptr, uint64_t size, bool wait) {
+    if (!get_page_range(file, &ptr, &size)) return false;
+    return msync(ptr, size, wait ? MS_SYNC : MS_ASYNC) == 0;
+}
+
+bool sn_mapped_file_advise(SnMappedFile *file, void *ptr, uint64_t size, SnMappedFileAdvice advice) {
+    if (!get_page_range(file, &ptr, &size)) return false;
+
+    int hint;
+    switch (advice) {
+        case SN_MAPPED_FILE_ADVICE_SEQUENTIAL:
+            hint = MADV_SEQUENTIAL;
+            break;
+        case SN_MAPPED_FILE_ADVICE_RANDOM:
+            hint = MADV_RANDOM;
+            break;
+        case SN_MAPPED_FILE_ADVICE_WILLNEED:
+            hint = MADV_WILLNEED;
+            break;
+        case SN_MAPPED_FILE_ADVICE_DONTNEED:
+            // Shared pages are read back from the file, private ones are lost
+            hint = MADV_DONTNEED;
+            break;
+        case SN_MAPPED_FILE_ADVICE_NORMAL:
+        default:
+            hint = MADV_NORMAL;
+            break;
+    }
+
+    return madvise(ptr, size, hint) == 0;
+}
+
+static bool get_page_range(SnMappedFile *file, void **ptr, uint64_t *size) {
+    if (!file || !file->base || !sn_mapped_file_owns(file, *ptr)) return false;
+
+    // msync and madvise want a page aligned start
+    uint8_t *start = (uint8_t *)((uintptr_t)*ptr & ~(sn_vm_get_page_size() - 1));
+    uint8_t *end = SN_MIN(((uint8_t *)*ptr) + *size, ((uint8_t *)file->base) + file->size);
+
+    *ptr = start;
+    *size = SN_PTR_DIFF(end, start);
+    return true;
+}
+
+#endif
@@ -0,0 +1,82 @@
+// syscall is a GNU extension
+#if !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
+#endif
+
+#include "src/shm_internal.h"
+
+#if defined(SN_OS_LINUX) || defined(SN_OS_MAC)
+
+    #include <fcntl.h>
+    #include <limits.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <time.h>
+    #include <unistd.h>
+
+    #if defined(SN_OS_LINUX)
+        #include <linux/futex.h>
+        #include <sys/syscall.h>
+    #endif
+
+void *sn_shm_map(const char *name, uint64_t *size, bool create, intptr_t *handle) {
+    int fd = shm_open(name, create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0600);
+    if (fd < 0) return NULL;
+
+    if (create) {
+        // New shared memory is zero filled
+        if (ftruncate(fd, (off_t)*size) != 0) goto fail;
+    } else {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) goto fail;
+        *size = (uint64_t)st.st_size;
+    }
+
+    void *ptr = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) goto fail;
+
+    *handle = fd;
+    return ptr;
+
+fail:
+    close(fd);
+    if (create) shm_unlink(name);
+    return NULL;
+}
+
+void sn_shm_unmap(void *ptr, uint64_t size, intptr_t handle) {
+    munmap(ptr, size);
+    close((int)handle);
+}
+
+void sn_shm_unlink(const char *name) {
+    shm_unlink(name);
+}
+
+void sn_shm_wait(volatile uint32_t *word, uint32_t value, uint32_t timeout_ms) {
+    #if defined(SN_OS_LINUX)
+    struct timespec timeout = {
+        .tv_sec = (time_t)(timeout_ms / 1000),
+        .tv_nsec = (long)(timeout_ms % 1000) * 1000000L,
+    };
+
+    // Not FUTEX_PRIVATE_FLAG, the other side may be another process
+    syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT, value, timeout_ms == UINT32_MAX ? NULL : &timeout, NULL, 0);
+    #else
+    // No cross-process futex, poll in short sleeps
+    if (*word != value || !timeout_ms) return;
+
+    struct timespec nap = {.tv_sec = 0, .tv_nsec = 100000L};
+    nanosleep(&nap, NULL);
+    #endif
+}
+
+void sn_shm_wake(volatile uint32_t *word) {
+    #if defined(SN_OS_LINUX)
+    syscall(SYS_futex, (uint32_t *)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    #else
+    (void)word;
+    #endif
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include "src/thread.h"
+
+#if defined(SN_OS_LINUX) || defined(SN_OS_MAC)
+
+    #include <sched.h>
+    #include <time.h>
+
+bool sn_mutex_init(SnMutex *mutex) {
+    return pthread_mutex_init(mutex, NULL) == 0;
+}
+
+void sn_mutex_deinit(SnMutex *mutex) {
+    pthread_mutex_destroy(mutex);
+}
+
+void sn_mutex_lock(SnMutex *mutex) {
+    pthread_mutex_lock(mutex);
+}
+
+bool sn_mutex_try_lock(SnMutex *mutex) {
+    return pthread_mutex_trylock(mutex) == 0;
+}
+
+void sn_mutex_unlock(SnMutex *mutex) {
+    pthread_mutex_unlock(mutex);
+}
+
+bool sn_condition_init(SnCondition *condition) {
+    return pthread_cond_init(condition, NULL) == 0;
+}
+
+void sn_condition_deinit(SnCondition *condition) {
+    pthread_cond_destroy(condition);
+}
+
+void sn_condition_signal(SnCondition *condition) {
+    pthread_cond_signal(condition);
+}
+
+void sn_condition_broadcast(SnCondition *condition) {
+    pthread_cond_broadcast(condition);
+}
+
+void sn_condition_wait(SnCondition *condition, SnMutex *mutex, uint32_t timeout_ms) {
+    // pthread condition variables wait on the realtime clock by default
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+
+    uint64_t ns = (uint64_t)now.tv_nsec + (uint64_t)timeout_ms * 1000000ULL;
+    struct timespec deadline = {
+        .tv_sec = now.tv_sec + (time_t)(ns / 1000000000ULL),
+        .tv_nsec = (long)(ns % 1000000000ULL),
+    };
+
+    pthread_cond_timedwait(condition, mutex, &deadline);
+}
+
+static void *thread_entry(void *arg) {
+    SnThread *thread = (SnThread *)arg;
+    thread->fn(thread->arg);
+    return NULL;
+}
+
+bool sn_thread_create(SnThread *thread, SnThreadFn fn, void *arg) {
+    thread->fn = fn;
+    thread->arg = arg;
+    return pthread_create(&thread->handle, NULL, thread_entry, thread) == 0;
+}
+
+void sn_thread_join(SnThread *thread) {
+    pthread_join(thread->handle, NULL);
+}
+
+void sn_thread_yield(void) {
+    sched_yield();
+}
+
+uint64_t sn_thread_current_id(void) {
+    return (uint64_t)(uintptr_t)pthread_self();
+}
+
+#endif
@@ -1,27 +1,156 @@
+// mremap is a GNU extension
+#if !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
+#endif
+
 #include "snmemory/vm.h"
 
 #if defined(SN_OS_LINUX) || defined(SN_OS_MAC)
 
+    #include <stdio.h>
+    #include <string.h>
     #include <sys/mman.h>
     #include <unistd.h>
 
-void *sn_vm_reserve(void *address, uint32_t pages) {
-    void *ptr = mmap(address, pages * sn_vm_get_page_size(), PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
-    if (ptr == MAP_FAILED) return NULL;
+    #include "src/vm_internal.h"
 
-    return ptr;
+static void *reserve_aligned(void *address, uint64_t size, uint64_t align);
+
+void *sn_vm_reserve(void *address, uint32_t pages) {
+    return sn_vm_reserve_range(address, (uint64_t)pages * sn_vm_get_page_size());
 }
 
 bool sn_vm_commit(void *ptr, uint32_t pages) {
-    return mprotect(ptr, pages * sn_vm_get_page_size(), PROT_READ | PROT_WRITE) == 0;
+    return sn_vm_commit_range(ptr, (uint64_t)pages * sn_vm_get_page_size(), SN_VM_FLAG_NONE);
 }
 
 bool sn_vm_decommit(void *ptr, uint32_t pages) {
-    return mprotect(ptr, pages * sn_vm_get_page_size(), PROT_NONE) == 0;
+    return sn_vm_decommit_range(ptr, (uint64_t)pages * sn_vm_get_page_size());
+}
+
+bool sn_vm_discard(void *ptr, uint32_t pages) {
+    uint64_t size = (uint64_t)pages * sn_vm_get_page_size();
+
+    #if defined(MADV_FREE)
+    if (madvise(ptr, size, MADV_FREE) == 0) return true;
+    #endif
+
+    // MADV_FREE is Linux 4.5+, older kernels drop the pages right away
+    return madvise(ptr, size, MADV_DONTNEED) == 0;
 }
 
 bool sn_vm_release(void *ptr, uint32_t pages) {
-    return munmap(ptr, pages * sn_vm_get_page_size()) == 0;
+    return sn_vm_release_range(ptr, (uint64_t)pages * sn_vm_get_page_size());
+}
+
+void *sn_vm_reserve_range(void *address, uint64_t size) {
+    size = SN_GET_ALIGNED(size, sn_vm_get_page_size());
+    if (!size) return NULL;
+
+    void *ptr = mmap(address, size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ptr == MAP_FAILED) return NULL;
+
+    return ptr;
+}
+
+bool sn_vm_commit_range(void *ptr, uint64_t size, uint32_t flags) {
+    size = SN_GET_ALIGNED(size, sn_vm_get_page_size());
+
+    sn_vm_lazy_decommit_resolve(ptr, size);
+    if (mprotect(ptr, size, PROT_READ | PROT_WRITE) != 0) return false;
+
+    if (flags & SN_VM_FLAG_PREFAULT) return sn_vm_prefault(ptr, size);
+
+    return true;
+}
+
+bool sn_vm_decommit_range(void *ptr, uint64_t size) {
+    size = SN_GET_ALIGNED(size, sn_vm_get_page_size());
+
+    // mprotect alone keeps the pages resident, give them back first
+    #if defined(SN_OS_MAC) && defined(MADV_FREE_REUSABLE)
+    madvise(ptr, size, MADV_FREE_REUSABLE);
+    #else
+    madvise(ptr, size, MADV_DONTNEED);
+    #endif
+
+    return mprotect(ptr, size, PROT_NONE) == 0;
+}
+
+bool sn_vm_release_range(void *ptr, uint64_t size) {
+    size = SN_GET_ALIGNED(size, sn_vm_get_page_size());
+
+    sn_vm_lazy_decommit_resolve(ptr, size);
+    return munmap(ptr, size) == 0;
+}
+
+void *sn_vm_resize(void *ptr, uint64_t old_size, uint64_t new_size) {
+    uint64_t page_size = sn_vm_get_page_size();
+    old_size = SN_GET_ALIGNED(old_size, page_size);
+    new_size = SN_GET_ALIGNED(new_size, page_size);
+    if (!ptr || !old_size || !new_size) return NULL;
+
+    if (new_size == old_size) return ptr;
+
+    // Queued decommits must not hit pages that move or go away
+    sn_vm_lazy_decommit_resolve(ptr, old_size);
+
+    if (new_size < old_size) return munmap(((uint8_t *)ptr) + new_size, old_size - new_size) == 0 ? ptr : NULL;
+
+    #if defined(SN_OS_LINUX) && defined(MREMAP_MAYMOVE)
+    // Moves page table entries, page contents are never copied
+    void *moved = mremap(ptr, old_size, new_size, MREMAP_MAYMOVE);
+    if (moved != MAP_FAILED) return moved;
+    #endif
+
+    // Grow in place when the address space right after the range is free
+    uint8_t *tail = ((uint8_t *)ptr) + old_size;
+    uint64_t grow_size = new_size - old_size;
+    void *extra = mmap(tail, grow_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (extra == tail) return ptr;
+    if (extra != MAP_FAILED) munmap(extra, grow_size);
+
+    void *new_ptr = sn_vm_reserve_range(NULL, new_size);
+    if (!new_ptr) return NULL;
+
+    if (!sn_vm_commit_range(new_ptr, new_size, SN_VM_FLAG_NONE)) {
+        sn_vm_release_range(new_ptr, new_size);
+        return NULL;
+    }
+
+    memcpy(new_ptr, ptr, old_size);
+    sn_vm_release_range(ptr, old_size);
+
+    return new_ptr;
+}
+
+bool sn_vm_prefault(void *ptr, uint64_t size) {
+    if (!ptr || !size) return false;
+
+    #if defined(MADV_POPULATE_WRITE)
+    // Linux 5.14+, faults everything in with a single call
+    if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0) return true;
+    #endif
+
+    uint64_t page_size = sn_vm_get_page_size();
+    volatile uint8_t *bytes = (volatile uint8_t *)ptr;
+    for (uint64_t offset = 0; offset < size; offset += page_size) bytes[offset] = bytes[offset];
+
+    return true;
+}
+
+bool sn_vm_zero_range(void *ptr, uint64_t size) {
+    if (!ptr || !size) return false;
+    size = SN_GET_ALIGNED(size, sn_vm_get_page_size());
+
+    #if defined(SN_OS_LINUX)
+    // Private anonymous pages are zero filled on the next fault
+    return madvise(ptr, size, MADV_DONTNEED) == 0;
+    #else
+    // MADV_DONTNEED may keep the contents, map fresh pages over the range instead
+    int map_flags = MAP_FIXED | MAP_ANONYMOUS | MAP_PRIVATE;
+    return mmap(ptr, size, PROT_READ | PROT_WRITE, map_flags, -1, 0) != MAP_FAILED;
+    #endif
 }
 
 uint64_t sn_vm_get_page_size(void) {
@@ -35,4 +164,77 @@ uint64_t sn_vm_get_page_size(void) {
     return page_size;
 }
 
+uint64_t sn_vm_get_large_page_size(void) {
+    static uint64_t large_page_size = 0;
+    if (large_page_size) return large_page_size;
+
+    large_page_size = SN_VM_DEFAULT_LARGE_PAGE_SIZE;
+
+    #if defined(SN_OS_LINUX)
+    FILE *meminfo = fopen("/proc/meminfo", "r");
+    if (meminfo) {
+        char line[128];
+        unsigned long long kb;
+        while (fgets(line, sizeof(line), meminfo)) {
+            if (sscanf(line, "Hugepagesize: %llu kB", &kb) == 1 && kb) {
+                large_page_size = kb * 1024ULL;
+                break;
+            }
+        }
+        fclose(meminfo);
+    }
+    #endif
+
+    return large_page_size;
+}
+
+void *sn_vm_reserve_large(void *address, uint32_t pages) {
+    uint64_t size = (uint64_t)pages * sn_vm_get_large_page_size();
+    if (!size) return NULL;
+
+    #if defined(MAP_HUGETLB)
+    // Explicit huge pages, fails unless the admin set up a huge page pool
+    void *ptr = mmap(address, size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) return ptr;
+    #endif
+
+    void *aligned = reserve_aligned(address, size, sn_vm_get_large_page_size());
+    if (!aligned) return NULL;
+
+    #if defined(MADV_HUGEPAGE)
+    // Transparent huge pages, best effort
+    madvise(aligned, size, MADV_HUGEPAGE);
+    #endif
+
+    return aligned;
+}
+
+bool sn_vm_commit_large(void *ptr, uint32_t pages) {
+    return sn_vm_commit_range(ptr, (uint64_t)pages * sn_vm_get_large_page_size(), SN_VM_FLAG_NONE);
+}
+
+bool sn_vm_decommit_large(void *ptr, uint32_t pages) {
+    return sn_vm_decommit_range(ptr, (uint64_t)pages * sn_vm_get_large_page_size());
+}
+
+bool sn_vm_release_large(void *ptr, uint32_t pages) {
+    return sn_vm_release_range(ptr, (uint64_t)pages * sn_vm_get_large_page_size());
+}
+
+static void *reserve_aligned(void *address, uint64_t size, uint64_t align) {
+    // Over reserve and trim both ends so that the region starts aligned
+    uint8_t *ptr = mmap(address, size + align, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ptr == MAP_FAILED) return NULL;
+
+    uint8_t *aligned = (uint8_t *)SN_GET_ALIGNED(ptr, align);
+
+    uint64_t head = SN_PTR_DIFF(aligned, ptr);
+    uint64_t tail = align - head;
+
+    if (head) munmap(ptr, head);
+    if (tail) munmap(aligned + size, tail);
+
+    return aligned;
+}
+
 #endif
@@ -0,0 +1,83 @@
+#include "snmemory/owned.h"
+
+#include "src/atomics.h"
+#include "src/thread.h"
+
+// Remotely freed blocks are linked through their first word
+typedef struct SnRemoteBlock {
+    struct SnRemoteBlock *next;
+} SnRemoteBlock;
+
+bool sn_owned_heap_init(SnOwnedHeap *heap, SnMemoryAdapter backend) {
+    if (!heap || !backend.allocator.alloc || !backend.allocator.free) return false;
+
+    *heap = (SnOwnedHeap){
+        .backend = backend,
+        .owner = sn_thread_current_id(),
+    };
+
+    return true;
+}
+
+void sn_owned_heap_deinit(SnOwnedHeap *heap) {
+    if (!heap) return;
+
+    sn_owned_heap_drain(heap);
+    *heap = (SnOwnedHeap){0};
+}
+
+void sn_owned_heap_set_owner(SnOwnedHeap *heap) {
+    if (!heap) return;
+    heap->owner = sn_thread_current_id();
+}
+
+bool sn_owned_heap_is_owner(SnOwnedHeap *heap) {
+    if (!heap) return false;
+    return heap->owner == sn_thread_current_id();
+}
+
+void *sn_owned_heap_allocate(SnOwnedHeap *heap, uint64_t size, uint64_t align) {
+    if (!size || !align || !heap) return NULL;
+    SN_ASSERT(sn_owned_heap_is_owner(heap));
+
+    if (sn_atomic_load_relaxed_u64(&heap->remote_head)) sn_owned_heap_drain(heap);
+
+    // Every block must be able to hold the remote-free link
+    size = SN_MAX(size, sizeof(SnRemoteBlock));
+    align = SN_MAX(align, alignof(SnRemoteBlock));
+
+    return sn_memory_adapter_allocate(&heap->backend, size, align);
+}
+
+void sn_owned_heap_free(SnOwnedHeap *heap, void *ptr) {
+    if (!ptr || !heap) return;
+
+    if (heap->owner == sn_thread_current_id()) {
+        sn_memory_adapter_free(&heap->backend, ptr);
+        return;
+    }
+
+    // Multi-producer push, the owner detaches the whole list at once so
+    // a popped node is never pushed back while another thread reads it
+    SnRemoteBlock *block = (SnRemoteBlock *)ptr;
+    uint64_t head = sn_atomic_load_relaxed_u64(&heap->remote_head);
+    do {
+        block->next = (SnRemoteBlock *)head;
+    } while (!sn_atomic_cas_u64(&heap->remote_head, &head, (uint64_t)block));
+}
+
+uint64_t sn_owned_heap_drain(SnOwnedHeap *heap) {
+    if (!heap) return 0;
+
+    SnRemoteBlock *block = (SnRemoteBlock *)sn_atomic_exchange_u64(&heap->remote_head, 0);
+
+    uint64_t count = 0;
+    while (block) {
+        SnRemoteBlock *next = block->next;
+        sn_memory_adapter_free(&heap->backend, block);
+        block = next;
+        count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,81 @@
+#include "snmemory/packed.h"
+
+#include <string.h>
+
+bool sn_packed_pool_init(
+    SnPackedPool *pool, void *mem, uint64_t size, uint64_t item_size, uint64_t item_align) {
+    if (!pool || !mem || !item_size || !item_align) return false;
+
+    item_size = SN_GET_ALIGNED(item_size, item_align);
+
+    // Items first so that the array starts at the requested alignment
+    uint8_t *items = (uint8_t *)SN_GET_ALIGNED(mem, item_align);
+    if (items > ((uint8_t *)mem) + size) return false;
+    uint64_t available = size - SN_PTR_DIFF(items, mem);
+
+    // Leave room to align the two index arrays after the items
+    uint64_t padding = alignof(uint32_t) + alignof(SnPackedSlot);
+    if (available < padding) return false;
+
+    uint64_t capacity = (available - padding) / (item_size + sizeof(uint32_t) + sizeof(SnPackedSlot));
+    capacity = SN_MIN(capacity, (uint64_t)SN_HANDLE_NO_INDEX - 1);
+    if (!capacity) return false;
+
+    uint32_t *dense_slots = SN_GET_ALIGNED_PTR(items + capacity * item_size, uint32_t);
+
+    *pool = (SnPackedPool){
+        .items = items,
+        .dense_slots = dense_slots,
+        .slots = SN_GET_ALIGNED_PTR(dense_slots + capacity, SnPackedSlot),
+        .item_size = item_size,
+        .capacity = (uint32_t)capacity,
+        .free_slot = SN_HANDLE_NO_INDEX,
+    };
+
+    return true;
+}
+
+SnHandle sn_packed_pool_allocate(SnPackedPool *pool, void **out_item) {
+    if (!pool || pool->count == pool->capacity) return SN_HANDLE_INVALID;
+
+    uint32_t slot = pool->free_slot;
+    if (slot != SN_HANDLE_NO_INDEX) {
+        pool->free_slot = pool->slots[slot].dense;
+    } else {
+        // Live items never outnumber the slots, so this can not run out
+        slot = pool->high_water++;
+        pool->slots[slot].generation = 0;
+    }
+
+    uint32_t index = pool->count++;
+    pool->slots[slot].dense = index;
+    pool->slots[slot].generation++;
+    pool->dense_slots[index] = slot;
+
+    if (out_item) *out_item = sn_packed_pool_get_item(pool, index);
+
+    return (SnHandle)pool->slots[slot].generation << 32 | slot;
+}
+
+bool sn_packed_pool_free(SnPackedPool *pool, SnHandle handle) {
+    if (!pool || !sn_packed_pool_resolve(pool, handle)) return false;
+
+    uint32_t slot = (uint32_t)handle;
+    uint32_t index = pool->slots[slot].dense;
+    uint32_t last = --pool->count;
+
+    // Fill the hole with the last item and repoint its slot
+    if (index != last) {
+        memcpy(sn_packed_pool_get_item(pool, index), sn_packed_pool_get_item(pool, last), pool->item_size);
+
+        uint32_t moved_slot = pool->dense_slots[last];
+        pool->dense_slots[index] = moved_slot;
+        pool->slots[moved_slot].dense = index;
+    }
+
+    pool->slots[slot].generation++;
+    pool->slots[slot].dense = pool->free_slot;
+    pool->free_slot = slot;
+
+    return true;
+}
@@ -0,0 +1,334 @@
+#include "snmemory/percpu.h"
+
+#include "src/atomics.h"
+#include "src/cpu.h"
+#include "src/rseq.h"
+#include "src/thread.h"
+
+// Blocks moved between a slot and the backend at once
+#define TRANSFER_COUNT (SN_PERCPU_CACHE_CAPACITY / 2)
+
+#define SLAB_OF(ptr) ((SnSlab *)(((uint64_t)(ptr)) & ~((uint64_t)SN_SLAB_SIZE - 1)))
+
+static SnPercpuSlot *acquire_slot(SnPercpuCache *cache);
+
+static void release_slot(SnPercpuSlot *slot);
+
+static void lock_backend(SnPercpuCache *cache);
+
+static void unlock_backend(SnPercpuCache *cache);
+
+#if defined(SN_HAS_RSEQ_CS)
+static void free_blocks(SnPercpuCache *cache, void **blocks, uint32_t count);
+
+static void *restartable_allocate(SnPercpuCache *cache);
+
+static void restartable_free(SnPercpuCache *cache, void *ptr);
+
+static bool restartable_pop(SnPercpuCache *cache, void **ptr);
+
+static bool restartable_push(SnPercpuCache *cache, void *ptr);
+#endif
+
+uint32_t sn_percpu_get_cpu_count(void) {
+    static uint32_t count = 0;
+    if (!count) count = sn_cpu_count();
+    return count;
+}
+
+bool sn_percpu_cache_init(
+    SnPercpuCache *cache, SnMemoryAdapter backend, uint64_t block_size, uint64_t block_align, void *mem, uint64_t size) {
+    if (!cache || !backend.allocator.alloc || !backend.allocator.free || !block_size || !block_align || !mem)
+        return false;
+
+    SnPercpuSlot *slots = SN_GET_ALIGNED_PTR(mem, SnPercpuSlot);
+    uint64_t available = SN_PTR_DIFF(((uint8_t *)mem) + size, slots);
+    if ((uint8_t *)slots > ((uint8_t *)mem) + size || available < sizeof(SnPercpuSlot)) return false;
+
+    uint32_t slot_count = (uint32_t)SN_MIN(available / sizeof(SnPercpuSlot), sn_percpu_get_cpu_count());
+
+    *cache = (SnPercpuCache){
+        .backend = backend,
+        .block_size = block_size,
+        .block_align = block_align,
+        .slots = slots,
+        .slot_count = slot_count,
+    };
+    cache->backend_lock = &cache->lock;
+
+    for (uint32_t i = 0; i < slot_count; ++i) slots[i] = (SnPercpuSlot){0};
+
+#if defined(SN_HAS_RSEQ_CS)
+    // A slot shared by two CPUs would need the lock again
+    cache->restartable =
+        slot_count == sn_percpu_get_cpu_count() && sn_rseq_area() && sn_rseq_fence_register();
+#endif
+
+    return true;
+}
+
+void sn_percpu_cache_deinit(SnPercpuCache *cache) {
+    if (!cache) return;
+
+    sn_percpu_cache_flush(cache);
+    *cache = (SnPercpuCache){0};
+}
+
+void *sn_percpu_cache_allocate(SnPercpuCache *cache) {
+    if (!cache) return NULL;
+
+#if defined(SN_HAS_RSEQ_CS)
+    if (cache->restartable) return restartable_allocate(cache);
+#endif
+
+    SnPercpuSlot *slot = acquire_slot(cache);
+    void *ptr = NULL;
+
+    if (slot && slot->count) {
+        ptr = slot->blocks[--slot->count];
+        release_slot(slot);
+        return ptr;
+    }
+
+    // Refill the slot, or serve straight from the backend without one
+    lock_backend(cache);
+
+    ptr = sn_memory_adapter_allocate(&cache->backend, cache->block_size, cache->block_align);
+    if (ptr && slot) {
+        while (slot->count < TRANSFER_COUNT) {
+            void *block = sn_memory_adapter_allocate(&cache->backend, cache->block_size, cache->block_align);
+            if (!block) break;
+            slot->blocks[slot->count++] = block;
+        }
+    }
+
+    unlock_backend(cache);
+
+    if (slot) release_slot(slot);
+
+    return ptr;
+}
+
+void sn_percpu_cache_free(SnPercpuCache *cache, void *ptr) {
+    if (!ptr || !cache) return;
+
+#if defined(SN_HAS_RSEQ_CS)
+    if (cache->restartable) {
+        restartable_free(cache, ptr);
+        return;
+    }
+#endif
+
+    SnPercpuSlot *slot = acquire_slot(cache);
+
+    if (slot && slot->count < SN_PERCPU_CACHE_CAPACITY) {
+        slot->blocks[slot->count++] = ptr;
+        release_slot(slot);
+        return;
+    }
+
+    // Spill half of the slot, or free straight to the backend without one
+    lock_backend(cache);
+
+    sn_memory_adapter_free_sized(&cache->backend, ptr, cache->block_size, cache->block_align);
+    if (slot) {
+        while (slot->count > SN_PERCPU_CACHE_CAPACITY - TRANSFER_COUNT) {
+            void *block = slot->blocks[--slot->count];
+            sn_memory_adapter_free_sized(&cache->backend, block, cache->block_size, cache->block_align);
+        }
+    }
+
+    unlock_backend(cache);
+
+    if (slot) release_slot(slot);
+}
+
+void sn_percpu_cache_flush(SnPercpuCache *cache) {
+    if (!cache) return;
+
+    for (uint32_t i = 0; i < cache->slot_count; ++i) {
+        SnPercpuSlot *slot = &cache->slots[i];
+
+        uint64_t expected = 0;
+        while (!sn_atomic_cas_u64(&slot->lock, &expected, 1)) {
+            expected = 0;
+            sn_thread_yield();
+        }
+    }
+
+#if defined(SN_HAS_RSEQ_CS)
+    // Sequences that saw a slot unlocked may still be running, restart them
+    if (cache->restartable) sn_rseq_fence();
+#endif
+
+    lock_backend(cache);
+    for (uint32_t i = 0; i < cache->slot_count; ++i) {
+        SnPercpuSlot *slot = &cache->slots[i];
+        while (slot->count) {
+            void *block = slot->blocks[--slot->count];
+            sn_memory_adapter_free_sized(&cache->backend, block, cache->block_size, cache->block_align);
+        }
+    }
+    unlock_backend(cache);
+
+    for (uint32_t i = 0; i < cache->slot_count; ++i) release_slot(&cache->slots[i]);
+}
+
+bool sn_percpu_slab_init(SnPercpuSlab *alloc, SnSlabAllocator *slab, void *mem, uint64_t size) {
+    if (!alloc || !slab || !mem) return false;
+
+    *alloc = (SnPercpuSlab){.slab = slab};
+
+    // Split the memory evenly between the classes
+    uint64_t class_size = size / SN_SLAB_CLASS_COUNT;
+    SnMemoryAdapter backend = sn_slab_allocator_get_adapter(slab);
+
+    for (uint32_t i = 0; i < SN_SLAB_CLASS_COUNT; ++i) {
+        uint64_t block_size = sn_slab_get_class_size(i);
+        uint64_t block_align = block_size & (~block_size + 1);
+
+        uint8_t *class_mem = ((uint8_t *)mem) + class_size * i;
+        if (!sn_percpu_cache_init(&alloc->classes[i], backend, block_size, block_align, class_mem, class_size))
+            return false;
+
+        // Every class allocates from the same slab allocator
+        alloc->classes[i].backend_lock = &alloc->lock;
+    }
+
+    return true;
+}
+
+void sn_percpu_slab_deinit(SnPercpuSlab *alloc) {
+    if (!alloc) return;
+
+    for (uint32_t i = 0; i < SN_SLAB_CLASS_COUNT; ++i) sn_percpu_cache_deinit(&alloc->classes[i]);
+    *alloc = (SnPercpuSlab){0};
+}
+
+void *sn_percpu_slab_allocate(SnPercpuSlab *alloc, uint64_t size, uint64_t align) {
+    if (!size || !align || !alloc) return NULL;
+
+    uint32_t class_index = sn_slab_get_class_index(size);
+
+    // Same class choice as the slab allocator
+    while (class_index < SN_SLAB_CLASS_COUNT && alloc->classes[class_index].block_align < align) class_index++;
+    if (class_index == SN_SLAB_CLASS_COUNT) return NULL;
+
+    return sn_percpu_cache_allocate(&alloc->classes[class_index]);
+}
+
+void sn_percpu_slab_free(SnPercpuSlab *alloc, void *ptr) {
+    if (!ptr || !alloc) return;
+
+    // The slab header is only read, it is written under the backend lock
+    uint32_t class_index = SLAB_OF(ptr)->class_index;
+    SN_ASSERT(class_index < SN_SLAB_CLASS_COUNT);
+
+    sn_percpu_cache_free(&alloc->classes[class_index], ptr);
+}
+
+static SnPercpuSlot *acquire_slot(SnPercpuCache *cache) {
+    uint32_t index = sn_cpu_current() % cache->slot_count;
+
+    // The own slot is normally free, it is only taken when a thread was
+    // preempted or migrated while holding it. Try one neighbour before
+    // going to the backend directly.
+    for (uint32_t i = 0; i < SN_MIN(cache->slot_count, 2); ++i) {
+        SnPercpuSlot *slot = &cache->slots[(index + i) % cache->slot_count];
+
+        uint64_t expected = 0;
+        if (sn_atomic_cas_u64(&slot->lock, &expected, 1)) return slot;
+    }
+
+    return NULL;
+}
+
+static void release_slot(SnPercpuSlot *slot) {
+    sn_atomic_store_u64(&slot->lock, 0);
+}
+
+static void lock_backend(SnPercpuCache *cache) {
+    uint64_t expected = 0;
+    while (!sn_atomic_cas_u64(cache->backend_lock, &expected, 1)) {
+        expected = 0;
+        sn_thread_yield();
+    }
+}
+
+static void unlock_backend(SnPercpuCache *cache) {
+    sn_atomic_store_u64(cache->backend_lock, 0);
+}
+
+#if defined(SN_HAS_RSEQ_CS)
+static void free_blocks(SnPercpuCache *cache, void **blocks, uint32_t count) {
+    lock_backend(cache);
+    for (uint32_t i = 0; i < count; ++i)
+        sn_memory_adapter_free_sized(&cache->backend, blocks[i], cache->block_size, cache->block_align);
+    unlock_backend(cache);
+}
+
+static void *restartable_allocate(SnPercpuCache *cache) {
+    void *ptr;
+    if (restartable_pop(cache, &ptr)) return ptr;
+
+    // Refill outside of any sequence, the blocks go to the CPU the thread ends up on
+    void *blocks[TRANSFER_COUNT];
+    uint32_t count = 0;
+
+    lock_backend(cache);
+    ptr = sn_memory_adapter_allocate(&cache->backend, cache->block_size, cache->block_align);
+    while (ptr && count < TRANSFER_COUNT) {
+        void *block = sn_memory_adapter_allocate(&cache->backend, cache->block_size, cache->block_align);
+        if (!block) break;
+        blocks[count++] = block;
+    }
+    unlock_backend(cache);
+
+    uint32_t pushed = 0;
+    while (pushed < count && restartable_push(cache, blocks[pushed])) pushed++;
+    if (pushed < count) free_blocks(cache, blocks + pushed, count - pushed);
+
+    return ptr;
+}
+
+static void restartable_free(SnPercpuCache *cache, void *ptr) {
+    if (restartable_push(cache, ptr)) return;
+
+    // Spill half of the slot together with the block
+    void *blocks[TRANSFER_COUNT + 1];
+    uint32_t count = 0;
+
+    blocks[count++] = ptr;
+    while (count <= TRANSFER_COUNT && restartable_pop(cache, &blocks[count])) count++;
+
+    free_blocks(cache, blocks, count);
+}
+
+static bool restartable_pop(SnPercpuCache *cache, void **ptr) {
+    struct rseq *area = sn_rseq_area();
+
+    for (;;) {
+        // The sequence checks the CPU again before its commit
+        int32_t cpu = sn_rseq_cpu(area);
+        if (cpu < 0 || (uint32_t)cpu >= cache->slot_count) return false;
+
+        SnPercpuSlot *slot = &cache->slots[cpu];
+        SnRseqResult result = sn_rseq_pop(area, (uint32_t)cpu, &slot->lock, &slot->count, slot->blocks, ptr);
+        if (result != SN_RSEQ_ABORTED) return result == SN_RSEQ_DONE;
+    }
+}
+
+static bool restartable_push(SnPercpuCache *cache, void *ptr) {
+    struct rseq *area = sn_rseq_area();
+
+    for (;;) {
+        int32_t cpu = sn_rseq_cpu(area);
+        if (cpu < 0 || (uint32_t)cpu >= cache->slot_count) return false;
+
+        SnPercpuSlot *slot = &cache->slots[cpu];
+        SnRseqResult result = sn_rseq_push(
+            area, (uint32_t)cpu, &slot->lock, &slot->count, slot->blocks, SN_PERCPU_CACHE_CAPACITY, ptr);
+        if (result != SN_RSEQ_ABORTED) return result == SN_RSEQ_DONE;
+    }
+}
+#endif
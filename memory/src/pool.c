@@ -0,0 +1,63 @@
+#include "snmemory/pool.h"
+
+#include "src/atomics.h"
+#include "src/cpu.h"
+
+static void interleave_blocks(SnPoolAllocator *alloc, uint64_t line_size);
+
+bool sn_pool_allocator_init_with_layout(
+    SnPoolAllocator *alloc, void *mem, uint64_t size, uint64_t block_size, uint64_t block_align, SnPoolLayout layout) {
+    if (!alloc || !mem || !block_align) return false;
+
+    uint64_t line_size = sn_memory_get_cache_line_size();
+
+    switch (layout) {
+        case SN_POOL_LAYOUT_LINE_PADDED:
+            block_size = SN_GET_ALIGNED(block_size, line_size);
+            return sn_pool_allocator_init(alloc, mem, size, block_size, SN_MAX(block_align, line_size));
+        case SN_POOL_LAYOUT_INTERLEAVED:
+            if (!sn_pool_allocator_init(alloc, mem, size, block_size, block_align)) return false;
+            interleave_blocks(alloc, line_size);
+            return true;
+        case SN_POOL_LAYOUT_PACKED:
+        default:
+            return sn_pool_allocator_init(alloc, mem, size, block_size, block_align);
+    }
+}
+
+uint64_t sn_memory_get_cache_line_size(void) {
+    // Detected once, racing threads store the same value
+    static uint64_t line_size = 0;
+
+    uint64_t size = sn_atomic_load_relaxed_u64(&line_size);
+    if (!size) {
+        size = sn_cpu_cache_line_size();
+        sn_atomic_store_u64(&line_size, size);
+    }
+
+    return size;
+}
+
+static void interleave_blocks(SnPoolAllocator *alloc, uint64_t line_size) {
+    uint8_t *first = (uint8_t *)alloc->free_list;
+    uint64_t block_size = alloc->block_size;
+
+    // Line sized blocks on line boundaries never share a line
+    if (block_size % line_size == 0 && SN_IS_ALIGNED(first, line_size)) return;
+
+    // Blocks this many apart never touch the same line, wherever the first one starts
+    uint64_t stride = (line_size + 2 * block_size - 2) / block_size;
+    if (stride >= alloc->block_count) return;
+
+    // Thread the free list through every stride-th block, then the ones after them
+    void **previous = &alloc->free_list;
+    for (uint64_t start = 0; start < stride; ++start) {
+        for (uint64_t i = start; i < alloc->block_count; i += stride) {
+            uint8_t *block = first + i * block_size;
+            *previous = block;
+            previous = (void **)block;
+        }
+    }
+
+    *previous = NULL;
+}
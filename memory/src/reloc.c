@@ -0,0 +1,234 @@
+#include "snmemory/reloc.h"
+
+#include "snmemory/latency.h"
+
+#include <string.h>
+
+/**
+ * @struct SnRelocBlock
+ * @brief Header in front of every block, live or free.
+ */
+typedef struct SnRelocBlock {
+    alignas(SN_RELOC_HEAP_ALIGNMENT) uint64_t size; /**< Size including the header */
+    uint32_t entry; /**< Owning handle, SN_HANDLE_NO_INDEX while free */
+} SnRelocBlock;
+
+#define BLOCK(ptr) ((SnRelocBlock *)(ptr))
+#define BLOCK_DATA(ptr) ((void *)(((uint8_t *)(ptr)) + sizeof(SnRelocBlock)))
+#define IS_FREE(ptr) (BLOCK(ptr)->entry == SN_HANDLE_NO_INDEX)
+
+// Smallest block worth splitting off
+#define MIN_BLOCK_SIZE (sizeof(SnRelocBlock) + SN_RELOC_HEAP_ALIGNMENT)
+
+static SnRelocEntry *get_entry(SnRelocHeap *heap, SnHandle handle);
+
+static uint8_t *find_hole(SnRelocHeap *heap, uint64_t size);
+
+static void write_free_block(uint8_t *block, uint64_t size);
+
+static void clamp_compaction(SnRelocHeap *heap);
+
+bool sn_reloc_heap_init(SnRelocHeap *heap, void *mem, uint64_t size, uint32_t handle_count) {
+    if (!heap || !mem || !handle_count || handle_count == SN_HANDLE_NO_INDEX) return false;
+
+    SnRelocEntry *entries = SN_GET_ALIGNED_PTR(mem, SnRelocEntry);
+    uint8_t *base = (uint8_t *)SN_GET_ALIGNED(entries + handle_count, SN_RELOC_HEAP_ALIGNMENT);
+    uint8_t *mem_end = ((uint8_t *)mem) + size;
+    if (base + MIN_BLOCK_SIZE > mem_end) return false;
+
+    // Keep every block boundary aligned up to the end
+    uint8_t *end = base + (SN_PTR_DIFF(mem_end, base) & ~((uint64_t)SN_RELOC_HEAP_ALIGNMENT - 1));
+
+    *heap = (SnRelocHeap){
+        .entries = entries,
+        .entry_count = handle_count,
+        .free_entry = SN_HANDLE_NO_INDEX,
+        .base = base,
+        .top = base,
+        .end = end,
+        .compact_dest = base,
+        .compact_scan = base,
+    };
+
+    return true;
+}
+
+SnHandle sn_reloc_heap_allocate(SnRelocHeap *heap, uint64_t size) {
+    if (!heap || !size) return SN_HANDLE_INVALID;
+
+    uint32_t index = heap->free_entry;
+    if (index == SN_HANDLE_NO_INDEX && heap->entry_high_water == heap->entry_count) return SN_HANDLE_INVALID;
+
+    size = SN_GET_ALIGNED(size, SN_RELOC_HEAP_ALIGNMENT) + sizeof(SnRelocBlock);
+
+    uint8_t *block;
+    if (size <= SN_PTR_DIFF(heap->end, heap->top)) {
+        block = heap->top;
+        heap->top += size;
+    } else {
+        block = find_hole(heap, size);
+        if (!block) return SN_HANDLE_INVALID;
+
+        if (BLOCK(block)->size - size >= MIN_BLOCK_SIZE) {
+            write_free_block(block + size, BLOCK(block)->size - size);
+        } else {
+            size = BLOCK(block)->size;
+        }
+
+        // The hole may have been the gap of the running pass, look at it again
+        heap->compact_scan = heap->compact_dest;
+    }
+
+    if (index != SN_HANDLE_NO_INDEX) {
+        heap->free_entry = heap->entries[index].pins;
+    } else {
+        index = heap->entry_high_water++;
+        heap->entries[index].generation = 0;
+    }
+
+    SnRelocEntry *entry = &heap->entries[index];
+    entry->block = block;
+    entry->generation++;
+    entry->pins = 0;
+
+    *BLOCK(block) = (SnRelocBlock){.size = size, .entry = index};
+    heap->used_size += size;
+
+    return (SnHandle)entry->generation << 32 | index;
+}
+
+bool sn_reloc_heap_free(SnRelocHeap *heap, SnHandle handle) {
+    SnRelocEntry *entry = get_entry(heap, handle);
+    if (!entry || entry->pins) return false;
+
+    uint8_t *block = entry->block;
+    uint64_t size = BLOCK(block)->size;
+
+    BLOCK(block)->entry = SN_HANDLE_NO_INDEX;
+    heap->used_size -= size;
+
+    if (block + size == heap->top) {
+        heap->top = block;
+        clamp_compaction(heap);
+    }
+
+    entry->generation++;
+    entry->pins = heap->free_entry;
+    heap->free_entry = (uint32_t)handle;
+
+    return true;
+}
+
+void *sn_reloc_heap_pin(SnRelocHeap *heap, SnHandle handle) {
+    SnRelocEntry *entry = get_entry(heap, handle);
+    if (!entry) return NULL;
+
+    entry->pins++;
+    return BLOCK_DATA(entry->block);
+}
+
+void sn_reloc_heap_unpin(SnRelocHeap *heap, SnHandle handle) {
+    SnRelocEntry *entry = get_entry(heap, handle);
+    if (!entry) return;
+
+    SN_ASSERT(entry->pins);
+    entry->pins--;
+}
+
+uint64_t sn_reloc_heap_get_size(SnRelocHeap *heap, SnHandle handle) {
+    SnRelocEntry *entry = get_entry(heap, handle);
+    if (!entry) return 0;
+
+    return BLOCK(entry->block)->size - sizeof(SnRelocBlock);
+}
+
+uint64_t sn_reloc_heap_compact(SnRelocHeap *heap, uint64_t max_bytes, uint64_t max_ticks) {
+    if (!heap) return 0;
+
+    uint64_t start = max_ticks ? sn_cycle_counter() : 0;
+    uint64_t moved = 0;
+
+    // [dest, scan) is a single free gap, blocks past scan were not looked at yet
+    uint8_t *dest = heap->compact_dest;
+    uint8_t *scan = heap->compact_scan;
+
+    // Holes freed behind a pass are only reclaimed by the next one, so a
+    // pass that did not start here is followed by a full one
+    bool full_pass = scan == heap->base;
+
+    for (;;) {
+        if (scan >= heap->top) {
+            heap->top = dest;
+            dest = scan = heap->base;
+
+            if (full_pass) break;
+            full_pass = true;
+        }
+
+        if (max_bytes && moved >= max_bytes) break;
+        if (max_ticks && sn_cycle_counter() - start >= max_ticks) break;
+
+        uint64_t size = BLOCK(scan)->size;
+
+        if (IS_FREE(scan)) {
+            scan += size;
+        } else if (heap->entries[BLOCK(scan)->entry].pins) {
+            // Leave the gap as a hole, continue after the pinned block
+            if (dest != scan) write_free_block(dest, SN_PTR_DIFF(scan, dest));
+            dest = scan = scan + size;
+            continue;
+        } else {
+            if (dest != scan) {
+                heap->entries[BLOCK(scan)->entry].block = dest;
+                memmove(dest, scan, size);
+                moved += size;
+            }
+            dest += size;
+            scan += size;
+        }
+
+        if (dest != scan) write_free_block(dest, SN_PTR_DIFF(scan, dest));
+    }
+
+    heap->compact_dest = dest;
+    heap->compact_scan = scan;
+
+    return moved;
+}
+
+static SnRelocEntry *get_entry(SnRelocHeap *heap, SnHandle handle) {
+    if (!heap || !sn_reloc_heap_is_valid(heap, handle)) return NULL;
+    return &heap->entries[(uint32_t)handle];
+}
+
+static uint8_t *find_hole(SnRelocHeap *heap, uint64_t size) {
+    uint8_t *block = heap->base;
+
+    while (block < heap->top) {
+        if (IS_FREE(block)) {
+            // Coalesce following holes, never across a compaction boundary
+            uint8_t *next = block + BLOCK(block)->size;
+            while (next < heap->top && IS_FREE(next)) {
+                if (next == heap->compact_dest || next == heap->compact_scan) break;
+
+                BLOCK(block)->size += BLOCK(next)->size;
+                next += BLOCK(next)->size;
+            }
+
+            if (BLOCK(block)->size >= size) return block;
+        }
+
+        block += BLOCK(block)->size;
+    }
+
+    return NULL;
+}
+
+static void write_free_block(uint8_t *block, uint64_t size) {
+    *BLOCK(block) = (SnRelocBlock){.size = size, .entry = SN_HANDLE_NO_INDEX};
+}
+
+static void clamp_compaction(SnRelocHeap *heap) {
+    if (heap->compact_scan > heap->top) heap->compact_scan = heap->top;
+    if (heap->compact_dest > heap->top) heap->compact_dest = heap->top;
+}
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <sncore/defines.h>
+
+// Private restartable sequences (rseq) helpers, Linux only.
+//
+// A sequence runs on one CPU and ends in a single commit store. If the thread
+// is preempted, migrated or gets a signal before the commit, the kernel moves
+// it to the abort handler instead, so per-CPU data is updated without atomics.
+
+#if defined(SN_OS_LINUX) && defined(__has_include) && defined(__has_builtin)
+    #if __has_include(<sys/rseq.h>) && __has_builtin(__builtin_thread_pointer)
+        #include <sys/rseq.h>
+        #define SN_HAS_RSEQ
+    #endif
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+    #define SN_RSEQ_TSAN
+#elif defined(__has_feature)
+    #if __has_feature(thread_sanitizer)
+        #define SN_RSEQ_TSAN
+    #endif
+#endif
+
+// Critical sections are hand written per architecture. ThreadSanitizer can
+// not see the ordering they give, so its builds keep the atomic fallbacks.
+#if defined(SN_HAS_RSEQ) && (defined(__x86_64__) || defined(__AARCH64EL__)) && !defined(SN_RSEQ_TSAN)
+    #define SN_HAS_RSEQ_CS
+#endif
+
+#if defined(SN_HAS_RSEQ)
+
+/**
+ * @brief Get the rseq area glibc registered for the calling thread.
+ *
+ * @return Returns NULL if glibc did not register rseq.
+ */
+SN_FORCE_INLINE struct rseq *sn_rseq_area(void) {
+    if (__rseq_size == 0) return NULL;
+    return (struct rseq *)((uint8_t *)__builtin_thread_pointer() + __rseq_offset);
+}
+
+/**
+ * @brief Get the CPU the thread runs on, negative if the area is not registered.
+ */
+SN_FORCE_INLINE int32_t sn_rseq_cpu(struct rseq *area) {
+    return (int32_t)__atomic_load_n(&area->cpu_id, __ATOMIC_RELAXED);
+}
+
+#endif
+
+#if defined(SN_HAS_RSEQ_CS)
+
+typedef enum SnRseqResult {
+    SN_RSEQ_DONE, /**< Committed */
+    SN_RSEQ_FAILED, /**< Left before the commit, the stack is blocked, empty or full */
+    SN_RSEQ_ABORTED, /**< Restarted by the kernel, try again */
+} SnRseqResult;
+
+/**
+ * @brief Let @ref sn_rseq_fence restart sequences of other threads.
+ *
+ * @return Returns false if the kernel does not support it.
+ */
+bool sn_rseq_fence_register(void);
+
+/**
+ * @brief Restart every sequence running on other CPUs.
+ *
+ * Sequences started afterwards see the stores made before the fence.
+ *
+ * @note @ref sn_rseq_fence_register must have succeeded.
+ */
+void sn_rseq_fence(void);
+
+    #define SN_RSEQ_STR_(x) #x
+    #define SN_RSEQ_STR(x) SN_RSEQ_STR_(x)
+
+    #if defined(__x86_64__)
+
+        // Descriptor the kernel reads while the sequence runs (struct rseq_cs)
+        #define SN_RSEQ_TABLE(label, start, commit, abort)             \
+            ".pushsection __rseq_cs, \"aw\"\n\t"                       \
+            ".balign 32\n\t" label ":\n\t"                             \
+            ".long 0x0, 0x0\n\t"                                       \
+            ".quad " start ", (" commit " - " start "), " abort "\n\t" \
+            ".popsection\n\t"
+
+        #define SN_RSEQ_START(label, table)            \
+            "leaq " table "(%%rip), %%rax\n\t"         \
+            "movq %%rax, %[rseq_cs]\n\t" label ":\n\t"
+
+        #define SN_RSEQ_CHECK_CPU(abort) \
+            "cmpl %[cpu], %[cpu_id]\n\t" \
+            "jnz " abort "\n\t"
+
+        // The kernel checks the signature right before the abort handler
+        #define SN_RSEQ_ABORT(label, target)                    \
+            ".pushsection __rseq_failure, \"ax\"\n\t"           \
+            ".byte 0x0f, 0xb9, 0x3d\n\t"                        \
+            ".long " SN_RSEQ_STR(RSEQ_SIG) "\n\t" label ":\n\t" \
+            "jmp %l[" target "]\n\t"                            \
+            ".popsection\n\t"
+
+/**
+ * @brief Pop the top item of the stack of a CPU.
+ *
+ * @param area The rseq area of the calling thread
+ * @param cpu CPU the stack belongs to
+ * @param blocked Nonzero while the stack must not be touched
+ * @param count Number of items
+ * @param items The items
+ * @param out Receives the item
+ */
+SN_FORCE_INLINE SnRseqResult
+    sn_rseq_pop(struct rseq *area, uint32_t cpu, uint64_t *blocked, uint64_t *count, void **items, void **out) {
+    __asm__ goto(
+        SN_RSEQ_TABLE("3", "1f", "2f", "4f")
+        SN_RSEQ_START("1", "3b")
+        SN_RSEQ_CHECK_CPU("4f")
+        "cmpq $0, %[blocked]\n\t"
+        "jnz %l[failed]\n\t"
+        "movq %[count], %%rcx\n\t"
+        "testq %%rcx, %%rcx\n\t"
+        "jz %l[failed]\n\t"
+        "subq $1, %%rcx\n\t"
+        "movq (%[items], %%rcx, 8), %%rdx\n\t"
+        "movq %%rdx, %[out]\n\t"
+        "movq %%rcx, %[count]\n\t"
+        "2:\n\t"
+        SN_RSEQ_ABORT("4", "aborted")
+        :
+        : [cpu] "r"(cpu), [cpu_id] "m"(area->cpu_id), [rseq_cs] "m"(area->rseq_cs), [blocked] "m"(*blocked),
+          [count] "m"(*count), [items] "r"(items), [out] "m"(*out)
+        : "memory", "cc", "rax", "rcx", "rdx"
+        : failed, aborted);
+    return SN_RSEQ_DONE;
+failed:
+    return SN_RSEQ_FAILED;
+aborted:
+    return SN_RSEQ_ABORTED;
+}
+
+/**
+ * @brief Push an item onto the stack of a CPU.
+ *
+ * @param area The rseq area of the calling thread
+ * @param cpu CPU the stack belongs to
+ * @param blocked Nonzero while the stack must not be touched
+ * @param count Number of items
+ * @param items The items
+ * @param capacity Maximum number of items
+ * @param item The item
+ */
+SN_FORCE_INLINE SnRseqResult sn_rseq_push(
+    struct rseq *area, uint32_t cpu, uint64_t *blocked, uint64_t *count, void **items, uint64_t capacity, void *item) {
+    __asm__ goto(
+        SN_RSEQ_TABLE("3", "1f", "2f", "4f")
+        SN_RSEQ_START("1", "3b")
+        SN_RSEQ_CHECK_CPU("4f")
+        "cmpq $0, %[blocked]\n\t"
+        "jnz %l[failed]\n\t"
+        "movq %[count], %%rcx\n\t"
+        "cmpq %[capacity], %%rcx\n\t"
+        "jae %l[failed]\n\t"
+        "movq %[item], (%[items], %%rcx, 8)\n\t"
+        "addq $1, %%rcx\n\t"
+        "movq %%rcx, %[count]\n\t"
+        "2:\n\t"
+        SN_RSEQ_ABORT("4", "aborted")
+        :
+        : [cpu] "r"(cpu), [cpu_id] "m"(area->cpu_id), [rseq_cs] "m"(area->rseq_cs), [blocked] "m"(*blocked),
+          [count] "m"(*count), [items] "r"(items), [capacity] "r"(capacity), [item] "r"(item)
+        : "memory", "cc", "rax", "rcx"
+        : failed, aborted);
+    return SN_RSEQ_DONE;
+failed:
+    return SN_RSEQ_FAILED;
+aborted:
+    return SN_RSEQ_ABORTED;
+}
+
+    #elif defined(__AARCH64EL__)
+
+        #define SN_RSEQ_TABLE(label, start, commit, abort)           \
+            ".pushsection __rseq_cs, \"aw\"\n\t"                     \
+            ".balign 32\n\t" label ":\n\t"                           \
+            ".long 0x0, 0x0\n\t"                                     \
+            ".quad " start ", " commit " - " start ", " abort "\n\t" \
+            ".popsection\n\t"
+
+        #define SN_RSEQ_START(label, table)           \
+            "adrp x15, " table "\n\t"                 \
+            "add x15, x15, :lo12:" table "\n\t"       \
+            "str x15, [%[rseq_cs]]\n\t" label ":\n\t"
+
+        #define SN_RSEQ_CHECK_CPU(abort) \
+            "ldr w15, [%[cpu_id]]\n\t"   \
+            "cmp w15, %w[cpu]\n\t"       \
+            "bne " abort "\n\t"
+
+        // The kernel checks the signature right before the abort handler
+        #define SN_RSEQ_ABORT(label, target)      \
+            "b 5f\n\t"                            \
+            ".inst " SN_RSEQ_STR(RSEQ_SIG) "\n\t" \
+            label ":\n\t"                         \
+            "b %l[" target "]\n\t"                \
+            "5:\n\t"
+
+/**
+ * @brief Pop the top item of the stack of a CPU.
+ *
+ * @param area The rseq area of the calling thread
+ * @param cpu CPU the stack belongs to
+ * @param blocked Nonzero while the stack must not be touched
+ * @param count Number of items
+ * @param items The items
+ * @param out Receives the item
+ */
+SN_FORCE_INLINE SnRseqResult
+    sn_rseq_pop(struct rseq *area, uint32_t cpu, uint64_t *blocked, uint64_t *count, void **items, void **out) {
+    // The blocked flag is read with acquire, the count must not be read before it
+    __asm__ goto(
+        SN_RSEQ_TABLE("3", "1f", "2f", "4f")
+        SN_RSEQ_START("1", "3b")
+        SN_RSEQ_CHECK_CPU("4f")
+        "ldar x13, [%[blocked]]\n\t"
+        "cbnz x13, %l[failed]\n\t"
+        "ldr x13, [%[count]]\n\t"
+        "cbz x13, %l[failed]\n\t"
+        "sub x13, x13, #1\n\t"
+        "ldr x14, [%[items], x13, lsl #3]\n\t"
+        "str x14, [%[out]]\n\t"
+        "str x13, [%[count]]\n\t"
+        "2:\n\t"
+        SN_RSEQ_ABORT("4", "aborted")
+        :
+        : [cpu] "r"(cpu), [cpu_id] "r"(&area->cpu_id), [rseq_cs] "r"(&area->rseq_cs), [blocked] "r"(blocked),
+          [count] "r"(count), [items] "r"(items), [out] "r"(out)
+        : "memory", "cc", "x13", "x14", "x15"
+        : failed, aborted);
+    return SN_RSEQ_DONE;
+failed:
+    return SN_RSEQ_FAILED;
+aborted:
+    return SN_RSEQ_ABORTED;
+}
+
+/**
+ * @brief Push an item onto the stack of a CPU.
+ *
+ * @param area The rseq area of the calling thread
+ * @param cpu CPU the stack belongs to
+ * @param blocked Nonzero while the stack must not be touched
+ * @param count Number of items
+ * @param items The items
+ * @param capacity Maximum number of items
+ * @param item The item
+ */
+SN_FORCE_INLINE SnRseqResult sn_rseq_push(
+    struct rseq *area, uint32_t cpu, uint64_t *blocked, uint64_t *count, void **items, uint64_t capacity, void *item) {
+    __asm__ goto(
+        SN_RSEQ_TABLE("3", "1f", "2f", "4f")
+        SN_RSEQ_START("1", "3b")
+        SN_RSEQ_CHECK_CPU("4f")
+        "ldar x13, [%[blocked]]\n\t"
+        "cbnz x13, %l[failed]\n\t"
+        "ldr x13, [%[count]]\n\t"
+        "cmp x13, %[capacity]\n\t"
+        "b.hs %l[failed]\n\t"
+        "str %[item], [%[items], x13, lsl #3]\n\t"
+        "add x13, x13, #1\n\t"
+        "str x13, [%[count]]\n\t"
+        "2:\n\t"
+        SN_RSEQ_ABORT("4", "aborted")
+        :
+        : [cpu] "r"(cpu), [cpu_id] "r"(&area->cpu_id), [rseq_cs] "r"(&area->rseq_cs), [blocked] "r"(blocked),
+          [count] "r"(count), [items] "r"(items), [capacity] "r"(capacity), [item] "r"(item)
+        : "memory", "cc", "x13", "x15"
+        : failed, aborted);
+    return SN_RSEQ_DONE;
+failed:
+    return SN_RSEQ_FAILED;
+aborted:
+    return SN_RSEQ_ABORTED;
+}
+
+    #endif
+
+#endif
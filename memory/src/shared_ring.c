@@ -0,0 +1,228 @@
+#include "snmemory/shared_ring.h"
+
+#include "src/atomics.h"
+#include "src/shm_internal.h"
+
+#include <string.h>
+#include <time.h>
+
+/**
+ * @struct SnSharedRecord
+ * @brief Header in front of every message.
+ */
+typedef struct SnSharedRecord {
+    alignas(SN_SHARED_RING_ALIGNMENT) uint64_t size; /**< Size of the message, PADDING_RECORD for padding */
+} SnSharedRecord;
+
+// Fills the end of the data when a record does not fit before the wrap
+#define PADDING_RECORD UINT64_MAX
+
+// Smallest capacity, keeps the largest message above a few records
+#define MIN_CAPACITY (4 * 2 * sizeof(SnSharedRecord))
+
+static bool attach(
+    SnSharedRing *ring, const char *name, void *mem, uint64_t mapped_size, intptr_t handle, bool owner);
+
+static bool wait_for_offset(SnSharedRing *ring, bool producer, uint64_t target, uint32_t timeout_ms);
+
+static void wake(volatile uint32_t *signal, volatile uint32_t *waiting);
+
+static uint64_t now_ms(void);
+
+bool sn_shared_ring_create(SnSharedRing *ring, const char *name, uint64_t capacity) {
+    if (!ring || !name || strlen(name) >= SN_SHARED_RING_NAME_MAX || !capacity) return false;
+
+    uint64_t data_capacity = MIN_CAPACITY;
+    while (data_capacity < capacity) data_capacity <<= 1;
+
+    uint64_t size = sizeof(SnSharedRingHeader) + data_capacity;
+    intptr_t handle;
+    void *mem = sn_shm_map(name, &size, true, &handle);
+    if (!mem) return false;
+
+    SnSharedRingHeader *header = (SnSharedRingHeader *)mem;
+    header->capacity = data_capacity;
+
+    // Magic last, a process that sees it sees an initialized header
+    sn_atomic_store_u64(&header->magic, SN_SHARED_RING_MAGIC);
+
+    if (attach(ring, name, mem, size, handle, true)) return true;
+
+    sn_shm_unmap(mem, size, handle);
+    sn_shm_unlink(name);
+    return false;
+}
+
+bool sn_shared_ring_open(SnSharedRing *ring, const char *name) {
+    if (!ring || !name || strlen(name) >= SN_SHARED_RING_NAME_MAX) return false;
+
+    uint64_t size = 0;
+    intptr_t handle;
+    void *mem = sn_shm_map(name, &size, false, &handle);
+    if (!mem) return false;
+
+    if (size >= sizeof(SnSharedRingHeader) && attach(ring, name, mem, size, handle, false)) return true;
+
+    sn_shm_unmap(mem, size, handle);
+    return false;
+}
+
+void sn_shared_ring_close(SnSharedRing *ring) {
+    if (!ring || !ring->header) return;
+
+    sn_shm_unmap(ring->header, ring->mapped_size, ring->handle);
+    if (ring->owner) sn_shm_unlink(ring->name);
+
+    *ring = (SnSharedRing){0};
+}
+
+void *sn_shared_ring_reserve(SnSharedRing *ring, uint64_t size, uint32_t timeout_ms) {
+    if (!ring || !ring->header || size > sn_shared_ring_get_max_message_size(ring)) return NULL;
+
+    SnSharedRingHeader *header = ring->header;
+    uint64_t capacity = ring->mask + 1;
+
+    // Only this side moves the write offset
+    uint64_t write = sn_atomic_load_relaxed_u64(&header->write_offset);
+    uint64_t record_size = sizeof(SnSharedRecord) + SN_GET_ALIGNED(size, SN_SHARED_RING_ALIGNMENT);
+
+    // Records never wrap, pad the end of the data instead
+    uint64_t contiguous = capacity - (write & ring->mask);
+    uint64_t skip = contiguous < record_size ? contiguous : 0;
+
+    if (!wait_for_offset(ring, true, write + skip + record_size, timeout_ms)) return NULL;
+
+    if (skip) ((SnSharedRecord *)(ring->data + (write & ring->mask)))->size = PADDING_RECORD;
+
+    SnSharedRecord *record = (SnSharedRecord *)(ring->data + ((write + skip) & ring->mask));
+    record->size = size;
+
+    ring->pending = record_size;
+    ring->pending_skip = skip;
+
+    return record + 1;
+}
+
+void sn_shared_ring_commit(SnSharedRing *ring) {
+    if (!ring || !ring->pending) return;
+
+    SnSharedRingHeader *header = ring->header;
+    uint64_t write = sn_atomic_load_relaxed_u64(&header->write_offset);
+
+    // Padding and record are published together
+    sn_atomic_store_u64(&header->write_offset, write + ring->pending_skip + ring->pending);
+    ring->pending = 0;
+
+    wake(&header->data_signal, &header->consumer_waiting);
+}
+
+void *sn_shared_ring_peek(SnSharedRing *ring, uint64_t *out_size, uint32_t timeout_ms) {
+    if (!ring || !ring->header) return NULL;
+
+    SnSharedRingHeader *header = ring->header;
+
+    // Only this side moves the read offset
+    uint64_t read = sn_atomic_load_relaxed_u64(&header->read_offset);
+
+    if (!ring->pending) {
+        if (!wait_for_offset(ring, false, read + 1, timeout_ms)) return NULL;
+
+        uint64_t skip = 0;
+        if (((SnSharedRecord *)(ring->data + (read & ring->mask)))->size == PADDING_RECORD)
+            skip = ring->mask + 1 - (read & ring->mask);
+
+        SnSharedRecord *record = (SnSharedRecord *)(ring->data + ((read + skip) & ring->mask));
+        ring->pending = sizeof(SnSharedRecord) + SN_GET_ALIGNED(record->size, SN_SHARED_RING_ALIGNMENT);
+        ring->pending_skip = skip;
+    }
+
+    SnSharedRecord *record = (SnSharedRecord *)(ring->data + ((read + ring->pending_skip) & ring->mask));
+    if (out_size) *out_size = record->size;
+
+    return record + 1;
+}
+
+void sn_shared_ring_release(SnSharedRing *ring) {
+    if (!ring || !ring->pending) return;
+
+    SnSharedRingHeader *header = ring->header;
+    uint64_t read = sn_atomic_load_relaxed_u64(&header->read_offset);
+
+    sn_atomic_store_u64(&header->read_offset, read + ring->pending_skip + ring->pending);
+    ring->pending = 0;
+
+    wake(&header->space_signal, &header->producer_waiting);
+}
+
+static bool attach(
+    SnSharedRing *ring, const char *name, void *mem, uint64_t mapped_size, intptr_t handle, bool owner) {
+    SnSharedRingHeader *header = (SnSharedRingHeader *)mem;
+    if (sn_atomic_load_u64(&header->magic) != SN_SHARED_RING_MAGIC) return false;
+
+    uint64_t capacity = header->capacity;
+    if (capacity < MIN_CAPACITY || (capacity & (capacity - 1))) return false;
+    if (sizeof(SnSharedRingHeader) + capacity > mapped_size) return false;
+
+    *ring = (SnSharedRing){
+        .header = header,
+        .data = (uint8_t *)(header + 1),
+        .mask = capacity - 1,
+        .mapped_size = mapped_size,
+        .handle = handle,
+        .owner = owner,
+    };
+    strcpy(ring->name, name);
+
+    return true;
+}
+
+// Waits until the offset moved by the other side reaches target: the read
+// offset plus the capacity for the producer, the write offset for the consumer
+static bool wait_for_offset(SnSharedRing *ring, bool producer, uint64_t target, uint32_t timeout_ms) {
+    SnSharedRingHeader *header = ring->header;
+    volatile uint64_t *offset = producer ? &header->read_offset : &header->write_offset;
+    volatile uint32_t *signal = producer ? &header->space_signal : &header->data_signal;
+    volatile uint32_t *waiting = producer ? &header->producer_waiting : &header->consumer_waiting;
+    uint64_t bias = producer ? ring->mask + 1 : 0;
+
+    if (sn_atomic_load_u64(offset) + bias >= target) return true;
+    if (!timeout_ms) return false;
+
+    uint64_t deadline = timeout_ms == SN_SHARED_RING_WAIT_FOREVER ? UINT64_MAX : now_ms() + timeout_ms;
+    bool ready;
+
+    for (;;) {
+        uint32_t value = sn_atomic_load_u32(signal);
+        sn_atomic_store_u32(waiting, 1);
+
+        // Pairs with the fence in wake: either the other side sees the flag
+        // or this check sees its update
+        sn_atomic_fence();
+        ready = sn_atomic_load_u64(offset) + bias >= target;
+        if (ready) break;
+
+        uint64_t now = now_ms();
+        if (now >= deadline) break;
+
+        uint64_t remaining = deadline - now;
+        sn_shm_wait(signal, value, remaining >= UINT32_MAX ? UINT32_MAX : (uint32_t)remaining);
+    }
+
+    sn_atomic_store_u32(waiting, 0);
+    return ready;
+}
+
+static void wake(volatile uint32_t *signal, volatile uint32_t *waiting) {
+    // Orders the offset store before the flag load
+    sn_atomic_fence();
+    if (!sn_atomic_load_u32(waiting)) return;
+
+    sn_atomic_add_u32(signal, 1);
+    sn_shm_wake(signal);
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
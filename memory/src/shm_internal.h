@@ -0,0 +1,36 @@
+#pragma once
+
+#include <sncore/defines.h>
+#include <sncore/types.h>
+
+// Named shared memory and cross-process waits, implemented per platform in nix/ and win32/.
+
+/**
+ * @brief Map named shared memory read-write.
+ *
+ * @param name Name of the shared memory.
+ * @param size Size to create it with, receives the mapped size when opening.
+ * @param create Create it, fails if the name exists.
+ * @param handle Receives the descriptor or handle.
+ *
+ * @return Returns start of the mapping or NULL on failure.
+ */
+void *sn_shm_map(const char *name, uint64_t *size, bool create, intptr_t *handle);
+
+void sn_shm_unmap(void *ptr, uint64_t size, intptr_t handle);
+
+void sn_shm_unlink(const char *name);
+
+/**
+ * @brief Sleep while the word holds the value, also across processes.
+ *
+ * @param word Word in shared memory.
+ * @param value Value seen before deciding to sleep.
+ * @param timeout_ms Upper bound on the wait, UINT32_MAX for none. Spurious wake ups are possible.
+ */
+void sn_shm_wait(volatile uint32_t *word, uint32_t value, uint32_t timeout_ms);
+
+/**
+ * @brief Wake every process sleeping on the word.
+ */
+void sn_shm_wake(volatile uint32_t *word);
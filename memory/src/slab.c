@@ -0,0 +1,182 @@
+#include "snmemory/slab.h"
+
+#include <string.h>
+
+#define SLAB_OF(ptr) ((SnSlab *)(((uint64_t)(ptr)) & ~((uint64_t)SN_SLAB_SIZE - 1)))
+
+// Granularity of the lookup table
+#define LOOKUP_SHIFT 4
+
+_Static_assert((SN_SLAB_SIZE & (SN_SLAB_SIZE - 1)) == 0, "SN_SLAB_SIZE must be a power of two");
+
+static const uint16_t class_sizes[SN_SLAB_CLASS_COUNT] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384,
+    448, 512, 640, 768, 896, 1024, 1280, 1536, 1792, 2048, 2560, 3072, 3584, 4096,
+};
+
+// Class index for (size + 15) >> 4
+static const uint8_t class_lookup[(SN_SLAB_MAX_SIZE >> LOOKUP_SHIFT) + 1] = {
+    0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  8,  9,  9,  10, 10, 11,
+    11, 12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15,
+    15, 16, 16, 16, 16, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17,
+    17, 18, 18, 18, 18, 18, 18, 18, 18, 19, 19, 19, 19, 19, 19, 19,
+    19, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+    20, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22,
+    22, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23,
+    23, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26,
+    26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26,
+    26, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27,
+    27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27,
+    27,
+};
+
+static uint64_t class_align(uint32_t class_index);
+
+static SnSlab *take_slab(SnSlabAllocator *alloc, uint32_t class_index);
+
+static void unlink_partial(SnSlabAllocator *alloc, SnSlab *slab);
+
+static void push_partial(SnSlabAllocator *alloc, SnSlab *slab);
+
+bool sn_slab_allocator_init(SnSlabAllocator *alloc, void *mem, uint64_t size) {
+    if (!alloc || !mem || !size) return false;
+
+    *alloc = (SnSlabAllocator){.mem = mem, .size = size};
+
+    uint8_t *end = ((uint8_t *)mem) + size;
+    uint8_t *slab = (uint8_t *)SN_GET_ALIGNED(mem, SN_SLAB_SIZE);
+
+    // Link slabs in address order so that low addresses are used first
+    SnSlab **tail = &alloc->free_slabs;
+    while (slab < end && SN_PTR_DIFF(end, slab) >= SN_SLAB_SIZE) {
+        *tail = (SnSlab *)slab;
+        tail = &((SnSlab *)slab)->next;
+        alloc->slab_count++;
+        slab += SN_SLAB_SIZE;
+    }
+    *tail = NULL;
+
+    alloc->free_slab_count = alloc->slab_count;
+
+    return alloc->slab_count > 0;
+}
+
+void *sn_slab_allocator_allocate(SnSlabAllocator *alloc, uint64_t size, uint64_t align) {
+    if (!size || !align || !alloc) return NULL;
+
+    uint32_t class_index = sn_slab_get_class_index(size);
+
+    // Move up to a class whose blocks are aligned enough
+    while (class_index < SN_SLAB_CLASS_COUNT && class_align(class_index) < align) class_index++;
+    if (class_index == SN_SLAB_CLASS_COUNT) return NULL;
+
+    SnSlab *slab = alloc->partial[class_index];
+    if (!slab) slab = take_slab(alloc, class_index);
+    if (!slab) return NULL;
+
+    void *ptr = sn_pool_allocator_allocate(&slab->pool);
+
+    if (!slab->pool.free_count) unlink_partial(alloc, slab);
+
+    return ptr;
+}
+
+void sn_slab_allocator_free(SnSlabAllocator *alloc, void *ptr) {
+    if (!ptr || !alloc) return;
+
+    SN_ASSERT((uint8_t *)ptr >= alloc->mem && (uint8_t *)ptr < alloc->mem + alloc->size);
+
+    SnSlab *slab = SLAB_OF(ptr);
+    bool was_full = slab->pool.free_count == 0;
+
+    sn_pool_allocator_free(&slab->pool, ptr);
+
+    if (was_full) push_partial(alloc, slab);
+
+    // Give an empty slab back unless it is the last one of its class,
+    // keeping one around avoids re-initializing it on alloc/free cycles.
+    if (slab->pool.free_count == slab->pool.block_count
+        && (slab->next || alloc->partial[slab->class_index] != slab)) {
+        unlink_partial(alloc, slab);
+        slab->next = alloc->free_slabs;
+        alloc->free_slabs = slab;
+        alloc->free_slab_count++;
+    }
+}
+
+void *sn_slab_allocator_reallocate(SnSlabAllocator *alloc, void *ptr, uint64_t new_size, uint64_t align) {
+    if (!ptr || !new_size || !align || !alloc) return NULL;
+
+    SnSlab *slab = SLAB_OF(ptr);
+    uint64_t current_size = slab->pool.block_size;
+
+    if (new_size <= current_size && SN_IS_ALIGNED(ptr, align)) return ptr;
+
+    void *new_ptr = sn_slab_allocator_allocate(alloc, new_size, align);
+    if (!new_ptr) return NULL;
+
+    memcpy(new_ptr, ptr, SN_MIN(new_size, current_size));
+
+    sn_slab_allocator_free(alloc, ptr);
+
+    return new_ptr;
+}
+
+uint32_t sn_slab_get_class_index(uint64_t size) {
+    if (size > SN_SLAB_MAX_SIZE) return SN_SLAB_CLASS_COUNT;
+    return class_lookup[(size + (1 << LOOKUP_SHIFT) - 1) >> LOOKUP_SHIFT];
+}
+
+uint64_t sn_slab_get_class_size(uint32_t class_index) {
+    if (class_index >= SN_SLAB_CLASS_COUNT) return 0;
+    return class_sizes[class_index];
+}
+
+static uint64_t class_align(uint32_t class_index) {
+    // Largest power of two dividing the block size
+    uint64_t size = class_sizes[class_index];
+    return size & (~size + 1);
+}
+
+static SnSlab *take_slab(SnSlabAllocator *alloc, uint32_t class_index) {
+    SnSlab *slab = alloc->free_slabs;
+    if (!slab) return NULL;
+
+    alloc->free_slabs = slab->next;
+    alloc->free_slab_count--;
+
+    uint64_t block_size = class_sizes[class_index];
+    bool initialized = sn_pool_allocator_init(
+        &slab->pool, slab + 1, SN_SLAB_SIZE - sizeof(SnSlab), block_size, class_align(class_index));
+    SN_ASSERT(initialized);
+    SN_UNUSED(initialized);
+
+    slab->class_index = class_index;
+    push_partial(alloc, slab);
+
+    return slab;
+}
+
+static void unlink_partial(SnSlabAllocator *alloc, SnSlab *slab) {
+    if (slab->previous) slab->previous->next = slab->next;
+    else alloc->partial[slab->class_index] = slab->next;
+
+    if (slab->next) slab->next->previous = slab->previous;
+
+    slab->next = slab->previous = NULL;
+}
+
+static void push_partial(SnSlabAllocator *alloc, SnSlab *slab) {
+    SnSlab *head = alloc->partial[slab->class_index];
+
+    slab->previous = NULL;
+    slab->next = head;
+    if (head) head->previous = slab;
+
+    alloc->partial[slab->class_index] = slab;
+}
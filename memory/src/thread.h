@@ -0,0 +1,71 @@
+#pragma once
+
+#include <sncore/defines.h>
+
+// Private threading primitives, implemented per platform in nix/ and win32/.
+
+#if defined(SN_OS_WINDOWS)
+    #include <windows.h>
+
+typedef SRWLOCK SnMutex;
+typedef CONDITION_VARIABLE SnCondition;
+typedef HANDLE SnThreadHandle;
+#else
+    #include <pthread.h>
+
+typedef pthread_mutex_t SnMutex;
+typedef pthread_cond_t SnCondition;
+typedef pthread_t SnThreadHandle;
+#endif
+
+typedef void (*SnThreadFn)(void *arg);
+
+/**
+ * @struct SnThread
+ * @brief A joinable thread.
+ *
+ * @note Must stay alive (and not move) until joined.
+ */
+typedef struct SnThread {
+    SnThreadHandle handle;
+    SnThreadFn fn;
+    void *arg;
+} SnThread;
+
+bool sn_mutex_init(SnMutex *mutex);
+
+void sn_mutex_deinit(SnMutex *mutex);
+
+void sn_mutex_lock(SnMutex *mutex);
+
+bool sn_mutex_try_lock(SnMutex *mutex);
+
+void sn_mutex_unlock(SnMutex *mutex);
+
+bool sn_condition_init(SnCondition *condition);
+
+void sn_condition_deinit(SnCondition *condition);
+
+void sn_condition_signal(SnCondition *condition);
+
+void sn_condition_broadcast(SnCondition *condition);
+
+/**
+ * @brief Wait on the condition, the mutex must be locked.
+ *
+ * @param condition The condition.
+ * @param mutex The locked mutex.
+ * @param timeout_ms Upper bound on the wait, spurious wake ups are possible.
+ */
+void sn_condition_wait(SnCondition *condition, SnMutex *mutex, uint32_t timeout_ms);
+
+bool sn_thread_create(SnThread *thread, SnThreadFn fn, void *arg);
+
+void sn_thread_join(SnThread *thread);
+
+void sn_thread_yield(void);
+
+/**
+ * @brief Get an id of the calling thread, unique among running threads.
+ */
+uint64_t sn_thread_current_id(void);
@@ -0,0 +1,118 @@
+#include "snmemory/vm_arena.h"
+
+#include "snmemory/vm.h"
+
+static void *allocate_fenced(SnVmArena *arena, uint64_t size, uint64_t align, uint64_t page_size);
+
+static uint8_t *commit_span(SnVmArena *arena, uint8_t *start, uint64_t size);
+
+bool sn_vm_arena_init(
+    SnVmArena *arena, uint64_t reserve_size, uint64_t chunk_size, uint32_t flags, uint64_t fence_threshold) {
+    if (!arena || !reserve_size || !chunk_size) return false;
+
+    uint64_t page_size = sn_vm_get_page_size();
+    reserve_size = SN_GET_ALIGNED(reserve_size, page_size);
+    chunk_size = SN_GET_ALIGNED(chunk_size, page_size);
+    if (chunk_size > reserve_size) return false;
+
+    // One more page that is never committed guards the end
+    uint8_t *base = sn_vm_reserve_range(NULL, reserve_size + page_size);
+    if (!base) return false;
+
+    if (!sn_vm_commit_range(base, chunk_size, SN_VM_FLAG_NONE)) {
+        sn_vm_release_range(base, reserve_size + page_size);
+        return false;
+    }
+
+    *arena = (SnVmArena){
+        .base = base,
+        .end = base + reserve_size,
+        .top = base,
+        .chunk_end = base + chunk_size,
+        .high_water = base + chunk_size,
+        .chunk_size = chunk_size,
+        .fence_threshold = fence_threshold ? fence_threshold : UINT64_MAX,
+        .committed_size = chunk_size,
+        .flags = flags,
+    };
+
+    return true;
+}
+
+void sn_vm_arena_deinit(SnVmArena *arena) {
+    if (!arena || !arena->base) return;
+
+    sn_vm_release_range(arena->base, SN_PTR_DIFF(arena->end, arena->base) + sn_vm_get_page_size());
+    *arena = (SnVmArena){0};
+}
+
+void *sn_vm_arena_allocate_slow(SnVmArena *arena, uint64_t size, uint64_t align) {
+    if (!arena || !arena->base || !size || !align) return NULL;
+
+    uint64_t page_size = sn_vm_get_page_size();
+    if (size >= arena->fence_threshold) return allocate_fenced(arena, size, align, page_size);
+
+    uint8_t *aligned = (uint8_t *)SN_GET_ALIGNED(arena->top, align);
+
+    // Without guard pages the current chunk grows in place while it is the last one
+    if (!(arena->flags & SN_VM_ARENA_FLAG_GUARD_PAGES) && arena->chunk_end == arena->high_water) {
+        if (aligned > arena->end || size > SN_PTR_DIFF(arena->end, aligned)) return NULL;
+
+        uint64_t grow_size = SN_GET_ALIGNED(SN_PTR_DIFF(aligned + size, arena->chunk_end), page_size);
+        grow_size = SN_MIN(SN_MAX(grow_size, arena->chunk_size), SN_PTR_DIFF(arena->end, arena->chunk_end));
+        if (!commit_span(arena, arena->chunk_end, grow_size)) return NULL;
+
+        arena->chunk_end += grow_size;
+        arena->top = aligned + size;
+        return aligned;
+    }
+
+    // Start a new chunk past the guard page of the last one, the rest of the current chunk is left unused
+    uint64_t padding = align > page_size ? align - page_size : 0;
+    uint64_t span = SN_MAX(arena->chunk_size, SN_GET_ALIGNED(size + padding, page_size));
+
+    uint8_t *start = commit_span(arena, arena->high_water + page_size, span);
+    if (!start) return NULL;
+
+    aligned = (uint8_t *)SN_GET_ALIGNED(start, align);
+    arena->chunk_end = start + span;
+    arena->top = aligned + size;
+
+    return aligned;
+}
+
+void sn_vm_arena_reset(SnVmArena *arena) {
+    if (!arena || !arena->base) return;
+
+    uint8_t *first_end = arena->base + arena->chunk_size;
+    if (arena->high_water > first_end) sn_vm_decommit_range(first_end, SN_PTR_DIFF(arena->high_water, first_end));
+
+    arena->top = arena->base;
+    arena->chunk_end = first_end;
+    arena->high_water = first_end;
+    arena->committed_size = arena->chunk_size;
+}
+
+static void *allocate_fenced(SnVmArena *arena, uint64_t size, uint64_t align, uint64_t page_size) {
+    if (size > UINT64_MAX - align) return NULL;
+
+    // Own pages past a guard page, the allocation ends at the next one
+    uint64_t span = SN_GET_ALIGNED(size + align - 1, page_size);
+
+    uint8_t *start = commit_span(arena, arena->high_water + page_size, span);
+    if (!start) return NULL;
+
+    uint8_t *end = start + span;
+    return (void *)((uint64_t)(end - size) & ~(align - 1));
+}
+
+// Commits a span past the high water mark and moves the mark to its end
+static uint8_t *commit_span(SnVmArena *arena, uint8_t *start, uint64_t size) {
+    if (start > arena->end || size > SN_PTR_DIFF(arena->end, start)) return NULL;
+    if (!sn_vm_commit_range(start, size, SN_VM_FLAG_NONE)) return NULL;
+
+    arena->high_water = start + size;
+    arena->committed_size += size;
+
+    return start;
+}
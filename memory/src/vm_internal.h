@@ -0,0 +1,16 @@
+#pragma once
+
+#include <sncore/defines.h>
+
+/**
+ * @brief Apply and drop queued lazy decommits overlapping the range.
+ *
+ * Called before a range is committed or released so that a late
+ * decommit from the background thread can never hit live memory.
+ * Waits only if the background thread is applying an overlapping
+ * decommit, queued ones are applied on the calling thread.
+ *
+ * @param ptr Start of the range.
+ * @param size Size of the range in bytes.
+ */
+void sn_vm_lazy_decommit_resolve(void *ptr, uint64_t size);
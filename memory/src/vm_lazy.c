@@ -0,0 +1,192 @@
+#include "snmemory/vm.h"
+
+#include "src/atomics.h"
+#include "src/thread.h"
+#include "src/vm_internal.h"
+
+#include <string.h>
+
+typedef struct SnPendingDecommit {
+    uint8_t *ptr;
+    uint64_t size;
+} SnPendingDecommit;
+
+static struct {
+    SnMutex mutex;
+    SnCondition condition;
+    SnCondition applied;
+    SnThread thread;
+
+    bool initialized;
+    bool stop;
+    uint64_t running;
+
+    uint32_t count;
+    SnPendingDecommit pending[SN_VM_LAZY_DECOMMIT_CAPACITY];
+
+    // Batch being applied without the lock, only its applier writes it
+    uint32_t in_flight_count;
+    SnPendingDecommit in_flight[SN_VM_LAZY_DECOMMIT_CAPACITY];
+} lazy;
+
+static void apply_pending(void);
+
+static bool overlaps(const SnPendingDecommit *pending, uint8_t *begin, uint8_t *end);
+
+static bool overlaps_in_flight(uint8_t *begin, uint8_t *end);
+
+static void worker(void *arg);
+
+bool sn_vm_lazy_decommit_start(void) {
+    if (sn_atomic_load_u64(&lazy.running)) return true;
+
+    // The mutex is never destroyed, commit and release may check the queue
+    // from any thread at any time.
+    if (!lazy.initialized) {
+        if (!sn_mutex_init(&lazy.mutex)) return false;
+        if (!sn_condition_init(&lazy.condition)) {
+            sn_mutex_deinit(&lazy.mutex);
+            return false;
+        }
+        if (!sn_condition_init(&lazy.applied)) {
+            sn_condition_deinit(&lazy.condition);
+            sn_mutex_deinit(&lazy.mutex);
+            return false;
+        }
+        lazy.initialized = true;
+    }
+
+    lazy.stop = false;
+    lazy.count = 0;
+    lazy.in_flight_count = 0;
+
+    sn_atomic_store_u64(&lazy.running, 1);
+    if (sn_thread_create(&lazy.thread, worker, NULL)) return true;
+
+    sn_atomic_store_u64(&lazy.running, 0);
+    return false;
+}
+
+void sn_vm_lazy_decommit_stop(void) {
+    if (!sn_atomic_load_u64(&lazy.running)) return;
+
+    sn_mutex_lock(&lazy.mutex);
+    lazy.stop = true;
+    sn_condition_signal(&lazy.condition);
+    sn_mutex_unlock(&lazy.mutex);
+
+    sn_thread_join(&lazy.thread);
+
+    // Anything queued after the worker exited
+    sn_mutex_lock(&lazy.mutex);
+    apply_pending();
+    sn_atomic_store_u64(&lazy.running, 0);
+    sn_mutex_unlock(&lazy.mutex);
+}
+
+bool sn_vm_decommit_lazy(void *ptr, uint32_t pages) {
+    if (!ptr || !pages) return false;
+
+    if (!sn_atomic_load_u64(&lazy.running)) return sn_vm_decommit(ptr, pages);
+
+    sn_mutex_lock(&lazy.mutex);
+
+    if (!sn_atomic_load_u64(&lazy.running) || lazy.count == SN_VM_LAZY_DECOMMIT_CAPACITY) {
+        sn_condition_signal(&lazy.condition);
+        sn_mutex_unlock(&lazy.mutex);
+        return sn_vm_decommit(ptr, pages);
+    }
+
+    uint64_t size = (uint64_t)pages * sn_vm_get_page_size();
+    lazy.pending[lazy.count++] = (SnPendingDecommit){.ptr = ptr, .size = size};
+    if (lazy.count >= SN_VM_LAZY_DECOMMIT_BATCH) sn_condition_signal(&lazy.condition);
+
+    sn_mutex_unlock(&lazy.mutex);
+
+    return true;
+}
+
+void sn_vm_lazy_decommit_flush(void) {
+    if (!sn_atomic_load_u64(&lazy.running)) return;
+
+    sn_mutex_lock(&lazy.mutex);
+    apply_pending();
+    sn_mutex_unlock(&lazy.mutex);
+}
+
+void sn_vm_lazy_decommit_resolve(void *ptr, uint64_t size) {
+    if (!sn_atomic_load_u64(&lazy.running)) return;
+
+    uint8_t *begin = (uint8_t *)ptr;
+    uint8_t *end = begin + size;
+
+    sn_mutex_lock(&lazy.mutex);
+
+    for (;;) {
+        // Only a batch touching this range is waited for, unrelated ones keep running
+        if (overlaps_in_flight(begin, end)) {
+            sn_condition_wait(&lazy.applied, &lazy.mutex, SN_VM_LAZY_DECOMMIT_INTERVAL_MS);
+            continue;
+        }
+
+        uint32_t i = 0;
+        while (i < lazy.count && !overlaps(&lazy.pending[i], begin, end)) i++;
+        if (i == lazy.count) break;
+
+        SnPendingDecommit pending = lazy.pending[i];
+        lazy.pending[i] = lazy.pending[--lazy.count];
+
+        // The caller owns the range, decommit it here without holding up the queue
+        sn_mutex_unlock(&lazy.mutex);
+        sn_vm_decommit_range(pending.ptr, pending.size);
+        sn_mutex_lock(&lazy.mutex);
+    }
+
+    sn_mutex_unlock(&lazy.mutex);
+}
+
+static bool overlaps(const SnPendingDecommit *pending, uint8_t *begin, uint8_t *end) {
+    return pending->ptr < end && pending->ptr + pending->size > begin;
+}
+
+static bool overlaps_in_flight(uint8_t *begin, uint8_t *end) {
+    for (uint32_t i = 0; i < lazy.in_flight_count; ++i) {
+        if (overlaps(&lazy.in_flight[i], begin, end)) return true;
+    }
+    return false;
+}
+
+// Called with the lock held, the lock is dropped while the syscalls run
+static void apply_pending(void) {
+    // One batch at a time, a flush also waits for the one the worker is applying
+    while (lazy.in_flight_count)
+        sn_condition_wait(&lazy.applied, &lazy.mutex, SN_VM_LAZY_DECOMMIT_INTERVAL_MS);
+    if (!lazy.count) return;
+
+    memcpy(lazy.in_flight, lazy.pending, sizeof(SnPendingDecommit) * lazy.count);
+    lazy.in_flight_count = lazy.count;
+    lazy.count = 0;
+
+    sn_mutex_unlock(&lazy.mutex);
+    for (uint32_t i = 0; i < lazy.in_flight_count; ++i)
+        sn_vm_decommit_range(lazy.in_flight[i].ptr, lazy.in_flight[i].size);
+    sn_mutex_lock(&lazy.mutex);
+
+    lazy.in_flight_count = 0;
+    sn_condition_broadcast(&lazy.applied);
+}
+
+static void worker(void *arg) {
+    SN_UNUSED(arg);
+
+    // Commit and release wait for the in-flight batch only if they overlap it,
+    // so a late decommit can never hit memory that was handed out again.
+    sn_mutex_lock(&lazy.mutex);
+    while (!lazy.stop) {
+        if (lazy.count < SN_VM_LAZY_DECOMMIT_BATCH)
+            sn_condition_wait(&lazy.condition, &lazy.mutex, SN_VM_LAZY_DECOMMIT_INTERVAL_MS);
+        apply_pending();
+    }
+    apply_pending();
+    sn_mutex_unlock(&lazy.mutex);
+}
@@ -0,0 +1,33 @@
+#include "src/cpu.h"
+
+#if defined(SN_OS_WINDOWS)
+
+    #include <windows.h>
+
+uint32_t sn_cpu_count(void) {
+    DWORD count = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    return count > 0 ? (uint32_t)count : 1;
+}
+
+uint64_t sn_cpu_cache_line_size(void) {
+    // Enough entries for every cache of large machines, more fall back to the default
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION info[128];
+    DWORD length = sizeof(info);
+    if (!GetLogicalProcessorInformation(info, &length)) return SN_CPU_DEFAULT_CACHE_LINE_SIZE;
+
+    for (DWORD i = 0; i < length / sizeof(info[0]); ++i) {
+        if (info[i].Relationship == RelationCache && info[i].Cache.Level == 1
+            && (info[i].Cache.Type == CacheData || info[i].Cache.Type == CacheUnified))
+            return info[i].Cache.LineSize;
+    }
+
+    return SN_CPU_DEFAULT_CACHE_LINE_SIZE;
+}
+
+uint32_t sn_cpu_current(void) {
+    PROCESSOR_NUMBER number;
+    GetCurrentProcessorNumberEx(&number);
+    return (uint32_t)number.Group * 64 + number.Number;
+}
+
+#endif
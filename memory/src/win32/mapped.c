@@ -0,0 +1,122 @@
+#include "snmemory/mapped.h"
+
+#if defined(SN_OS_WINDOWS)
+
+    #include <windows.h>
+
+    #include "snmemory/vm.h"
+
+static bool get_page_range(SnMappedFile *file, void **ptr, uint64_t *size);
+
+bool sn_mapped_file_open(SnMappedFile *file, const char *path, uint64_t size, uint32_t flags, void *address) {
+    if (!file || !path) return false;
+
+    bool read_only = flags & SN_MAPPED_FILE_FLAG_READ_ONLY;
+    bool private = flags & SN_MAPPED_FILE_FLAG_PRIVATE;
+
+    DWORD access = read_only ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE;
+    DWORD creation = (flags & SN_MAPPED_FILE_FLAG_CREATE) ? OPEN_ALWAYS : OPEN_EXISTING;
+
+    HANDLE handle = CreateFileA(path, access, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, creation,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(handle, &file_size)) goto fail;
+
+    if (!size) size = (uint64_t)file_size.QuadPart;
+    if (!size) goto fail;
+
+    if ((uint64_t)file_size.QuadPart < size) {
+        if (read_only) goto fail;
+
+        LARGE_INTEGER end = {.QuadPart = (LONGLONG)size};
+        if (!SetFilePointerEx(handle, end, NULL, FILE_BEGIN) || !SetEndOfFile(handle)) goto fail;
+    }
+
+    // Copy on write views need a read-only or write-copy mapping
+    DWORD protect = read_only || private ? PAGE_READONLY : PAGE_READWRITE;
+    if (private && !read_only) protect = PAGE_WRITECOPY;
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, protect, (DWORD)(size >> 32), (DWORD)size, NULL);
+    if (!mapping) goto fail;
+
+    DWORD view_access = read_only ? FILE_MAP_READ : private ? FILE_MAP_COPY : FILE_MAP_WRITE;
+
+    // Unlike mmap, a taken address fails instead of being a hint
+    void *base = MapViewOfFileEx(mapping, view_access, 0, 0, (SIZE_T)size, address);
+    if (!base && address) base = MapViewOfFileEx(mapping, view_access, 0, 0, (SIZE_T)size, NULL);
+    if (!base) {
+        CloseHandle(mapping);
+        goto fail;
+    }
+
+    *file = (SnMappedFile){
+        .base = base,
+        .size = size,
+        .file = (intptr_t)handle,
+        .mapping = (intptr_t)mapping,
+        .flags = flags,
+    };
+
+    return true;
+
+fail:
+    CloseHandle(handle);
+    return false;
+}
+
+void sn_mapped_file_close(SnMappedFile *file) {
+    if (!file || !file->base) return;
+
+    UnmapViewOfFile(file->base);
+    CloseHandle((HANDLE)file->mapping);
+    CloseHandle((HANDLE)file->file);
+
+    *file = (SnMappedFile){0};
+}
+
+bool sn_mapped_file_sync(SnMappedFile *file, void *ptr, uint64_t size, bool wait) {
+    if (!get_page_range(file, &ptr, &size)) return false;
+    if (!FlushViewOfFile(ptr, (SIZE_T)size)) return false;
+
+    // FlushViewOfFile only starts the writes, the file flush waits for them
+    return !wait || FlushFileBuffers((HANDLE)file->file);
+}
+
+bool sn_mapped_file_advise(SnMappedFile *file, void *ptr, uint64_t size, SnMappedFileAdvice advice) {
+    if (!get_page_range(file, &ptr, &size)) return false;
+
+    switch (advice) {
+        case SN_MAPPED_FILE_ADVICE_WILLNEED: {
+    #if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+            WIN32_MEMORY_RANGE_ENTRY range = {.VirtualAddress = ptr, .NumberOfBytes = (SIZE_T)size};
+            return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    #else
+            return true;
+    #endif
+        }
+        case SN_MAPPED_FILE_ADVICE_DONTNEED:
+            // Unlocking pages that are not locked drops them from the working set
+            VirtualUnlock(ptr, (SIZE_T)size);
+            return true;
+        case SN_MAPPED_FILE_ADVICE_NORMAL:
+        case SN_MAPPED_FILE_ADVICE_SEQUENTIAL:
+        case SN_MAPPED_FILE_ADVICE_RANDOM:
+        default:
+            return true;
+    }
+}
+
+static bool get_page_range(SnMappedFile *file, void **ptr, uint64_t *size) {
+    if (!file || !file->base || !sn_mapped_file_owns(file, *ptr)) return false;
+
+    uint8_t *start = (uint8_t *)((uintptr_t)*ptr & ~(sn_vm_get_page_size() - 1));
+    uint8_t *end = SN_MIN(((uint8_t *)*ptr) + *size, ((uint8_t *)file->base) + file->size);
+
+    *ptr = start;
+    *size = SN_PTR_DIFF(end, start);
+    return true;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#include "src/shm_internal.h"
+
+#if defined(SN_OS_WINDOWS)
+
+    #include <windows.h>
+
+void *sn_shm_map(const char *name, uint64_t *size, bool create, intptr_t *handle) {
+    HANDLE mapping;
+    if (create) {
+        // Page file backed, zero filled
+        mapping = CreateFileMappingA(
+            INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(*size >> 32), (DWORD)*size, name);
+        if (mapping && GetLastError() == ERROR_ALREADY_EXISTS) {
+            CloseHandle(mapping);
+            return NULL;
+        }
+    } else {
+        mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+    }
+
+    if (!mapping) return NULL;
+
+    void *ptr = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, create ? (SIZE_T)*size : 0);
+    if (!ptr) {
+        CloseHandle(mapping);
+        return NULL;
+    }
+
+    if (!create) {
+        MEMORY_BASIC_INFORMATION info;
+        if (!VirtualQuery(ptr, &info, sizeof(info))) {
+            UnmapViewOfFile(ptr);
+            CloseHandle(mapping);
+            return NULL;
+        }
+        *size = info.RegionSize;
+    }
+
+    *handle = (intptr_t)mapping;
+    return ptr;
+}
+
+void sn_shm_unmap(void *ptr, uint64_t size, intptr_t handle) {
+    (void)size;
+    UnmapViewOfFile(ptr);
+    CloseHandle((HANDLE)handle);
+}
+
+void sn_shm_unlink(const char *name) {
+    // Named mappings go away with their last handle
+    (void)name;
+}
+
+void sn_shm_wait(volatile uint32_t *word, uint32_t value, uint32_t timeout_ms) {
+    // WaitOnAddress does not work across processes, poll in short sleeps
+    if (*word != value || !timeout_ms) return;
+    Sleep(1);
+}
+
+void sn_shm_wake(volatile uint32_t *word) {
+    (void)word;
+}
+
+#endif
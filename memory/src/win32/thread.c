@@ -0,0 +1,73 @@
+#include "src/thread.h"
+
+#if defined(SN_OS_WINDOWS)
+
+bool sn_mutex_init(SnMutex *mutex) {
+    InitializeSRWLock(mutex);
+    return true;
+}
+
+void sn_mutex_deinit(SnMutex *mutex) {
+    SN_UNUSED(mutex);
+}
+
+void sn_mutex_lock(SnMutex *mutex) {
+    AcquireSRWLockExclusive(mutex);
+}
+
+bool sn_mutex_try_lock(SnMutex *mutex) {
+    return TryAcquireSRWLockExclusive(mutex);
+}
+
+void sn_mutex_unlock(SnMutex *mutex) {
+    ReleaseSRWLockExclusive(mutex);
+}
+
+bool sn_condition_init(SnCondition *condition) {
+    InitializeConditionVariable(condition);
+    return true;
+}
+
+void sn_condition_deinit(SnCondition *condition) {
+    SN_UNUSED(condition);
+}
+
+void sn_condition_signal(SnCondition *condition) {
+    WakeConditionVariable(condition);
+}
+
+void sn_condition_broadcast(SnCondition *condition) {
+    WakeAllConditionVariable(condition);
+}
+
+void sn_condition_wait(SnCondition *condition, SnMutex *mutex, uint32_t timeout_ms) {
+    SleepConditionVariableSRW(condition, mutex, timeout_ms, 0);
+}
+
+static DWORD WINAPI thread_entry(LPVOID arg) {
+    SnThread *thread = (SnThread *)arg;
+    thread->fn(thread->arg);
+    return 0;
+}
+
+bool sn_thread_create(SnThread *thread, SnThreadFn fn, void *arg) {
+    thread->fn = fn;
+    thread->arg = arg;
+    thread->handle = CreateThread(NULL, 0, thread_entry, thread, 0, NULL);
+    return thread->handle != NULL;
+}
+
+void sn_thread_join(SnThread *thread) {
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+void sn_thread_yield(void) {
+    SwitchToThread();
+}
+
+uint64_t sn_thread_current_id(void) {
+    return GetCurrentThreadId();
+}
+
+#endif
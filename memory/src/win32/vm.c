@@ -2,24 +2,115 @@
 
 #if defined(SN_OS_WINDOWS)
 
+    #include <string.h>
     #include <windows.h>
 
+    #include "src/vm_internal.h"
+
+static void *reserve_aligned(void *address, uint64_t size, uint64_t align);
+
 void *sn_vm_reserve(void *address, uint32_t pages) {
-    return VirtualAlloc(address, pages * sn_vm_get_page_size(), MEM_RESERVE, PAGE_NOACCESS);
+    return sn_vm_reserve_range(address, (uint64_t)pages * sn_vm_get_page_size());
 }
 
 bool sn_vm_commit(void *ptr, uint32_t pages) {
-    return VirtualAlloc(ptr, pages * sn_vm_get_page_size(), MEM_COMMIT, PAGE_READWRITE) != NULL;
+    return sn_vm_commit_range(ptr, (uint64_t)pages * sn_vm_get_page_size(), SN_VM_FLAG_NONE);
 }
 
 bool sn_vm_decommit(void *ptr, uint32_t pages) {
-    return VirtualFree(ptr, pages * sn_vm_get_page_size(), MEM_DECOMMIT);
+    return sn_vm_decommit_range(ptr, (uint64_t)pages * sn_vm_get_page_size());
+}
+
+bool sn_vm_discard(void *ptr, uint32_t pages) {
+    return VirtualAlloc(ptr, (uint64_t)pages * sn_vm_get_page_size(), MEM_RESET, PAGE_READWRITE) != NULL;
 }
 
 bool sn_vm_release(void *ptr, uint32_t pages) {
+    return sn_vm_release_range(ptr, (uint64_t)pages * sn_vm_get_page_size());
+}
+
+void *sn_vm_reserve_range(void *address, uint64_t size) {
+    size = SN_GET_ALIGNED(size, sn_vm_get_page_size());
+    if (!size) return NULL;
+
+    return VirtualAlloc(address, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool sn_vm_commit_range(void *ptr, uint64_t size, uint32_t flags) {
+    size = SN_GET_ALIGNED(size, sn_vm_get_page_size());
+
+    sn_vm_lazy_decommit_resolve(ptr, size);
+    if (!VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE)) return false;
+
+    if (flags & SN_VM_FLAG_PREFAULT) return sn_vm_prefault(ptr, size);
+
+    return true;
+}
+
+bool sn_vm_decommit_range(void *ptr, uint64_t size) {
+    return VirtualFree(ptr, SN_GET_ALIGNED(size, sn_vm_get_page_size()), MEM_DECOMMIT);
+}
+
+bool sn_vm_release_range(void *ptr, uint64_t size) {
+    sn_vm_lazy_decommit_resolve(ptr, SN_GET_ALIGNED(size, sn_vm_get_page_size()));
     return VirtualFree(ptr, 0, MEM_RELEASE);
 }
 
+void *sn_vm_resize(void *ptr, uint64_t old_size, uint64_t new_size) {
+    uint64_t page_size = sn_vm_get_page_size();
+    old_size = SN_GET_ALIGNED(old_size, page_size);
+    new_size = SN_GET_ALIGNED(new_size, page_size);
+    if (!ptr || !old_size || !new_size) return NULL;
+
+    if (new_size == old_size) return ptr;
+
+    sn_vm_lazy_decommit_resolve(ptr, old_size);
+
+    // Regions can't be partially released, the tail stays reserved
+    if (new_size < old_size) {
+        if (!sn_vm_decommit_range(((uint8_t *)ptr) + new_size, old_size - new_size)) return NULL;
+        return ptr;
+    }
+
+    // Commit in place when the region is still reserved past the range,
+    // as it is after shrinking
+    uint8_t *tail = ((uint8_t *)ptr) + old_size;
+    uint64_t grow_size = new_size - old_size;
+
+    MEMORY_BASIC_INFORMATION info;
+    if (VirtualQuery(tail, &info, sizeof(info)) && info.State == MEM_RESERVE && info.AllocationBase == ptr
+        && info.RegionSize >= grow_size) {
+        if (VirtualAlloc(tail, grow_size, MEM_COMMIT, PAGE_READWRITE)) return ptr;
+    }
+
+    void *new_ptr = VirtualAlloc(NULL, new_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!new_ptr) return NULL;
+
+    memcpy(new_ptr, ptr, old_size);
+    sn_vm_release_range(ptr, old_size);
+
+    return new_ptr;
+}
+
+bool sn_vm_prefault(void *ptr, uint64_t size) {
+    if (!ptr || !size) return false;
+
+    uint64_t page_size = sn_vm_get_page_size();
+    volatile uint8_t *bytes = (volatile uint8_t *)ptr;
+    for (uint64_t offset = 0; offset < size; offset += page_size) bytes[offset] = bytes[offset];
+
+    return true;
+}
+
+bool sn_vm_zero_range(void *ptr, uint64_t size) {
+    if (!ptr || !size) return false;
+    size = SN_GET_ALIGNED(size, sn_vm_get_page_size());
+
+    // MEM_RESET keeps the contents, pages committed again are zero filled
+    if (!VirtualFree(ptr, size, MEM_DECOMMIT)) return false;
+    return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
 uint64_t sn_vm_get_page_size(void) {
     static uint64_t page_size = 0;
     if (page_size) return page_size;
@@ -32,4 +123,68 @@ uint64_t sn_vm_get_page_size(void) {
     return page_size;
 }
 
+uint64_t sn_vm_get_large_page_size(void) {
+    static uint64_t large_page_size = 0;
+    if (large_page_size) return large_page_size;
+
+    large_page_size = (uint64_t)GetLargePageMinimum();
+    if (!large_page_size) large_page_size = SN_VM_DEFAULT_LARGE_PAGE_SIZE;
+
+    return large_page_size;
+}
+
+void *sn_vm_reserve_large(void *address, uint32_t pages) {
+    uint64_t size = (uint64_t)pages * sn_vm_get_large_page_size();
+    if (!size) return NULL;
+
+    // Needs SeLockMemoryPrivilege, large pages can't be reserved without commit
+    void *ptr = VirtualAlloc(address, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    if (ptr) return ptr;
+
+    return reserve_aligned(address, size, sn_vm_get_large_page_size());
+}
+
+bool sn_vm_commit_large(void *ptr, uint32_t pages) {
+    uint64_t size = (uint64_t)pages * sn_vm_get_large_page_size();
+
+    sn_vm_lazy_decommit_resolve(ptr, size);
+
+    // Explicit large pages are already committed by sn_vm_reserve_large
+    MEMORY_BASIC_INFORMATION info;
+    if (VirtualQuery(ptr, &info, sizeof(info)) && info.State == MEM_COMMIT && info.RegionSize >= size)
+        return true;
+
+    return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+bool sn_vm_decommit_large(void *ptr, uint32_t pages) {
+    return VirtualFree(ptr, (uint64_t)pages * sn_vm_get_large_page_size(), MEM_DECOMMIT);
+}
+
+bool sn_vm_release_large(void *ptr, uint32_t pages) {
+    sn_vm_lazy_decommit_resolve(ptr, (uint64_t)pages * sn_vm_get_large_page_size());
+    return VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+static void *reserve_aligned(void *address, uint64_t size, uint64_t align) {
+    if (address && SN_IS_ALIGNED(address, align)) {
+        void *ptr = VirtualAlloc(address, size, MEM_RESERVE, PAGE_NOACCESS);
+        if (ptr) return ptr;
+    }
+
+    // Regions can't be partially released, find an aligned spot and reserve
+    // it again. Another thread may take it in between, so retry a few times.
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        uint8_t *ptr = VirtualAlloc(NULL, size + align, MEM_RESERVE, PAGE_NOACCESS);
+        if (!ptr) return NULL;
+
+        VirtualFree(ptr, 0, MEM_RELEASE);
+
+        void *aligned = VirtualAlloc((void *)SN_GET_ALIGNED(ptr, align), size, MEM_RESERVE, PAGE_NOACCESS);
+        if (aligned) return aligned;
+    }
+
+    return NULL;
+}
+
 #endif
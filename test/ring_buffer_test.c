@@ -1,9 +1,23 @@
+// fork and getpid are POSIX
+#if !defined(_DEFAULT_SOURCE)
+    #define _DEFAULT_SOURCE
+#endif
+
 #include <snmemory/snmemory.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+    #include <process.h>
+    #define getpid _getpid
+#else
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
 
 #define TEST_ASSERT(x)                                                                                      \
     do {                                                                                                    \
@@ -230,6 +244,154 @@ static void test_advance_read_wrap(void) {
     TEST_ASSERT(rb.read_offset == 6);
 }
 
+/* Names are unique per process, a crashed run may leave its ring behind */
+static void shared_ring_name(char *name, const char *test) {
+    snprintf(name, SN_SHARED_RING_NAME_MAX, "/sn_%s_%d_%llx", test, (int)getpid(),
+             (unsigned long long)time(NULL));
+}
+
+static void test_shared_ring_open(void) {
+    char name[SN_SHARED_RING_NAME_MAX];
+    shared_ring_name(name, "open");
+
+    SnSharedRing producer, consumer;
+    TEST_ASSERT(!sn_shared_ring_open(&consumer, name));
+    TEST_ASSERT(sn_shared_ring_create(&producer, name, 1000));
+    TEST_ASSERT(!sn_shared_ring_create(&consumer, name, 1000));
+    TEST_ASSERT(sn_shared_ring_open(&consumer, name));
+
+    /* Capacity is rounded up to a power of two, both sides agree on it */
+    TEST_ASSERT(producer.mask == 1023 && consumer.mask == 1023);
+    TEST_ASSERT(sn_shared_ring_get_max_message_size(&producer) == 512 - SN_SHARED_RING_ALIGNMENT);
+    TEST_ASSERT(!sn_shared_ring_reserve(&producer, 512, 0));
+
+    /* Each side has its own mapping of the same memory */
+    TEST_ASSERT(producer.header != consumer.header);
+
+    sn_shared_ring_close(&consumer);
+    sn_shared_ring_close(&producer);
+    TEST_ASSERT(!sn_shared_ring_open(&consumer, name));
+}
+
+static void test_shared_ring_messages(void) {
+    char name[SN_SHARED_RING_NAME_MAX];
+    shared_ring_name(name, "messages");
+
+    SnSharedRing producer, consumer;
+    TEST_ASSERT(sn_shared_ring_create(&producer, name, 256));
+    TEST_ASSERT(sn_shared_ring_open(&consumer, name));
+
+    TEST_ASSERT(!sn_shared_ring_peek(&consumer, NULL, 0));
+    TEST_ASSERT(!sn_shared_ring_peek(&consumer, NULL, 5));
+
+    /* Messages appear only after commit */
+    uint8_t *msg = sn_shared_ring_reserve(&producer, 40, 0);
+    TEST_ASSERT(msg && SN_IS_ALIGNED(msg, SN_SHARED_RING_ALIGNMENT));
+    memset(msg, 0xA1, 40);
+    TEST_ASSERT(!sn_shared_ring_peek(&consumer, NULL, 0));
+    sn_shared_ring_commit(&producer);
+
+    uint64_t size = 0;
+    uint8_t *read = sn_shared_ring_peek(&consumer, &size, 0);
+    TEST_ASSERT(read && size == 40 && read[0] == 0xA1 && read[39] == 0xA1);
+    TEST_ASSERT(sn_shared_ring_peek(&consumer, NULL, 0) == read);
+    sn_shared_ring_release(&consumer);
+    TEST_ASSERT(!sn_shared_ring_peek(&consumer, NULL, 0));
+
+    /* Fill it up, a full ring times out */
+    uint32_t count = 0;
+    while ((msg = sn_shared_ring_reserve(&producer, 48, 0))) {
+        memset(msg, (int)count++, 48);
+        sn_shared_ring_commit(&producer);
+    }
+    TEST_ASSERT(count == 4);
+    TEST_ASSERT(!sn_shared_ring_reserve(&producer, 48, 5));
+
+    /* Messages come out in order, the ones past the end wrap around */
+    for (uint32_t round = 0; round < 20; ++round) {
+        read = sn_shared_ring_peek(&consumer, &size, 0);
+        TEST_ASSERT(read && size == 48 && read[47] == (uint8_t)round);
+        sn_shared_ring_release(&consumer);
+
+        msg = sn_shared_ring_reserve(&producer, 48, 0);
+        TEST_ASSERT(msg);
+        memset(msg, (int)(round + 4), 48);
+        sn_shared_ring_commit(&producer);
+    }
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        TEST_ASSERT(sn_shared_ring_peek(&consumer, NULL, 0));
+        sn_shared_ring_release(&consumer);
+    }
+
+    /* Leave 64 bytes before the end, a larger record pads them and starts over */
+    for (uint32_t i = 0; i < 2; ++i) {
+        TEST_ASSERT(sn_shared_ring_reserve(&producer, 48, 0));
+        sn_shared_ring_commit(&producer);
+        TEST_ASSERT(sn_shared_ring_peek(&consumer, NULL, 0));
+        sn_shared_ring_release(&consumer);
+    }
+
+    msg = sn_shared_ring_reserve(&producer, 100, 0);
+    TEST_ASSERT(msg == producer.data + SN_SHARED_RING_ALIGNMENT);
+    memset(msg, 0x5C, 100);
+    sn_shared_ring_commit(&producer);
+
+    read = sn_shared_ring_peek(&consumer, &size, 0);
+    TEST_ASSERT(read == msg - (uint8_t *)producer.data + consumer.data);
+    TEST_ASSERT(size == 100 && read[99] == 0x5C);
+    sn_shared_ring_release(&consumer);
+
+    sn_shared_ring_close(&consumer);
+    sn_shared_ring_close(&producer);
+}
+
+#if defined(SN_OS_LINUX)
+    #define FORK_MESSAGES 5000
+
+/* Consumer in a child process, a small ring makes both sides sleep on the futex */
+static void test_shared_ring_fork(void) {
+    char name[SN_SHARED_RING_NAME_MAX];
+    shared_ring_name(name, "fork");
+
+    SnSharedRing producer;
+    TEST_ASSERT(sn_shared_ring_create(&producer, name, 256));
+
+    pid_t pid = fork();
+    TEST_ASSERT(pid >= 0);
+
+    if (pid == 0) {
+        SnSharedRing consumer;
+        if (!sn_shared_ring_open(&consumer, name)) _exit(2);
+
+        for (uint32_t i = 0; i < FORK_MESSAGES; ++i) {
+            uint64_t size;
+            uint32_t *msg = sn_shared_ring_peek(&consumer, &size, SN_SHARED_RING_WAIT_FOREVER);
+            if (!msg || size != sizeof(uint32_t) * (1 + i % 16) || msg[0] != i || msg[i % 16] != i) _exit(3);
+            sn_shared_ring_release(&consumer);
+        }
+
+        bool empty = !sn_shared_ring_peek(&consumer, NULL, 0);
+        sn_shared_ring_close(&consumer);
+        _exit(empty ? 0 : 4);
+    }
+
+    for (uint32_t i = 0; i < FORK_MESSAGES; ++i) {
+        uint32_t words = 1 + i % 16;
+        uint64_t size = sizeof(uint32_t) * words;
+        uint32_t *msg = sn_shared_ring_reserve(&producer, size, SN_SHARED_RING_WAIT_FOREVER);
+        TEST_ASSERT(msg);
+        for (uint32_t j = 0; j < words; ++j) msg[j] = i;
+        sn_shared_ring_commit(&producer);
+    }
+
+    int status;
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid);
+    TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    sn_shared_ring_close(&producer);
+}
+#endif
+
 int main(void) {
     printf("SnRingBufferAllocator tests:\n");
 
@@ -247,6 +409,11 @@ int main(void) {
     RUN_TEST(test_alloc_after_read_wrap);
     RUN_TEST(test_alloc_full);
     RUN_TEST(test_advance_read_wrap);
+    RUN_TEST(test_shared_ring_open);
+    RUN_TEST(test_shared_ring_messages);
+#if defined(SN_OS_LINUX)
+    RUN_TEST(test_shared_ring_fork);
+#endif
 
     printf("\n%d/%d tests passed\n", tests_passed, tests_run);
     return tests_passed == tests_run ? 0 : 1;
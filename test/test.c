@@ -1,3 +1,8 @@
+// mincore is a BSD extension, fork is POSIX
+#if !defined(_DEFAULT_SOURCE)
+    #define _DEFAULT_SOURCE
+#endif
+
 #include <snmemory/snmemory.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -6,6 +11,13 @@
 #include <string.h>
 #include <time.h>
 
+#if defined(SN_OS_LINUX)
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
 #define TEST_ASSERT(x)                                                                                      \
     do {                                                                                                    \
         if (!(x)) {                                                                                         \
@@ -244,6 +256,89 @@ static void test_linear_allocator_marks(void) {
     TEST_ASSERT(sn_linear_allocator_get_allocated_size(&alloc) == 0);
 }
 
+static bool is_zero(const void *ptr, uint64_t size) {
+    const uint8_t *p = ptr;
+    for (uint64_t i = 0; i < size; i++)
+        if (p[i]) return false;
+    return true;
+}
+
+static void test_linear_allocator_zero_on_reset(void) {
+    uint8_t buffer[KB(4)];
+    SnLinearAllocator alloc;
+
+    /* Zero on reset zeroes dirty memory up front, every allocation is zero */
+    memset(buffer, 0xab, sizeof(buffer));
+    TEST_ASSERT(sn_linear_allocator_init_with_flags(
+        &alloc, buffer, sizeof(buffer), SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET));
+    TEST_ASSERT(is_zero(buffer, sizeof(buffer)));
+
+    uint8_t *a = sn_linear_allocator_allocate(&alloc, 256, 8);
+    snMemoryMark mark = sn_linear_allocator_get_memory_mark(&alloc);
+    uint8_t *b = sn_linear_allocator_allocate(&alloc, 512, 8);
+    TEST_ASSERT(a && b);
+    fill_pattern(a, 256, 1);
+    fill_pattern(b, 512, 2);
+
+    /* Only the memory past the mark is zeroed */
+    sn_linear_allocator_free_to_memory_mark(&alloc, mark);
+    verify_pattern(a, 256, 1);
+    TEST_ASSERT(is_zero(b, 512));
+    TEST_ASSERT(alloc.dirty_end == mark);
+
+    sn_linear_allocator_reset(&alloc);
+    TEST_ASSERT(is_zero(buffer, sizeof(buffer)));
+
+    /* Without the mode only the dirty part of a zeroed allocation is written */
+    memset(buffer, 0, sizeof(buffer));
+    TEST_ASSERT(
+        sn_linear_allocator_init_with_flags(&alloc, buffer, sizeof(buffer), SN_LINEAR_ALLOCATOR_FLAG_ZEROED));
+    a = sn_linear_allocator_allocate(&alloc, 1024, 8);
+    memset(a, 0xcd, 1024);
+    sn_linear_allocator_reset(&alloc);
+    TEST_ASSERT(alloc.dirty_end == buffer + 1024);
+
+    buffer[2048] = 0xcd;
+    a = sn_linear_allocator_allocate_zeroed(&alloc, 2048, 8);
+    TEST_ASSERT(a == buffer && is_zero(a, 1024));
+    TEST_ASSERT(a[2048] == 0xcd);
+
+    /* Unknown memory is always written */
+    memset(buffer, 0xab, sizeof(buffer));
+    TEST_ASSERT(sn_linear_allocator_init(&alloc, buffer, sizeof(buffer)));
+    a = sn_linear_allocator_allocate_zeroed(&alloc, 100, 8);
+    TEST_ASSERT(a && is_zero(a, 100));
+
+    /* Large spans take the streaming path */
+    uint64_t size = KB(512) + 24;
+    uint8_t *large = malloc(size);
+    TEST_ASSERT(large);
+    memset(large, 0xab, size);
+    TEST_ASSERT(sn_linear_allocator_init_with_flags(&alloc, large + 8, size - 8,
+        SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET));
+    TEST_ASSERT(large[7] == 0xab && is_zero(large + 8, size - 8));
+
+    a = sn_linear_allocator_allocate(&alloc, size - 8, 1);
+    TEST_ASSERT(a);
+    memset(a, 0xcd, size - 8);
+    sn_linear_allocator_reset(&alloc);
+    TEST_ASSERT(is_zero(large + 8, size - 8));
+    free(large);
+
+    /* Every frame starts on zeroed memory */
+    SnFrameAllocator frame;
+    memset(buffer, 0xab, sizeof(buffer));
+    TEST_ASSERT(sn_frame_allocator_init_with_flags(&frame, buffer, sizeof(buffer),
+        SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET));
+    for (int i = 0; i < 3; i++) {
+        sn_frame_allocator_begin(&frame);
+        uint8_t *ptr = sn_frame_allocator_allocate_zeroed(&frame, 300, 16);
+        TEST_ASSERT(ptr && is_zero(ptr, 300));
+        memset(ptr, 0xcd, 300);
+        sn_frame_allocator_end(&frame);
+    }
+}
+
 static void test_stack_allocator_lifo(void) {
     uint8_t buffer[2048 + 16];
     SnStackAllocator alloc;
@@ -322,6 +417,426 @@ static void test_pool_allocator_random_free(void) {
     free(ptrs);
 }
 
+static void test_pool_allocator_batch(void) {
+    uint8_t buffer[4096];
+    SnPoolAllocator alloc;
+
+    TEST_ASSERT(sn_pool_allocator_init(&alloc, buffer, sizeof(buffer), 64, 8));
+    uint64_t n = sn_pool_allocator_get_block_count(&alloc);
+
+    void *ptrs[128];
+    TEST_ASSERT(n <= 128);
+
+    uint64_t first = sn_pool_allocator_allocate_batch(&alloc, ptrs, 10);
+    TEST_ASSERT(first == 10);
+    TEST_ASSERT(sn_pool_allocator_get_free_count(&alloc) == n - 10);
+
+    /* Asking for more than available returns what is left */
+    uint64_t rest = sn_pool_allocator_allocate_batch(&alloc, ptrs + first, 128);
+    TEST_ASSERT(first + rest == n);
+    TEST_ASSERT(!sn_pool_allocator_allocate(&alloc));
+
+    /* Blocks are distinct */
+    for (uint64_t i = 0; i < n; i++) fill_pattern(ptrs[i], 64, (uint8_t)i);
+    for (uint64_t i = 0; i < n; i++) verify_pattern(ptrs[i], 64, (uint8_t)i);
+
+    sn_pool_allocator_free_batch(&alloc, ptrs, n / 2);
+    sn_pool_allocator_free_batch(&alloc, ptrs + n / 2, n - n / 2);
+    TEST_ASSERT(sn_pool_allocator_get_free_count(&alloc) == n);
+
+    /* Freed blocks are all reachable again */
+    TEST_ASSERT(sn_pool_allocator_allocate_batch(&alloc, ptrs, n) == n);
+    TEST_ASSERT(!sn_pool_allocator_allocate(&alloc));
+}
+
+static void test_pool_allocator_layout(void) {
+    alignas(256) uint8_t buffer[4096];
+    uint64_t size = sizeof(buffer);
+    SnPoolAllocator alloc;
+    uint64_t line = sn_memory_get_cache_line_size();
+    TEST_ASSERT(line && SN_IS_ALIGNED(line, sizeof(void *)));
+
+    /* Padded blocks start on and fill whole lines */
+    TEST_ASSERT(sn_pool_allocator_init_with_layout(&alloc, buffer, size, 24, 8, SN_POOL_LAYOUT_LINE_PADDED));
+    TEST_ASSERT(alloc.block_size % line == 0);
+    for (void *ptr = sn_pool_allocator_allocate(&alloc); ptr; ptr = sn_pool_allocator_allocate(&alloc))
+        TEST_ASSERT(SN_IS_ALIGNED(ptr, line));
+
+    SnPoolAllocator packed;
+    TEST_ASSERT(sn_pool_allocator_init(&packed, buffer, size, 24, 8));
+    uint64_t n = sn_pool_allocator_get_block_count(&packed);
+
+    /* Interleaved keeps every block, consecutive ones never share a line */
+    TEST_ASSERT(sn_pool_allocator_init_with_layout(&alloc, buffer, size, 24, 8, SN_POOL_LAYOUT_INTERLEAVED));
+    TEST_ASSERT(sn_pool_allocator_get_block_count(&alloc) == n);
+
+    uint8_t *ptrs[256];
+    TEST_ASSERT(n <= 256);
+    TEST_ASSERT(sn_pool_allocator_allocate_batch(&alloc, (void **)ptrs, n) == n);
+    TEST_ASSERT(!sn_pool_allocator_allocate(&alloc));
+
+    uint64_t separated = 0;
+    for (uint64_t i = 1; i < n; i++) {
+        uint64_t last_line = ((uint64_t)ptrs[i - 1] + 23) / line;
+        uint64_t first_line = (uint64_t)ptrs[i] / line;
+        if (ptrs[i] > ptrs[i - 1] && first_line > last_line) separated++;
+    }
+    /* Only the jumps back to the next run start may share a line */
+    TEST_ASSERT(separated >= n - 1 - (line + 46) / 24);
+
+    for (uint64_t i = 0; i < n; i++) fill_pattern(ptrs[i], 24, (uint8_t)i);
+    for (uint64_t i = 0; i < n; i++) verify_pattern(ptrs[i], 24, (uint8_t)i);
+
+    /* Line sized blocks are left in address order */
+    TEST_ASSERT(
+        sn_pool_allocator_init_with_layout(&alloc, buffer, size, line, line, SN_POOL_LAYOUT_INTERLEAVED));
+    uint8_t *a = sn_pool_allocator_allocate(&alloc);
+    uint8_t *b = sn_pool_allocator_allocate(&alloc);
+    TEST_ASSERT(b == a + line);
+}
+
+static void test_freelist_batch(void) {
+    uint8_t buffer[KB(16)];
+    SnFreeListAllocator alloc;
+
+    TEST_ASSERT(sn_freelist_allocator_init(&alloc, buffer, sizeof(buffer)));
+    uint64_t initial_free = sn_freelist_allocator_get_free_size(&alloc);
+
+    void *ptrs[64];
+    uint64_t count = sn_freelist_allocator_allocate_batch(&alloc, ptrs, 64, 48, 16);
+    TEST_ASSERT(count == 64);
+
+    for (uint64_t i = 0; i < count; i++) {
+        TEST_ASSERT(SN_IS_ALIGNED(ptrs[i], 16));
+        fill_pattern(ptrs[i], 48, (uint8_t)i);
+    }
+    for (uint64_t i = 0; i < count; i++) verify_pattern(ptrs[i], 48, (uint8_t)i);
+
+    /* Free every other block one by one to leave holes, then batch the rest in random order */
+    void *rest[32];
+    uint64_t rest_count = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        if (i % 2) sn_freelist_allocator_free(&alloc, ptrs[i]);
+        else rest[rest_count++] = ptrs[i];
+    }
+
+    for (uint64_t i = 0; i < rest_count; i++) {
+        uint64_t j = rand_range(0, rest_count - 1);
+        void *tmp = rest[i];
+        rest[i] = rest[j];
+        rest[j] = tmp;
+    }
+
+    sn_freelist_allocator_free_batch(&alloc, rest, rest_count);
+
+    /* Everything coalesced back into one node */
+    TEST_ASSERT(alloc.free_list && !alloc.free_list->next);
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&alloc) == initial_free);
+
+    /* Batch allocation skips holes too small and continues from where it stopped */
+    count = sn_freelist_allocator_allocate_batch(&alloc, ptrs, 64, 32, 8);
+    TEST_ASSERT(count == 64);
+    for (uint64_t i = 0; i < count; i += 2) sn_freelist_allocator_free(&alloc, ptrs[i]);
+
+    void *big[8];
+    uint64_t big_count = sn_freelist_allocator_allocate_batch(&alloc, big, 8, 256, 8);
+    TEST_ASSERT(big_count == 8);
+    for (uint64_t i = 0; i < big_count; i++) TEST_ASSERT((uint8_t *)big[i] > (uint8_t *)ptrs[63]);
+
+    /* Exhaustion returns a partial count */
+    void *huge[8];
+    uint64_t huge_count = sn_freelist_allocator_allocate_batch(&alloc, huge, 8, KB(4), 8);
+    TEST_ASSERT(huge_count < 8);
+
+    for (uint64_t i = 1; i < count; i += 2) ptrs[i / 2] = ptrs[i];
+    sn_freelist_allocator_free_batch(&alloc, ptrs, count / 2);
+    sn_freelist_allocator_free_batch(&alloc, big, big_count);
+    sn_freelist_allocator_free_batch(&alloc, huge, huge_count);
+
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&alloc) == initial_free);
+}
+
+static bool freelist_rover_on_list(SnFreeListAllocator *alloc) {
+    if (!alloc->rover) return true;
+    for (SnFreeNode *node = alloc->free_list; node; node = node->next)
+        if (node == alloc->rover) return true;
+    return false;
+}
+
+static void test_freelist_policies(void) {
+    uint8_t buffer[KB(16)];
+    SnFreeListAllocator alloc;
+
+    for (int policy = SN_FREELIST_FIRST_FIT; policy <= SN_FREELIST_BEST_FIT; policy++) {
+        TEST_ASSERT(sn_freelist_allocator_init_with_policy(&alloc, buffer, sizeof(buffer), policy));
+        uint64_t initial_free = sn_freelist_allocator_get_free_size(&alloc);
+
+        /* Holes of 256, 64 and 128 bytes kept apart by live blocks */
+        const uint64_t hole_sizes[3] = {256, 64, 128};
+        void *holes[3], *fences[3];
+        for (int i = 0; i < 3; i++) {
+            holes[i] = sn_freelist_allocator_allocate(&alloc, hole_sizes[i], 8);
+            fences[i] = sn_freelist_allocator_allocate(&alloc, 16, 8);
+            TEST_ASSERT(holes[i] && fences[i]);
+        }
+        for (int i = 0; i < 3; i++) sn_freelist_allocator_free(&alloc, holes[i]);
+
+        // Only one hole fits each of these, the rover ends up past the last one
+        void *x = sn_freelist_allocator_allocate(&alloc, 256, 8);
+        void *y = sn_freelist_allocator_allocate(&alloc, 120, 8);
+        TEST_ASSERT(x == holes[0] && y == holes[2]);
+        sn_freelist_allocator_free(&alloc, x);
+
+        void *z = sn_freelist_allocator_allocate(&alloc, 16, 8);
+        switch (policy) {
+            case SN_FREELIST_FIRST_FIT: TEST_ASSERT(z == holes[0]); break;
+            case SN_FREELIST_NEXT_FIT: TEST_ASSERT((uint8_t *)z > (uint8_t *)fences[2]); break;
+            case SN_FREELIST_BEST_FIT: TEST_ASSERT(z == holes[1]); break;
+        }
+        TEST_ASSERT(sn_freelist_allocator_get_scanned_nodes(&alloc, true) > 0);
+
+        sn_freelist_allocator_free(&alloc, z);
+        sn_freelist_allocator_free(&alloc, y);
+        for (int i = 0; i < 3; i++) sn_freelist_allocator_free(&alloc, fences[i]);
+
+        /* Random traffic keeps the rover on the list through merges and reallocations */
+        void *ptrs[48] = {0};
+        uint64_t sizes[48] = {0};
+        for (int i = 0; i < 2000; i++) {
+            int slot = (int)rand_range(0, 47);
+            if (!ptrs[slot]) {
+                sizes[slot] = rand_range(1, 384);
+                ptrs[slot] = sn_freelist_allocator_allocate(&alloc, sizes[slot], 1ULL << rand_range(0, 5));
+            } else if (rand() % 3 == 0) {
+                verify_pattern(ptrs[slot], sizes[slot], (uint8_t)slot);
+                uint64_t new_size = rand_range(1, 384);
+                void *p = sn_freelist_allocator_reallocate(&alloc, ptrs[slot], new_size, 8);
+                if (p) {
+                    ptrs[slot] = p;
+                    sizes[slot] = new_size;
+                }
+            } else {
+                verify_pattern(ptrs[slot], sizes[slot], (uint8_t)slot);
+                sn_freelist_allocator_free(&alloc, ptrs[slot]);
+                ptrs[slot] = NULL;
+            }
+
+            if (ptrs[slot]) fill_pattern(ptrs[slot], sizes[slot], (uint8_t)slot);
+            TEST_ASSERT(freelist_rover_on_list(&alloc));
+        }
+
+        sn_freelist_allocator_free_batch(&alloc, ptrs, 48);
+        TEST_ASSERT(freelist_rover_on_list(&alloc));
+
+        // Every policy keeps the list address ordered, so everything coalesces back
+        TEST_ASSERT(sn_freelist_allocator_get_free_size(&alloc) == initial_free);
+        TEST_ASSERT(sn_freelist_allocator_get_largest_free_size(&alloc) == initial_free);
+    }
+}
+
+static void test_freelist_batch_best_fit(void) {
+    uint8_t buffer[KB(16)];
+    SnFreeListAllocator alloc;
+
+    TEST_ASSERT(sn_freelist_allocator_init_with_policy(&alloc, buffer, sizeof(buffer), SN_FREELIST_BEST_FIT));
+
+    /* Holes of 256, 64 and 128 bytes kept apart by live blocks */
+    const uint64_t hole_sizes[3] = {256, 64, 128};
+    void *holes[3], *fences[3];
+    for (int i = 0; i < 3; i++) {
+        holes[i] = sn_freelist_allocator_allocate(&alloc, hole_sizes[i], 8);
+        fences[i] = sn_freelist_allocator_allocate(&alloc, 16, 8);
+        TEST_ASSERT(holes[i] && fences[i]);
+    }
+    for (int i = 0; i < 3; i++) sn_freelist_allocator_free(&alloc, holes[i]);
+
+    /* Batch blocks take the tightest hole first, first fit would start at the 256 byte one */
+    void *ptrs[2];
+    TEST_ASSERT(sn_freelist_allocator_allocate_batch(&alloc, ptrs, 2, 120, 8) == 2);
+    TEST_ASSERT(ptrs[0] == holes[2]);
+    TEST_ASSERT(ptrs[1] == holes[0]);
+
+    sn_freelist_allocator_free_batch(&alloc, ptrs, 2);
+    for (int i = 0; i < 3; i++) sn_freelist_allocator_free(&alloc, fences[i]);
+}
+static void test_freelist_compact(void) {
+    uint8_t buffer[KB(16)];
+    SnFreeListAllocator alloc;
+
+    /* 16 byte blocks at 16 byte alignment take 32 instead of 48 bytes */
+    uint64_t counts[2] = {0};
+    SnFreeListPolicy policy = SN_FREELIST_FIRST_FIT;
+    for (int compact = 0; compact < 2; compact++) {
+        if (compact) TEST_ASSERT(sn_freelist_allocator_init_compact(&alloc, buffer, sizeof(buffer), policy));
+        else TEST_ASSERT(sn_freelist_allocator_init_with_policy(&alloc, buffer, sizeof(buffer), policy));
+
+        void *p;
+        while ((p = sn_freelist_allocator_allocate(&alloc, 16, 16))) {
+            TEST_ASSERT(SN_IS_ALIGNED(p, 16));
+            counts[compact]++;
+        }
+    }
+    TEST_ASSERT(counts[1] * 5 >= counts[0] * 7);
+
+    TEST_ASSERT(sn_freelist_allocator_init_compact(&alloc, buffer, sizeof(buffer), SN_FREELIST_BEST_FIT));
+    uint64_t initial_free = sn_freelist_allocator_get_free_size(&alloc);
+
+    /* Padding for a large alignment goes back to the free list */
+    void *big_align = sn_freelist_allocator_allocate(&alloc, 8, 256);
+    TEST_ASSERT(big_align && SN_IS_ALIGNED(big_align, 256));
+    TEST_ASSERT(initial_free - sn_freelist_allocator_get_free_size(&alloc) < 256);
+    sn_freelist_allocator_free(&alloc, big_align);
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&alloc) == initial_free);
+
+    /* Mixed alignments through every entry point */
+    void *ptrs[48] = {0};
+    uint64_t sizes[48] = {0};
+    uint64_t aligns[48] = {0};
+    for (int i = 0; i < 2000; i++) {
+        int slot = (int)rand_range(0, 47);
+        if (!ptrs[slot]) {
+            sizes[slot] = rand_range(1, 256);
+            aligns[slot] = 1ULL << rand_range(0, 7);
+            ptrs[slot] = sn_freelist_allocator_allocate(&alloc, sizes[slot], aligns[slot]);
+            if (ptrs[slot]) TEST_ASSERT(SN_IS_ALIGNED(ptrs[slot], aligns[slot]));
+        } else if (rand() % 3 == 0) {
+            verify_pattern(ptrs[slot], sizes[slot], (uint8_t)slot);
+            uint64_t new_size = rand_range(1, 256);
+            void *p = sn_freelist_allocator_reallocate(&alloc, ptrs[slot], new_size, aligns[slot]);
+            if (p) {
+                TEST_ASSERT(SN_IS_ALIGNED(p, aligns[slot]));
+                verify_pattern(p, SN_MIN(sizes[slot], new_size), (uint8_t)slot);
+                ptrs[slot] = p;
+                sizes[slot] = new_size;
+            }
+        } else {
+            verify_pattern(ptrs[slot], sizes[slot], (uint8_t)slot);
+            if (rand() % 2) sn_freelist_allocator_free(&alloc, ptrs[slot]);
+            else sn_freelist_allocator_free_sized(&alloc, ptrs[slot], sizes[slot], aligns[slot]);
+            ptrs[slot] = NULL;
+        }
+
+        if (ptrs[slot]) fill_pattern(ptrs[slot], sizes[slot], (uint8_t)slot);
+    }
+
+    sn_freelist_allocator_free_batch(&alloc, ptrs, 48);
+
+    uint64_t count = sn_freelist_allocator_allocate_batch(&alloc, (void **)ptrs, 48, 24, 32);
+    TEST_ASSERT(count == 48);
+    for (uint64_t i = 0; i < count; i++) TEST_ASSERT(SN_IS_ALIGNED(ptrs[i], 32));
+    sn_freelist_allocator_free_batch(&alloc, ptrs, count);
+
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&alloc) == initial_free);
+    TEST_ASSERT(sn_freelist_allocator_get_largest_free_size(&alloc) == initial_free);
+}
+
+static void test_freelist_large_blocks(void) {
+    static uint8_t buffer[KB(64)];
+    SnFreeListAllocator alloc;
+    SnFreeListLargeBlock registry[2];
+
+    TEST_ASSERT(sn_freelist_allocator_init(&alloc, buffer, sizeof(buffer)));
+    TEST_ASSERT(sn_freelist_allocator_enable_large_blocks(&alloc, KB(8), registry, 2));
+    uint64_t initial_free = sn_freelist_allocator_get_free_size(&alloc);
+    uint64_t page_size = sn_vm_get_page_size();
+
+    /* Large requests get their own pages, small ones stay in the buffer */
+    void *large = sn_freelist_allocator_allocate(&alloc, KB(100), 64);
+    void *small = sn_freelist_allocator_allocate(&alloc, 256, 8);
+    TEST_ASSERT(large && small);
+    TEST_ASSERT(SN_IS_ALIGNED(large, page_size));
+    TEST_ASSERT((uint8_t *)large < buffer || (uint8_t *)large >= buffer + sizeof(buffer));
+    TEST_ASSERT(sn_freelist_allocator_owns(&alloc, large) && sn_freelist_allocator_owns(&alloc, small));
+
+    fill_pattern(large, KB(4), 1);
+    fill_pattern((uint8_t *)large + KB(96), KB(4), 2);
+
+    /* Growing within the reservation and shrinking stay in place */
+    TEST_ASSERT(sn_freelist_allocator_reallocate(&alloc, large, KB(180), 64) == large);
+    fill_pattern((uint8_t *)large + KB(176), KB(4), 3);
+    TEST_ASSERT(sn_freelist_allocator_reallocate(&alloc, large, KB(20), 64) == large);
+    verify_pattern(large, KB(4), 1);
+
+    /* Outgrowing it resizes the reservation, the contents may move */
+    fill_pattern((uint8_t *)large + KB(16), KB(4), 4);
+    void *moved = sn_freelist_allocator_reallocate(&alloc, large, KB(512), 64);
+    TEST_ASSERT(moved && SN_IS_ALIGNED(moved, page_size));
+    verify_pattern(moved, KB(4), 1);
+    verify_pattern((uint8_t *)moved + KB(16), KB(4), 4);
+    fill_pattern((uint8_t *)moved + KB(508), KB(4), 5);
+
+    /* Growing a buffer block past the threshold moves it out */
+    fill_pattern(small, 256, 6);
+    void *grown = sn_freelist_allocator_reallocate(&alloc, small, KB(16), 8);
+    TEST_ASSERT(grown);
+    TEST_ASSERT((uint8_t *)grown < buffer || (uint8_t *)grown >= buffer + sizeof(buffer));
+    verify_pattern(grown, 256, 6);
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&alloc) == initial_free);
+
+    /* A full registry falls back to the buffer */
+    void *fallback = sn_freelist_allocator_allocate(&alloc, KB(10), 8);
+    TEST_ASSERT((uint8_t *)fallback >= buffer && (uint8_t *)fallback < buffer + sizeof(buffer));
+
+    void *ptrs[3] = {moved, fallback, NULL};
+    sn_freelist_allocator_free_batch(&alloc, ptrs, 3);
+    TEST_ASSERT(!sn_freelist_allocator_owns(&alloc, moved));
+    sn_freelist_allocator_free_sized(&alloc, grown, KB(16), 8);
+    TEST_ASSERT(!sn_freelist_allocator_owns(&alloc, grown));
+
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&alloc) == initial_free);
+
+    /* A large block shrunk below the threshold is still freed as large */
+    void *shrunk = sn_freelist_allocator_allocate(&alloc, KB(512), 8);
+    TEST_ASSERT(shrunk);
+    TEST_ASSERT((uint8_t *)shrunk < buffer || (uint8_t *)shrunk >= buffer + sizeof(buffer));
+    TEST_ASSERT(sn_freelist_allocator_reallocate(&alloc, shrunk, 100, 8) == shrunk);
+    sn_freelist_allocator_free_sized(&alloc, shrunk, 100, 8);
+    TEST_ASSERT(!sn_freelist_allocator_owns(&alloc, shrunk));
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&alloc) == initial_free);
+
+    /* Deinit releases what is left */
+    TEST_ASSERT(sn_freelist_allocator_allocate(&alloc, MB(1), 8));
+    sn_freelist_allocator_deinit(&alloc);
+}
+
+static void test_freelist_large_registry(void) {
+    static uint8_t buffer[KB(16)];
+    SnFreeListAllocator alloc;
+    SnFreeListLargeBlock registry[7];
+
+    TEST_ASSERT(sn_freelist_allocator_init(&alloc, buffer, sizeof(buffer)));
+    TEST_ASSERT(sn_freelist_allocator_enable_large_blocks(&alloc, KB(8), registry, 7));
+
+    /* A full registry, probe runs wrap around its end */
+    void *blocks[7];
+    for (int i = 0; i < 7; i++) {
+        blocks[i] = sn_freelist_allocator_allocate(&alloc, KB(12), 8);
+        TEST_ASSERT(blocks[i]);
+        TEST_ASSERT((uint8_t *)blocks[i] < buffer || (uint8_t *)blocks[i] >= buffer + sizeof(buffer));
+        fill_pattern(blocks[i], 64, (uint8_t)i);
+    }
+    for (int i = 0; i < 7; i++) TEST_ASSERT(sn_freelist_allocator_owns(&alloc, blocks[i]));
+
+    /* Removing from the middle of probe runs keeps the rest reachable */
+    const int order[7] = {3, 0, 6, 1, 5, 2, 4};
+    for (int n = 0; n < 7; n++) {
+        int freed = order[n];
+        sn_freelist_allocator_free(&alloc, blocks[freed]);
+        TEST_ASSERT(!sn_freelist_allocator_owns(&alloc, blocks[freed]));
+
+        for (int m = n + 1; m < 7; m++) {
+            TEST_ASSERT(sn_freelist_allocator_owns(&alloc, blocks[order[m]]));
+            verify_pattern(blocks[order[m]], 64, (uint8_t)order[m]);
+        }
+    }
+
+    /* Only block starts are looked up */
+    void *large = sn_freelist_allocator_allocate(&alloc, KB(12), 8);
+    TEST_ASSERT(sn_freelist_allocator_owns(&alloc, large));
+    TEST_ASSERT(!sn_freelist_allocator_owns(&alloc, (uint8_t *)large + 64));
+    sn_freelist_allocator_deinit(&alloc);
+}
+
 static void test_freelist_fragmentation(void) {
     uint8_t buffer[KB(48)];
     SnFreeListAllocator alloc;
@@ -386,6 +901,38 @@ static void test_freelist_realloc_loop(void) {
     sn_freelist_allocator_free(&alloc, p);
 }
 
+static void test_freelist_realloc_neighbours(void) {
+    static uint8_t buffer[KB(64)];
+    SnFreeListAllocator alloc;
+
+    TEST_ASSERT(sn_freelist_allocator_init(&alloc, buffer, sizeof(buffer)));
+
+    void *ptrs[32] = {0};
+    uint64_t sizes[32];
+
+    // In place growth and shrinking must stay inside the block
+    for (int i = 0; i < 2000; i++) {
+        int slot = (int)rand_range(0, 31);
+
+        if (!ptrs[slot]) {
+            sizes[slot] = rand_range(1, 256);
+            ptrs[slot] = sn_freelist_allocator_allocate(&alloc, sizes[slot], 8);
+        } else {
+            verify_pattern(ptrs[slot], sizes[slot], (uint8_t)slot);
+            sizes[slot] = rand_range(1, 256);
+            ptrs[slot] = sn_freelist_allocator_reallocate(&alloc, ptrs[slot], sizes[slot], 8);
+        }
+
+        TEST_ASSERT(ptrs[slot]);
+        fill_pattern(ptrs[slot], sizes[slot], (uint8_t)slot);
+    }
+
+    for (int i = 0; i < 32; i++) {
+        if (ptrs[i]) verify_pattern(ptrs[i], sizes[i], (uint8_t)i);
+        sn_freelist_allocator_free(&alloc, ptrs[i]);
+    }
+}
+
 static void test_freelist_full_reuse(void) {
     uint8_t buffer[KB(16)];
     SnFreeListAllocator alloc;
@@ -408,6 +955,319 @@ static void test_freelist_full_reuse(void) {
     TEST_ASSERT(free_size >= KB(15));  // Almost entire buffer
 }
 
+static void test_freelist_free_sized(void) {
+    uint8_t buffer[KB(16)];
+    SnFreeListAllocator alloc;
+
+    TEST_ASSERT(sn_freelist_allocator_init(&alloc, buffer, sizeof(buffer)));
+    uint64_t initial_free = sn_freelist_allocator_get_free_size(&alloc);
+
+    void *ptrs[64];
+    uint64_t sizes[64];
+    uint64_t aligns[64];
+
+    for (int i = 0; i < 64; i++) {
+        sizes[i] = rand_range(1, 128);
+        aligns[i] = 1ULL << rand_range(0, 6);  // 1..64, covers both paths
+        ptrs[i] = sn_freelist_allocator_allocate(&alloc, sizes[i], aligns[i]);
+        TEST_ASSERT(ptrs[i]);
+        fill_pattern(ptrs[i], sizes[i], (uint8_t)i);
+    }
+
+    for (int i = 0; i < 64; i += 2) {
+        verify_pattern(ptrs[i], sizes[i], (uint8_t)i);
+        sn_freelist_allocator_free_sized(&alloc, ptrs[i], sizes[i], aligns[i]);
+    }
+
+    /* Sized and unsized frees mix */
+    for (int i = 1; i < 64; i += 2) {
+        verify_pattern(ptrs[i], sizes[i], (uint8_t)i);
+        sn_freelist_allocator_free(&alloc, ptrs[i]);
+    }
+
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&alloc) == initial_free);
+}
+
+static void test_handle_pool(void) {
+    static uint8_t buffer[KB(16)];
+    SnHandlePool pool;
+
+    TEST_ASSERT(!sn_handle_pool_init(&pool, buffer, sizeof(buffer), 2, 2));
+
+    uint64_t required = sn_handle_pool_get_required_size(100, 48, 16);
+    TEST_ASSERT(sn_handle_pool_init(&pool, buffer + 1, required, 48, 16));
+    TEST_ASSERT(sn_handle_pool_get_capacity(&pool) >= 100);
+
+    TEST_ASSERT(sn_handle_pool_init(&pool, buffer, sizeof(buffer), 48, 16));
+    uint32_t capacity = sn_handle_pool_get_capacity(&pool);
+
+    void *item;
+    SnHandle a = sn_handle_pool_allocate(&pool, &item);
+    TEST_ASSERT(a != SN_HANDLE_INVALID);
+    TEST_ASSERT(item && SN_IS_ALIGNED(item, 16));
+    TEST_ASSERT(sn_handle_pool_resolve(&pool, a) == item);
+    TEST_ASSERT(sn_handle_pool_get_handle(&pool, item) == a);
+    TEST_ASSERT(!sn_handle_pool_resolve(&pool, SN_HANDLE_INVALID));
+
+    // The slot is reused, the old handle goes stale
+    TEST_ASSERT(sn_handle_pool_free(&pool, a));
+    TEST_ASSERT(!sn_handle_pool_free(&pool, a));
+    TEST_ASSERT(sn_handle_pool_get_handle(&pool, item) == SN_HANDLE_INVALID);
+
+    void *reused;
+    SnHandle b = sn_handle_pool_allocate(&pool, &reused);
+    TEST_ASSERT(reused == item && b != a);
+    TEST_ASSERT(!sn_handle_pool_is_valid(&pool, a));
+    TEST_ASSERT(sn_handle_pool_is_valid(&pool, b));
+
+    SnHandle32 b32 = sn_handle_to_32(b);
+    TEST_ASSERT(sn_handle_pool_resolve32(&pool, b32) == reused);
+    TEST_ASSERT(!sn_handle_pool_resolve32(&pool, sn_handle_to_32(a)));
+    TEST_ASSERT(sn_handle_pool_free32(&pool, b32));
+    TEST_ASSERT(!sn_handle_pool_resolve32(&pool, b32));
+
+    // Fill the pool, tagging every item with its number
+    SnHandle handles[512];
+    TEST_ASSERT(capacity <= 512);
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        handles[i] = sn_handle_pool_allocate(&pool, &item);
+        TEST_ASSERT(handles[i] != SN_HANDLE_INVALID);
+        *(uint32_t *)item = i;
+    }
+    TEST_ASSERT(sn_handle_pool_allocate(&pool, NULL) == SN_HANDLE_INVALID);
+    TEST_ASSERT(sn_handle_pool_get_live_count(&pool) == capacity);
+
+    for (uint32_t i = 0; i < capacity; i += 2) TEST_ASSERT(sn_handle_pool_free(&pool, handles[i]));
+
+    // Iteration visits exactly the odd items
+    uint32_t cursor = 0, visited = 0;
+    while ((item = sn_handle_pool_iterate(&pool, &cursor))) {
+        TEST_ASSERT(*(uint32_t *)item % 2 == 1);
+        TEST_ASSERT(sn_handle_pool_resolve(&pool, handles[*(uint32_t *)item]) == item);
+        visited++;
+    }
+    TEST_ASSERT(visited == capacity / 2);
+    TEST_ASSERT(sn_handle_pool_get_live_count(&pool) == visited);
+
+    sn_handle_pool_deinit(&pool);
+}
+
+static void test_packed_pool(void) {
+    static uint8_t buffer[KB(16)];
+    SnPackedPool pool;
+
+    // The required size is enough wherever the buffer starts
+    uint64_t required = sn_packed_pool_get_required_size(100, sizeof(uint64_t), 32);
+    TEST_ASSERT(sn_packed_pool_init(&pool, buffer + 1, required, sizeof(uint64_t), 32));
+    TEST_ASSERT(sn_packed_pool_get_capacity(&pool) >= 100);
+
+    TEST_ASSERT(sn_packed_pool_init(&pool, buffer, sizeof(buffer), sizeof(uint64_t), 32));
+    uint32_t capacity = sn_packed_pool_get_capacity(&pool);
+    TEST_ASSERT(SN_IS_ALIGNED(sn_packed_pool_get_items(&pool), 32));
+
+    SnHandle handles[1024];
+    TEST_ASSERT(capacity <= 1024);
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        void *item;
+        handles[i] = sn_packed_pool_allocate(&pool, &item);
+        TEST_ASSERT(handles[i] != SN_HANDLE_INVALID);
+        TEST_ASSERT(item == sn_packed_pool_get_item(&pool, i));
+        *(uint64_t *)item = i;
+    }
+    TEST_ASSERT(sn_packed_pool_allocate(&pool, NULL) == SN_HANDLE_INVALID);
+
+    // Remove in random order, every handle keeps finding its own value
+    uint32_t live = capacity;
+    for (uint32_t n = 0; n < capacity / 2; n++) {
+        uint32_t i = (uint32_t)rand_range(0, capacity - 1);
+        if (!sn_packed_pool_resolve(&pool, handles[i])) continue;
+
+        TEST_ASSERT(sn_packed_pool_free(&pool, handles[i]));
+        TEST_ASSERT(!sn_packed_pool_free(&pool, handles[i]));
+        live--;
+    }
+    TEST_ASSERT(sn_packed_pool_get_count(&pool) == live);
+
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < capacity; i++) {
+        uint64_t *item = sn_packed_pool_resolve(&pool, handles[i]);
+        if (!item) continue;
+        TEST_ASSERT(*item == i);
+        found++;
+    }
+    TEST_ASSERT(found == live);
+
+    // The dense array holds exactly the live items, each mapping back to its handle
+    for (uint32_t d = 0; d < sn_packed_pool_get_count(&pool); d++) {
+        uint64_t *item = sn_packed_pool_get_item(&pool, d);
+        TEST_ASSERT(sn_packed_pool_get_handle(&pool, d) == handles[*item]);
+    }
+
+    // Freed slots are reused with a new generation
+    SnHandle stale = SN_HANDLE_INVALID;
+    for (uint32_t i = 0; i < capacity && stale == SN_HANDLE_INVALID; i++)
+        if (!sn_packed_pool_resolve(&pool, handles[i])) stale = handles[i];
+
+    TEST_ASSERT(stale != SN_HANDLE_INVALID);
+    SnHandle fresh = sn_packed_pool_allocate(&pool, NULL);
+    TEST_ASSERT(fresh != SN_HANDLE_INVALID && fresh != stale);
+    TEST_ASSERT(!sn_packed_pool_resolve(&pool, stale));
+    TEST_ASSERT(sn_packed_pool_resolve(&pool, fresh) == sn_packed_pool_get_item(&pool, live));
+
+    sn_packed_pool_deinit(&pool);
+}
+
+static void reloc_fill(SnRelocHeap *heap, SnHandle handle, uint8_t seed) {
+    void *p = sn_reloc_heap_pin(heap, handle);
+    TEST_ASSERT(p && SN_IS_ALIGNED(p, SN_RELOC_HEAP_ALIGNMENT));
+    fill_pattern(p, sn_reloc_heap_get_size(heap, handle), seed);
+    sn_reloc_heap_unpin(heap, handle);
+}
+
+static void reloc_verify(SnRelocHeap *heap, SnHandle handle, uint8_t seed) {
+    void *p = sn_reloc_heap_pin(heap, handle);
+    TEST_ASSERT(p);
+    verify_pattern(p, sn_reloc_heap_get_size(heap, handle), seed);
+    sn_reloc_heap_unpin(heap, handle);
+}
+
+static void test_reloc_heap(void) {
+    static uint8_t buffer[KB(64)];
+    SnRelocHeap heap;
+
+    TEST_ASSERT(sn_reloc_heap_init(&heap, buffer, sizeof(buffer), 256));
+
+    // Fragment the heap: fill it, then free every other block
+    SnHandle handles[256] = {0};
+    int count = 0;
+    while (count < 256 && (handles[count] = sn_reloc_heap_allocate(&heap, 200)) != SN_HANDLE_INVALID) {
+        reloc_fill(&heap, handles[count], (uint8_t)count);
+        count++;
+    }
+    TEST_ASSERT(count > 100);
+
+    for (int i = 0; i < count; i += 2) {
+        TEST_ASSERT(sn_reloc_heap_free(&heap, handles[i]));
+        TEST_ASSERT(!sn_reloc_heap_free(&heap, handles[i]));
+        TEST_ASSERT(!sn_reloc_heap_pin(&heap, handles[i]));
+        handles[i] = SN_HANDLE_INVALID;
+    }
+
+    uint64_t big = sn_reloc_heap_get_free_size(&heap) / 2;
+    TEST_ASSERT(sn_reloc_heap_allocate(&heap, big) == SN_HANDLE_INVALID);
+
+    // A pinned block stays put and can not be freed
+    void *pinned = sn_reloc_heap_pin(&heap, handles[count / 2 + 1]);
+    TEST_ASSERT(!sn_reloc_heap_free(&heap, handles[count / 2 + 1]));
+
+    // Small budgets make progress one step at a time
+    uint64_t total = 0, moved;
+    while ((moved = sn_reloc_heap_compact(&heap, 256, 0))) {
+        TEST_ASSERT(moved <= 256 + 256);
+        total += moved;
+    }
+    TEST_ASSERT(total > 0);
+    TEST_ASSERT(sn_reloc_heap_pin(&heap, handles[count / 2 + 1]) == pinned);
+    sn_reloc_heap_unpin(&heap, handles[count / 2 + 1]);
+    sn_reloc_heap_unpin(&heap, handles[count / 2 + 1]);
+
+    for (int i = 1; i < count; i += 2) reloc_verify(&heap, handles[i], (uint8_t)i);
+
+    // With the pin gone the heap compacts completely
+    sn_reloc_heap_compact(&heap, 0, 0);
+    TEST_ASSERT(sn_reloc_heap_get_tail_size(&heap) == sn_reloc_heap_get_free_size(&heap));
+
+    SnHandle large = sn_reloc_heap_allocate(&heap, big);
+    TEST_ASSERT(large != SN_HANDLE_INVALID);
+    TEST_ASSERT(sn_reloc_heap_free(&heap, large));
+
+    for (int i = 1; i < count; i += 2) reloc_verify(&heap, handles[i], (uint8_t)i);
+
+    sn_reloc_heap_deinit(&heap);
+}
+
+static void test_reloc_heap_random_stress(void) {
+    static uint8_t buffer[KB(64)];
+    SnRelocHeap heap;
+
+    TEST_ASSERT(sn_reloc_heap_init(&heap, buffer, sizeof(buffer), 128));
+
+    SnHandle handles[64] = {0};
+
+    // Interleave allocations and frees with small compaction steps
+    for (int i = 0; i < 4000; i++) {
+        int slot = (int)rand_range(0, 63);
+
+        if (handles[slot]) {
+            reloc_verify(&heap, handles[slot], (uint8_t)slot);
+            TEST_ASSERT(sn_reloc_heap_free(&heap, handles[slot]));
+            handles[slot] = SN_HANDLE_INVALID;
+        } else {
+            handles[slot] = sn_reloc_heap_allocate(&heap, rand_range(1, 1024));
+            if (handles[slot]) reloc_fill(&heap, handles[slot], (uint8_t)slot);
+        }
+
+        sn_reloc_heap_compact(&heap, 128, 0);
+    }
+
+    for (int i = 0; i < 64; i++) {
+        if (!handles[i]) continue;
+        reloc_verify(&heap, handles[i], (uint8_t)i);
+        TEST_ASSERT(sn_reloc_heap_free(&heap, handles[i]));
+    }
+
+    sn_reloc_heap_compact(&heap, 0, 0);
+    TEST_ASSERT(sn_reloc_heap_get_tail_size(&heap) == sn_reloc_heap_get_free_size(&heap));
+}
+
+static void test_adapter_free_sized(void) {
+    uint8_t buffer[KB(4)];
+
+    SnPoolAllocator pool;
+    TEST_ASSERT(sn_pool_allocator_init(&pool, buffer, sizeof(buffer), 64, 8));
+
+    SnMemoryAdapter adapter = sn_pool_allocator_get_adapter(&pool);
+    TEST_ASSERT(adapter.free_sized);
+
+    void *p = sn_memory_adapter_allocate(&adapter, 48, 8);
+    TEST_ASSERT(p);
+    sn_memory_adapter_free_sized(&adapter, p, 48, 8);
+    TEST_ASSERT(sn_pool_allocator_get_used_count(&pool) == 0);
+
+    /* Adapters without sized free use free */
+    adapter = sn_memory_adapter_from_allocator(sn_pool_allocator_get_allocator(&pool));
+    TEST_ASSERT(!adapter.free_sized);
+
+    p = sn_memory_adapter_allocate(&adapter, 48, 8);
+    TEST_ASSERT(p);
+    sn_memory_adapter_free_sized(&adapter, p, 48, 8);
+    TEST_ASSERT(sn_pool_allocator_get_used_count(&pool) == 0);
+
+    SnStackAllocator stack;
+    TEST_ASSERT(sn_stack_allocator_init(&stack, buffer, sizeof(buffer)));
+    adapter = sn_stack_allocator_get_adapter(&stack);
+
+    void *a = sn_memory_adapter_allocate(&adapter, 100, 16);
+    void *b = sn_memory_adapter_allocate(&adapter, 30, 4);
+    TEST_ASSERT(a && b);
+    sn_memory_adapter_free_sized(&adapter, b, 30, 4);
+    sn_memory_adapter_free_sized(&adapter, a, 100, 16);
+    TEST_ASSERT(sn_stack_allocator_get_allocated_size(&stack) == 0);
+
+    SnQueueAllocator queue;
+    TEST_ASSERT(sn_queue_allocator_init(&queue, buffer, sizeof(buffer)));
+    adapter = sn_queue_allocator_get_adapter(&queue);
+
+    a = sn_memory_adapter_allocate(&adapter, 100, 16);
+    b = sn_memory_adapter_allocate(&adapter, 30, 4);
+    TEST_ASSERT(a && b);
+    sn_memory_adapter_free_sized(&adapter, a, 100, 16);
+    sn_memory_adapter_free_sized(&adapter, b, 30, 4);
+    TEST_ASSERT(sn_queue_allocator_get_allocated_size(&queue) == 0);
+}
+
 static void test_vm_basic(void) {
     uint64_t page_size = sn_vm_get_page_size();
     TEST_ASSERT(page_size > 0);
@@ -448,6 +1308,384 @@ static void test_vm_basic(void) {
     TEST_ASSERT(released);
 }
 
+static void test_vm_range(void) {
+    uint64_t page_size = sn_vm_get_page_size();
+    uint64_t size = MB(3) + 1;
+
+    void *ptr = sn_vm_reserve_range(NULL, size);
+    TEST_ASSERT(ptr != NULL);
+    TEST_ASSERT(SN_IS_ALIGNED(ptr, page_size));
+
+    /* Partial commit, last page of the size is rounded up */
+    TEST_ASSERT(sn_vm_commit_range(ptr, MB(1), SN_VM_FLAG_NONE));
+    TEST_ASSERT(sn_vm_commit_range((uint8_t *)ptr + MB(1), MB(2) + 1, SN_VM_FLAG_PREFAULT));
+
+    uint8_t *mem = (uint8_t *)ptr;
+    mem[0] = 1;
+    mem[MB(3)] = 2;
+    mem[MB(3) + page_size - 1] = 3;
+    TEST_ASSERT(mem[0] == 1 && mem[MB(3)] == 2 && mem[MB(3) + page_size - 1] == 3);
+
+    TEST_ASSERT(sn_vm_decommit_range(mem + MB(1), MB(1)));
+    TEST_ASSERT(sn_vm_release_range(ptr, size));
+}
+
+static void test_vm_resize(void) {
+    uint64_t page_size = sn_vm_get_page_size();
+    uint64_t size = 4 * page_size;
+
+    void *ptr = sn_vm_reserve_range(NULL, size);
+    TEST_ASSERT(ptr != NULL);
+    TEST_ASSERT(sn_vm_commit_range(ptr, size, SN_VM_FLAG_NONE));
+
+    uint8_t *mem = (uint8_t *)ptr;
+    for (uint64_t i = 0; i < size; ++i) mem[i] = (uint8_t)(i * 7);
+
+    TEST_ASSERT(sn_vm_resize(mem, size, size) == mem);
+
+    /* Grown range keeps the contents and the new pages are usable */
+    mem = sn_vm_resize(mem, size, 64 * page_size);
+    TEST_ASSERT(mem != NULL);
+    TEST_ASSERT(SN_IS_ALIGNED(mem, page_size));
+    for (uint64_t i = 0; i < size; ++i) TEST_ASSERT(mem[i] == (uint8_t)(i * 7));
+    memset(mem + size, 0xEE, 60 * page_size);
+
+    /* Shrinking is rounded up to whole pages */
+    mem = sn_vm_resize(mem, 64 * page_size, page_size + 1);
+    TEST_ASSERT(mem != NULL);
+    for (uint64_t i = 0; i < 2 * page_size; ++i) TEST_ASSERT(mem[i] == (uint8_t)(i * 7));
+
+    TEST_ASSERT(sn_vm_resize(NULL, size, size) == NULL);
+    TEST_ASSERT(sn_vm_resize(mem, 2 * page_size, 0) == NULL);
+
+    TEST_ASSERT(sn_vm_release_range(mem, 2 * page_size));
+}
+
+#if defined(SN_OS_LINUX)
+static uint32_t get_resident_pages(void *ptr, uint32_t pages) {
+    unsigned char residency[64];
+    TEST_ASSERT(pages <= 64);
+    TEST_ASSERT(mincore(ptr, pages * sn_vm_get_page_size(), residency) == 0);
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < pages; ++i) count += residency[i] & 1;
+    return count;
+}
+#endif
+
+static void test_vm_lazy_decommit(void) {
+    uint64_t page_size = sn_vm_get_page_size();
+    const uint32_t pages = 8;
+
+    void *ptr = sn_vm_reserve(NULL, pages);
+    TEST_ASSERT(ptr != NULL);
+    TEST_ASSERT(sn_vm_commit(ptr, pages));
+
+    uint8_t *mem = (uint8_t *)ptr;
+    memset(mem, 0xAB, pages * page_size);
+
+#if defined(SN_OS_LINUX)
+    /* Decommitted pages leave RSS and come back zero filled */
+    TEST_ASSERT(get_resident_pages(mem, pages) == pages);
+    TEST_ASSERT(sn_vm_decommit(mem + 6 * page_size, 2));
+    TEST_ASSERT(get_resident_pages(mem + 6 * page_size, 2) == 0);
+    TEST_ASSERT(sn_vm_commit(mem + 6 * page_size, 2));
+    TEST_ASSERT(mem[6 * page_size] == 0 && mem[8 * page_size - 1] == 0);
+#endif
+
+    /* Discarded pages stay usable */
+    TEST_ASSERT(sn_vm_discard(mem, 2));
+    mem[0] = 1;
+    TEST_ASSERT(mem[0] == 1);
+
+    TEST_ASSERT(sn_vm_lazy_decommit_start());
+    TEST_ASSERT(sn_vm_lazy_decommit_start());
+
+    /* Recommitting a range with a queued decommit must leave it usable */
+    TEST_ASSERT(sn_vm_decommit_lazy(mem, 4));
+    TEST_ASSERT(sn_vm_commit(mem, 4));
+    memset(mem, 0xCD, 4 * page_size);
+
+    for (uint32_t i = 4; i < pages; ++i) TEST_ASSERT(sn_vm_decommit_lazy(mem + i * page_size, 1));
+    sn_vm_lazy_decommit_flush();
+
+    for (uint64_t i = 0; i < 4 * page_size; ++i) TEST_ASSERT(mem[i] == 0xCD);
+
+#if defined(SN_OS_LINUX)
+    /* The flush applied the queued decommits */
+    TEST_ASSERT(get_resident_pages(mem + 4 * page_size, 4) == 0);
+    TEST_ASSERT(get_resident_pages(mem, 4) == 4);
+#endif
+
+    TEST_ASSERT(sn_vm_decommit_lazy(mem, 4));
+    sn_vm_lazy_decommit_stop();
+
+    /* Not running anymore, decommit is applied right away */
+    TEST_ASSERT(sn_vm_commit(mem, 4));
+    memset(mem, 0xCD, 4 * page_size);
+    TEST_ASSERT(sn_vm_decommit_lazy(mem, 4));
+
+#if defined(SN_OS_LINUX)
+    TEST_ASSERT(get_resident_pages(mem, 4) == 0);
+#endif
+
+    TEST_ASSERT(sn_vm_release(ptr, pages));
+}
+
+static void test_vm_large_pages(void) {
+    uint64_t large_page_size = sn_vm_get_large_page_size();
+    TEST_ASSERT(large_page_size >= sn_vm_get_page_size());
+
+    const uint32_t pages = 2;
+
+    void *ptr = sn_vm_reserve_large(NULL, pages);
+    TEST_ASSERT(ptr != NULL);
+    TEST_ASSERT(SN_IS_ALIGNED(ptr, large_page_size));
+
+    TEST_ASSERT(sn_vm_commit_large(ptr, pages));
+
+    /* Touch one byte per base page */
+    uint8_t *mem = (uint8_t *)ptr;
+    for (uint64_t i = 0; i < pages * large_page_size; i += sn_vm_get_page_size()) mem[i] = (uint8_t)i;
+    for (uint64_t i = 0; i < pages * large_page_size; i += sn_vm_get_page_size())
+        TEST_ASSERT(mem[i] == (uint8_t)i);
+
+    TEST_ASSERT(sn_vm_release_large(ptr, pages));
+}
+
+static void test_vm_zero_range(void) {
+    uint64_t page_size = sn_vm_get_page_size();
+    uint64_t size = 128 * page_size;
+
+    uint8_t *mem = sn_vm_reserve_range(NULL, size);
+    TEST_ASSERT(mem);
+    TEST_ASSERT(sn_vm_commit_range(mem, size, SN_VM_FLAG_NONE));
+
+    memset(mem, 0xab, size);
+    TEST_ASSERT(sn_vm_zero_range(mem + page_size, page_size));
+    TEST_ASSERT(mem[page_size - 1] == 0xab && mem[2 * page_size] == 0xab);
+    TEST_ASSERT(is_zero(mem + page_size, page_size));
+
+    /* The range stays writable */
+    mem[page_size] = 1;
+    TEST_ASSERT(mem[page_size] == 1);
+
+    /* VM-backed linear allocator gives whole pages back, writes only the partial ones */
+    SnLinearAllocator alloc;
+    uint32_t flags = SN_LINEAR_ALLOCATOR_FLAG_ZERO_ON_RESET | SN_LINEAR_ALLOCATOR_FLAG_VM_BACKED;
+    TEST_ASSERT(sn_linear_allocator_init_with_flags(&alloc, mem + 40, size - 40, flags));
+    TEST_ASSERT(mem[39] == 0xab && is_zero(mem + 40, size - 40));
+
+    uint8_t *a = sn_linear_allocator_allocate(&alloc, size - 100, 8);
+    TEST_ASSERT(a);
+    memset(a, 0xcd, size - 100);
+    sn_linear_allocator_reset(&alloc);
+    TEST_ASSERT(mem[39] == 0xab && is_zero(mem + 40, size - 40));
+
+    TEST_ASSERT(sn_vm_release_range(mem, size));
+}
+
+#if defined(SN_OS_LINUX)
+/* Write one byte in a child process, true if the write killed it */
+static bool write_faults(uint8_t *ptr) {
+    fflush(stdout);
+    pid_t pid = fork();
+    TEST_ASSERT(pid >= 0);
+
+    if (pid == 0) {
+        // Sanitizers catch SIGSEGV themselves, the parent wants the signal
+        signal(SIGSEGV, SIG_DFL);
+        *(volatile uint8_t *)ptr = 1;
+        _exit(0);
+    }
+
+    int status;
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV;
+}
+#endif
+
+static void test_vm_arena(void) {
+    uint64_t page_size = sn_vm_get_page_size();
+    SnVmArena arena;
+
+    TEST_ASSERT(!sn_vm_arena_init(&arena, page_size, 2 * page_size, SN_VM_ARENA_FLAG_NONE, 0));
+
+    /* Without guards the chunk grows in place, allocations may straddle chunks */
+    TEST_ASSERT(sn_vm_arena_init(&arena, 64 * page_size, 4 * page_size, SN_VM_ARENA_FLAG_NONE, 0));
+    TEST_ASSERT(sn_vm_arena_get_committed_size(&arena) == 4 * page_size);
+
+    uint8_t *a = sn_vm_arena_allocate(&arena, 3 * page_size, 16);
+    uint8_t *b = sn_vm_arena_allocate(&arena, 2 * page_size, 16);
+    TEST_ASSERT(a == arena.base && b == a + 3 * page_size);
+    memset(a, 0x11, 5 * page_size);
+    TEST_ASSERT(sn_vm_arena_get_committed_size(&arena) == 8 * page_size);
+    TEST_ASSERT(sn_vm_arena_owns(&arena, b) && !sn_vm_arena_owns(&arena, a + 8 * page_size));
+
+    /* Running out of reservation fails, reset keeps the first chunk */
+    TEST_ASSERT(!sn_vm_arena_allocate(&arena, 60 * page_size, 16));
+    sn_vm_arena_reset(&arena);
+    TEST_ASSERT(sn_vm_arena_get_committed_size(&arena) == 4 * page_size);
+    TEST_ASSERT(sn_vm_arena_allocate(&arena, 64, 8) == arena.base);
+    sn_vm_arena_deinit(&arena);
+
+    /* With guards a chunk that can't take an allocation is followed by a gap */
+    TEST_ASSERT(sn_vm_arena_init(&arena, 64 * page_size, 2 * page_size, SN_VM_ARENA_FLAG_GUARD_PAGES, 0));
+    a = sn_vm_arena_allocate(&arena, page_size + 100, 16);
+    b = sn_vm_arena_allocate(&arena, page_size, 16);
+    TEST_ASSERT(b == a + 3 * page_size);
+    memset(b, 0x22, page_size);
+
+#if defined(SN_OS_LINUX)
+    /* The page after the first chunk is a guard */
+    TEST_ASSERT(!write_faults(a + 2 * page_size - 1));
+    TEST_ASSERT(write_faults(a + 2 * page_size));
+#endif
+
+    /* Oversized allocations get a chunk of their own size */
+    uint8_t *c = sn_vm_arena_allocate(&arena, 5 * page_size, 2 * page_size);
+    TEST_ASSERT(c && SN_IS_ALIGNED(c, 2 * page_size));
+    TEST_ASSERT(c >= b + 2 * page_size);
+    memset(c, 0x33, 5 * page_size);
+    sn_vm_arena_deinit(&arena);
+
+    /* Fenced allocations end at a page boundary, small ones stay in the chunk */
+    TEST_ASSERT(sn_vm_arena_init(&arena, 64 * page_size, 4 * page_size, SN_VM_ARENA_FLAG_NONE, KB(1)));
+    a = sn_vm_arena_allocate(&arena, 64, 8);
+    b = sn_vm_arena_allocate(&arena, 3000, 8);
+    c = sn_vm_arena_allocate(&arena, 64, 8);
+    TEST_ASSERT(a == arena.base && c == a + 64);
+    TEST_ASSERT(SN_IS_ALIGNED(b + 3000, page_size) && b >= arena.base + 5 * page_size);
+    memset(b, 0x44, 3000);
+
+#if defined(SN_OS_LINUX)
+    /* Overrunning a fenced allocation by one byte hits its guard page */
+    TEST_ASSERT(write_faults(b + 3000));
+#endif
+
+    uint8_t *d = sn_vm_arena_allocate(&arena, 1500, 16);
+    TEST_ASSERT(SN_PTR_DIFF(SN_GET_ALIGNED(d + 1500, page_size), d + 1500) < 16);
+    TEST_ASSERT(d >= b + 3000 + page_size);
+
+    /* A new chunk goes past the fenced pages and their guard */
+    uint8_t *e = sn_vm_arena_allocate(&arena, 4 * page_size - 64, 8);
+    TEST_ASSERT(e > d && sn_vm_arena_owns(&arena, e));
+    sn_vm_arena_deinit(&arena);
+}
+
+static void test_mapped_file(void) {
+    const char *path = "sn_memory_test_mapped.bin";
+    remove(path);
+
+    SnMappedFile file;
+    TEST_ASSERT(!sn_mapped_file_open(&file, path, KB(64), SN_MAPPED_FILE_FLAG_NONE, NULL));
+    TEST_ASSERT(sn_mapped_file_open(&file, path, KB(64), SN_MAPPED_FILE_FLAG_CREATE, NULL));
+    TEST_ASSERT(file.size == KB(64));
+    TEST_ASSERT(SN_IS_ALIGNED(file.base, sn_vm_get_page_size()));
+
+    /* The mapping backs an allocator, the root offset is kept in front of it */
+    uint64_t *root = file.base;
+    SnFreeListAllocator alloc;
+    TEST_ASSERT(sn_freelist_allocator_init(&alloc, root + 2, file.size - 2 * sizeof(uint64_t)));
+
+    uint8_t *data = sn_freelist_allocator_allocate(&alloc, KB(20), 16);
+    TEST_ASSERT(data && sn_mapped_file_owns(&file, data));
+    fill_pattern(data, KB(20), 7);
+
+    root[0] = sn_offset_from_ptr(file.base, data);
+    root[1] = sn_offset_from_ptr(file.base, NULL);
+    TEST_ASSERT(sn_offset_to_ptr(file.base, root[0]) == data);
+    TEST_ASSERT(sn_offset_to_ptr(file.base, root[1]) == NULL);
+
+    TEST_ASSERT(sn_mapped_file_sync(&file, data + 100, KB(8), false));
+    TEST_ASSERT(sn_mapped_file_sync(&file, file.base, file.size, true));
+    TEST_ASSERT(sn_mapped_file_advise(&file, data, KB(20), SN_MAPPED_FILE_ADVICE_WILLNEED));
+    TEST_ASSERT(sn_mapped_file_advise(&file, file.base, file.size, SN_MAPPED_FILE_ADVICE_RANDOM));
+    TEST_ASSERT(!sn_mapped_file_sync(&file, (uint8_t *)file.base + file.size, 1, true));
+
+    /* Dropped shared pages are read back from the file */
+    TEST_ASSERT(sn_mapped_file_advise(&file, data, KB(20), SN_MAPPED_FILE_ADVICE_DONTNEED));
+    verify_pattern(data, KB(20), 7);
+
+    sn_freelist_allocator_deinit(&alloc);
+    sn_mapped_file_close(&file);
+    TEST_ASSERT(file.base == NULL);
+
+    /* Reopen with the existing size, data is found through the offset */
+    TEST_ASSERT(sn_mapped_file_open(&file, path, 0, SN_MAPPED_FILE_FLAG_READ_ONLY, NULL));
+    TEST_ASSERT(file.size == KB(64));
+    root = file.base;
+    verify_pattern(sn_offset_to_ptr(file.base, root[0]), KB(20), 7);
+    sn_mapped_file_close(&file);
+
+    /* Private writes are not written back */
+    TEST_ASSERT(sn_mapped_file_open(&file, path, 0, SN_MAPPED_FILE_FLAG_PRIVATE, NULL));
+    root = file.base;
+    memset(sn_offset_to_ptr(file.base, root[0]), 0, KB(20));
+    sn_mapped_file_close(&file);
+
+    /* A larger size extends the file with zeros */
+    TEST_ASSERT(!sn_mapped_file_open(&file, path, KB(128), SN_MAPPED_FILE_FLAG_READ_ONLY, NULL));
+    TEST_ASSERT(sn_mapped_file_open(&file, path, KB(128), SN_MAPPED_FILE_FLAG_NONE, NULL));
+    root = file.base;
+    verify_pattern(sn_offset_to_ptr(file.base, root[0]), KB(20), 7);
+    for (uint64_t i = KB(64); i < KB(128); ++i) TEST_ASSERT(((uint8_t *)file.base)[i] == 0);
+    sn_mapped_file_close(&file);
+
+    remove(path);
+}
+
+static void test_latency_histogram(void) {
+    /* Bucket bounds must round trip */
+    for (uint64_t v = 0; v < 4096; ++v) {
+        uint32_t index = sn_latency_bucket_index(v);
+        TEST_ASSERT(index < SN_LATENCY_BUCKET_COUNT);
+        TEST_ASSERT(sn_latency_bucket_lower_bound(index) <= v);
+        TEST_ASSERT(sn_latency_bucket_lower_bound(index + 1) > v);
+    }
+    TEST_ASSERT(sn_latency_bucket_index(UINT64_MAX) == SN_LATENCY_BUCKET_COUNT - 1);
+
+    static SnLatencyHistogram histogram;
+    sn_latency_histogram_init(&histogram);
+
+    for (uint64_t i = 0; i < 990; ++i) sn_latency_histogram_record(&histogram, 100);
+    for (uint64_t i = 0; i < 10; ++i) sn_latency_histogram_record(&histogram, 200000);
+
+    static SnLatencySnapshot snapshot;
+    sn_latency_histogram_snapshot(&histogram, &snapshot, true);
+
+    TEST_ASSERT(snapshot.count == 1000);
+    TEST_ASSERT(snapshot.max == 200000);
+
+    uint64_t p50 = sn_latency_snapshot_percentile(&snapshot, 50.0);
+    uint64_t p999 = sn_latency_snapshot_percentile(&snapshot, 99.9);
+    TEST_ASSERT(p50 >= 100 && p50 < 100 + 100 / 8);
+    TEST_ASSERT(p999 <= 200000 && p999 > 200000 - 200000 / 8);
+
+    /* Reset leaves nothing behind */
+    sn_latency_histogram_snapshot(&histogram, &snapshot, false);
+    TEST_ASSERT(snapshot.count == 0);
+    TEST_ASSERT(sn_latency_snapshot_percentile(&snapshot, 99.0) == 0);
+
+    /* Wrapped allocator keeps working whether hooks are compiled or not */
+    uint8_t buffer[KB(4)];
+    SnFreeListAllocator freelist;
+    TEST_ASSERT(sn_freelist_allocator_init(&freelist, buffer, sizeof(buffer)));
+
+    static SnLatencyAllocator latency;
+    TEST_ASSERT(sn_latency_allocator_init(&latency, sn_freelist_allocator_get_allocator(&freelist)));
+
+    SnMemoryAllocator ma = sn_latency_allocator_get_allocator(&latency);
+    void *p = ma.alloc(ma.data, 64, 8);
+    TEST_ASSERT(p);
+    ma.free(ma.data, p);
+
+#if defined(SN_MEMORY_LATENCY_HOOKS)
+    sn_latency_histogram_snapshot(&latency.allocate, &snapshot, false);
+    TEST_ASSERT(snapshot.count == 1);
+#endif
+}
+
 static void test_queue_allocator_basic(void) {
     uint8_t buffer[KB(4)];
     SnQueueAllocator alloc;
@@ -630,6 +1868,322 @@ static void test_queue_allocator_random_stress(void) {
     TEST_ASSERT(sn_queue_allocator_get_allocated_size(&alloc) == 0);
 }
 
+static uint8_t slab_buffer[MB(1)];
+
+static void test_slab_allocator_basic(void) {
+    SnSlabAllocator alloc;
+
+    TEST_ASSERT(sn_slab_allocator_init(&alloc, slab_buffer, sizeof(slab_buffer)));
+    TEST_ASSERT(sn_slab_allocator_get_slab_count(&alloc) > 0);
+
+    /* Every size maps to the smallest class that fits */
+    for (uint64_t size = 1; size <= SN_SLAB_MAX_SIZE; ++size) {
+        uint32_t index = sn_slab_get_class_index(size);
+        TEST_ASSERT(index < SN_SLAB_CLASS_COUNT);
+        TEST_ASSERT(sn_slab_get_class_size(index) >= size);
+        TEST_ASSERT(index == 0 || sn_slab_get_class_size(index - 1) < size);
+    }
+    TEST_ASSERT(sn_slab_get_class_index(SN_SLAB_MAX_SIZE + 1) == SN_SLAB_CLASS_COUNT);
+    TEST_ASSERT(!sn_slab_allocator_allocate(&alloc, SN_SLAB_MAX_SIZE + 1, 8));
+
+    void *a = sn_slab_allocator_allocate(&alloc, 24, 8);
+    void *b = sn_slab_allocator_allocate(&alloc, 100, 16);
+    void *c = sn_slab_allocator_allocate(&alloc, 3000, 8);
+    TEST_ASSERT(a && b && c);
+    TEST_ASSERT(SN_IS_ALIGNED(b, 16));
+    TEST_ASSERT(sn_slab_allocator_get_usable_size(a) == 32);
+    TEST_ASSERT(sn_slab_allocator_get_usable_size(b) == 112);
+    TEST_ASSERT(sn_slab_allocator_get_usable_size(c) == 3072);
+
+    /* Alignment moves up to a class aligned enough */
+    void *d = sn_slab_allocator_allocate(&alloc, 40, 64);
+    TEST_ASSERT(d && SN_IS_ALIGNED(d, 64));
+
+    /* Realloc within the class keeps the pointer */
+    TEST_ASSERT(sn_slab_allocator_reallocate(&alloc, a, 30, 8) == a);
+    fill_pattern(a, 32, 7);
+    void *e = sn_slab_allocator_reallocate(&alloc, a, 500, 8);
+    TEST_ASSERT(e && e != a);
+    verify_pattern(e, 32, 7);
+
+    sn_slab_allocator_free(&alloc, b);
+    sn_slab_allocator_free(&alloc, c);
+    sn_slab_allocator_free(&alloc, d);
+    sn_slab_allocator_free(&alloc, e);
+
+    /* One empty slab is kept per class used */
+    void *f = sn_slab_allocator_allocate(&alloc, 100, 16);
+    TEST_ASSERT(f == b);
+    sn_slab_allocator_free(&alloc, f);
+
+    sn_slab_allocator_deinit(&alloc);
+}
+
+static void test_slab_allocator_exhaustion(void) {
+    SnSlabAllocator alloc;
+
+    TEST_ASSERT(sn_slab_allocator_init(&alloc, slab_buffer, sizeof(slab_buffer)));
+    uint64_t slabs = sn_slab_allocator_get_slab_count(&alloc);
+
+    uint64_t count = 0;
+    void **ptrs = malloc(sizeof(slab_buffer) / 4096 * sizeof(void *));
+    void *p;
+    while ((p = sn_slab_allocator_allocate(&alloc, 4096, 8))) ptrs[count++] = p;
+
+    TEST_ASSERT(count > 0);
+    TEST_ASSERT(sn_slab_allocator_get_free_slab_count(&alloc) == 0);
+
+    for (uint64_t i = 0; i < count; ++i) sn_slab_allocator_free(&alloc, ptrs[i]);
+
+    /* All but the cached slab are given back */
+    TEST_ASSERT(sn_slab_allocator_get_free_slab_count(&alloc) == slabs - 1);
+
+    /* Freed slabs serve other classes */
+    TEST_ASSERT(sn_slab_allocator_allocate(&alloc, 16, 8));
+
+    free(ptrs);
+    sn_slab_allocator_deinit(&alloc);
+}
+
+static void test_slab_allocator_random_stress(void) {
+    SnSlabAllocator alloc;
+
+    TEST_ASSERT(sn_slab_allocator_init(&alloc, slab_buffer, sizeof(slab_buffer)));
+
+    void *ptrs[TRACK_CAP] = {0};
+    uint64_t sizes[TRACK_CAP];
+
+    for (int i = 0; i < 4000; i++) {
+        uint32_t slot = (uint32_t)rand_range(0, TRACK_CAP - 1);
+
+        if (ptrs[slot]) {
+            verify_pattern(ptrs[slot], sizes[slot], (uint8_t)slot);
+            sn_slab_allocator_free(&alloc, ptrs[slot]);
+            ptrs[slot] = NULL;
+            continue;
+        }
+
+        uint64_t size = rand_range(1, SN_SLAB_MAX_SIZE);
+        uint64_t align = 1ULL << rand_range(0, 4);
+
+        void *p = sn_slab_allocator_allocate(&alloc, size, align);
+        if (!p) continue;
+
+        TEST_ASSERT(SN_IS_ALIGNED(p, align));
+        TEST_ASSERT(sn_slab_allocator_get_usable_size(p) >= size);
+
+        fill_pattern(p, size, (uint8_t)slot);
+        ptrs[slot] = p;
+        sizes[slot] = size;
+    }
+
+    for (uint32_t i = 0; i < TRACK_CAP; ++i) {
+        if (!ptrs[i]) continue;
+        verify_pattern(ptrs[i], sizes[i], (uint8_t)i);
+        sn_slab_allocator_free(&alloc, ptrs[i]);
+    }
+
+    /* At most one cached slab per class */
+    TEST_ASSERT(sn_slab_allocator_get_free_slab_count(&alloc) + SN_SLAB_CLASS_COUNT
+                >= sn_slab_allocator_get_slab_count(&alloc));
+
+    sn_slab_allocator_deinit(&alloc);
+}
+
+static void test_allocator_owns(void) {
+    uint8_t buffer[KB(4)];
+    uint8_t other[64];
+
+    const void *outside[] = {other, buffer + sizeof(buffer), NULL};
+
+    SnLinearAllocator linear;
+    TEST_ASSERT(sn_linear_allocator_init(&linear, buffer, sizeof(buffer)));
+    void *p = sn_linear_allocator_allocate(&linear, 64, 8);
+    TEST_ASSERT(sn_linear_allocator_owns(&linear, p));
+    TEST_ASSERT(sn_linear_allocator_owns(&linear, buffer + sizeof(buffer) - 1));
+    for (int i = 0; i < 3; i++) TEST_ASSERT(!sn_linear_allocator_owns(&linear, outside[i]));
+
+    SnFrameAllocator frame;
+    TEST_ASSERT(sn_frame_allocator_init(&frame, buffer, sizeof(buffer)));
+    sn_frame_allocator_begin(&frame);
+    p = sn_frame_allocator_allocate(&frame, 64, 8);
+    TEST_ASSERT(sn_frame_allocator_owns(&frame, p));
+    for (int i = 0; i < 3; i++) TEST_ASSERT(!sn_frame_allocator_owns(&frame, outside[i]));
+    sn_frame_allocator_end(&frame);
+
+    SnStackAllocator stack;
+    TEST_ASSERT(sn_stack_allocator_init(&stack, buffer, sizeof(buffer)));
+    p = sn_stack_allocator_allocate(&stack, 64, 8);
+    TEST_ASSERT(sn_stack_allocator_owns(&stack, p));
+    for (int i = 0; i < 3; i++) TEST_ASSERT(!sn_stack_allocator_owns(&stack, outside[i]));
+
+    SnPoolAllocator pool;
+    TEST_ASSERT(sn_pool_allocator_init(&pool, buffer, sizeof(buffer), 64, 8));
+    p = sn_pool_allocator_allocate(&pool);
+    TEST_ASSERT(sn_pool_allocator_owns(&pool, p));
+    for (int i = 0; i < 3; i++) TEST_ASSERT(!sn_pool_allocator_owns(&pool, outside[i]));
+
+    SnQueueAllocator queue;
+    TEST_ASSERT(sn_queue_allocator_init(&queue, buffer, sizeof(buffer)));
+    p = sn_queue_allocator_allocate(&queue, 64, 8);
+    TEST_ASSERT(sn_queue_allocator_owns(&queue, p));
+    for (int i = 0; i < 3; i++) TEST_ASSERT(!sn_queue_allocator_owns(&queue, outside[i]));
+
+    SnFreeListAllocator freelist;
+    TEST_ASSERT(sn_freelist_allocator_init(&freelist, buffer, sizeof(buffer)));
+    p = sn_freelist_allocator_allocate(&freelist, 64, 8);
+    TEST_ASSERT(sn_freelist_allocator_owns(&freelist, p));
+    for (int i = 0; i < 3; i++) TEST_ASSERT(!sn_freelist_allocator_owns(&freelist, outside[i]));
+
+    SnRingBufferAllocator ring;
+    TEST_ASSERT(sn_ring_buffer_allocator_init(&ring, buffer, sizeof(buffer)));
+    p = sn_ring_buffer_allocator_allocate(&ring, 64, 8);
+    TEST_ASSERT(sn_ring_buffer_allocator_owns(&ring, p));
+    for (int i = 0; i < 3; i++) TEST_ASSERT(!sn_ring_buffer_allocator_owns(&ring, outside[i]));
+
+    SnSlabAllocator slab;
+    TEST_ASSERT(sn_slab_allocator_init(&slab, slab_buffer, sizeof(slab_buffer)));
+    p = sn_slab_allocator_allocate(&slab, 64, 8);
+    TEST_ASSERT(sn_slab_allocator_owns(&slab, p));
+    for (int i = 0; i < 3; i++) TEST_ASSERT(!sn_slab_allocator_owns(&slab, outside[i]));
+
+    /* Adapters expose the query */
+    SnMemoryAdapter adapter = sn_slab_allocator_get_adapter(&slab);
+    TEST_ASSERT(sn_memory_adapter_owns(&adapter, p));
+    TEST_ASSERT(!sn_memory_adapter_owns(&adapter, other));
+
+    adapter = sn_memory_adapter_from_allocator(sn_slab_allocator_get_allocator(&slab));
+    TEST_ASSERT(!sn_memory_adapter_owns(&adapter, p));
+}
+
+static void test_fallback_allocator(void) {
+    uint8_t pool_buffer[KB(1)];
+    uint8_t freelist_buffer[KB(8)];
+
+    SnPoolAllocator pool;
+    SnFreeListAllocator freelist;
+    TEST_ASSERT(sn_pool_allocator_init(&pool, pool_buffer, sizeof(pool_buffer), 64, 8));
+    TEST_ASSERT(sn_freelist_allocator_init(&freelist, freelist_buffer, sizeof(freelist_buffer)));
+
+    SnMemoryAdapter primary = sn_pool_allocator_get_adapter(&pool);
+
+    /* Primary without an ownership query can not route frees */
+    SnFallbackAllocator alloc;
+    SnMemoryAdapter no_owns = sn_memory_adapter_from_allocator(sn_pool_allocator_get_allocator(&pool));
+    TEST_ASSERT(!sn_fallback_allocator_init(&alloc, no_owns, primary));
+    TEST_ASSERT(sn_fallback_allocator_init(&alloc, primary, sn_freelist_allocator_get_adapter(&freelist)));
+
+    uint64_t blocks = sn_pool_allocator_get_block_count(&pool);
+    uint64_t freelist_free = sn_freelist_allocator_get_free_size(&freelist);
+
+    void *ptrs[32];
+    TEST_ASSERT(blocks < 32);
+    for (uint64_t i = 0; i < 32; i++) {
+        ptrs[i] = sn_fallback_allocator_allocate(&alloc, 64, 8);
+        TEST_ASSERT(ptrs[i]);
+        TEST_ASSERT(sn_pool_allocator_owns(&pool, ptrs[i]) == (i < blocks));
+        TEST_ASSERT(sn_fallback_allocator_owns(&alloc, ptrs[i]) || i >= blocks);
+        fill_pattern(ptrs[i], 64, (uint8_t)i);
+    }
+
+    for (uint64_t i = 0; i < 32; i++) {
+        verify_pattern(ptrs[i], 64, (uint8_t)i);
+        if (i % 2) sn_fallback_allocator_free(&alloc, ptrs[i]);
+        else sn_fallback_allocator_free_sized(&alloc, ptrs[i], 64, 8);
+    }
+
+    TEST_ASSERT(sn_pool_allocator_get_free_count(&pool) == blocks);
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&freelist) == freelist_free);
+}
+
+static void test_segregator_allocator(void) {
+    uint8_t pool_buffer[KB(1)];
+    uint8_t freelist_buffer[KB(8)];
+
+    SnPoolAllocator pool;
+    SnFreeListAllocator freelist;
+    TEST_ASSERT(sn_pool_allocator_init(&pool, pool_buffer, sizeof(pool_buffer), 64, 8));
+    TEST_ASSERT(sn_freelist_allocator_init(&freelist, freelist_buffer, sizeof(freelist_buffer)));
+
+    SnMemoryAdapter small = sn_pool_allocator_get_adapter(&pool);
+
+    SnSegregatorAllocator alloc;
+    TEST_ASSERT(sn_segregator_allocator_init(&alloc, 64, small, sn_freelist_allocator_get_adapter(&freelist)));
+
+    uint64_t freelist_free = sn_freelist_allocator_get_free_size(&freelist);
+
+    void *a = sn_segregator_allocator_allocate(&alloc, 32, 8);
+    void *b = sn_segregator_allocator_allocate(&alloc, 64, 8);
+    void *c = sn_segregator_allocator_allocate(&alloc, 65, 8);
+    TEST_ASSERT(a && b && c);
+    TEST_ASSERT(sn_pool_allocator_owns(&pool, a) && sn_pool_allocator_owns(&pool, b));
+    TEST_ASSERT(!sn_pool_allocator_owns(&pool, c));
+    TEST_ASSERT(sn_pool_allocator_get_used_count(&pool) == 2);
+
+    /* Shrinking below the threshold moves the block to small */
+    fill_pattern(c, 65, 3);
+    void *d = sn_segregator_allocator_reallocate(&alloc, c, 40, 8);
+    TEST_ASSERT(d && sn_pool_allocator_owns(&pool, d));
+    verify_pattern(d, 40, 3);
+
+    /* Growing past it can not know the old size */
+    TEST_ASSERT(!sn_segregator_allocator_reallocate(&alloc, d, 200, 8));
+
+    void *e = sn_segregator_allocator_allocate(&alloc, 200, 8);
+    TEST_ASSERT(e);
+    e = sn_segregator_allocator_reallocate(&alloc, e, 400, 8);
+    TEST_ASSERT(e && !sn_pool_allocator_owns(&pool, e));
+
+    sn_segregator_allocator_free_sized(&alloc, a, 32, 8);
+    sn_segregator_allocator_free(&alloc, b);
+    sn_segregator_allocator_free_sized(&alloc, d, 40, 8);
+    sn_segregator_allocator_free(&alloc, e);
+
+    TEST_ASSERT(sn_pool_allocator_get_used_count(&pool) == 0);
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&freelist) == freelist_free);
+}
+
+static void test_bucketizer_allocator(void) {
+    static uint8_t buffers[3][KB(4)];
+    SnPoolAllocator pools[3];
+
+    TEST_ASSERT(sn_pool_allocator_init(&pools[0], buffers[0], KB(4), 32, 16));
+    TEST_ASSERT(sn_pool_allocator_init(&pools[1], buffers[1], KB(4), 128, 16));
+    TEST_ASSERT(sn_pool_allocator_init(&pools[2], buffers[2], KB(4), 512, 64));
+
+    SnBucketizerAllocator alloc;
+    TEST_ASSERT(sn_bucketizer_allocator_init(&alloc, pools, 3));
+
+    SnPoolAllocator unsorted[2] = {pools[1], pools[0]};
+    SnBucketizerAllocator bad;
+    TEST_ASSERT(!sn_bucketizer_allocator_init(&bad, unsorted, 2));
+
+    void *a = sn_bucketizer_allocator_allocate(&alloc, 20, 8);
+    void *b = sn_bucketizer_allocator_allocate(&alloc, 33, 8);
+    void *c = sn_bucketizer_allocator_allocate(&alloc, 16, 64);
+    TEST_ASSERT(a && b && c);
+    TEST_ASSERT(sn_pool_allocator_owns(&pools[0], a));
+    TEST_ASSERT(sn_pool_allocator_owns(&pools[1], b));
+    TEST_ASSERT(sn_pool_allocator_owns(&pools[2], c) && SN_IS_ALIGNED(c, 64));
+    TEST_ASSERT(!sn_bucketizer_allocator_allocate(&alloc, 513, 8));
+
+    TEST_ASSERT(sn_bucketizer_allocator_owns(&alloc, a));
+    TEST_ASSERT(!sn_bucketizer_allocator_owns(&alloc, &alloc));
+
+    /* Reallocation within the block keeps the pointer, past it moves bucket */
+    TEST_ASSERT(sn_bucketizer_allocator_reallocate(&alloc, a, 30, 8) == a);
+    fill_pattern(a, 30, 5);
+    void *d = sn_bucketizer_allocator_reallocate(&alloc, a, 100, 8);
+    TEST_ASSERT(d && sn_pool_allocator_owns(&pools[1], d));
+    verify_pattern(d, 30, 5);
+
+    sn_bucketizer_allocator_free(&alloc, b);
+    sn_bucketizer_allocator_free(&alloc, c);
+    sn_bucketizer_allocator_free(&alloc, d);
+
+    for (int i = 0; i < 3; i++) TEST_ASSERT(sn_pool_allocator_get_used_count(&pools[i]) == 0);
+}
+
 int main(void) {
     int n = 100;
 
@@ -644,6 +2198,7 @@ int main(void) {
         test_linear_allocator();
         test_linear_allocator_exhaustion();
         test_linear_allocator_marks();
+        test_linear_allocator_zero_on_reset();
         printf("Linear allocator tests passed ✅\n\n");
 
         /* Stack allocator */
@@ -657,6 +2212,8 @@ int main(void) {
         printf("Running test_pool_allocator...\n");
         test_pool_allocator();
         test_pool_allocator_random_free();
+        test_pool_allocator_batch();
+        test_pool_allocator_layout();
         printf("Pool allocator tests passed ✅\n\n");
 
         /* Frame allocator */
@@ -677,9 +2234,29 @@ int main(void) {
         printf("Running test_freelist_realloc_loop...\n");
         test_freelist_realloc_loop();
 
+        printf("Running test_freelist_realloc_neighbours...\n");
+        test_freelist_realloc_neighbours();
+
         printf("Running test_freelist_full_reuse...\n");
         test_freelist_full_reuse();
 
+        printf("Running test_freelist_free_sized...\n");
+        test_freelist_free_sized();
+
+        printf("Running test_freelist_batch...\n");
+        test_freelist_batch();
+
+        printf("Running test_freelist_policies...\n");
+        test_freelist_policies();
+        test_freelist_batch_best_fit();
+
+        printf("Running test_freelist_compact...\n");
+        test_freelist_compact();
+
+        printf("Running test_freelist_large_blocks...\n");
+        test_freelist_large_blocks();
+        test_freelist_large_registry();
+
         printf("Free-list allocator tests passed ✅\n\n");
 
         /* Queue allocator */
@@ -700,10 +2277,65 @@ int main(void) {
 
         printf("Queue allocator tests passed ✅\n\n");
 
+        /* Slab allocator */
+        printf("Running test_slab_allocator_basic...\n");
+        test_slab_allocator_basic();
+
+        printf("Running test_slab_allocator_exhaustion...\n");
+        test_slab_allocator_exhaustion();
+
+        printf("Running test_slab_allocator_random_stress...\n");
+        test_slab_allocator_random_stress();
+
+        printf("Slab allocator tests passed ✅\n\n");
+
+        printf("Running test_handle_pool...\n");
+        test_handle_pool();
+
+        printf("Running test_packed_pool...\n");
+        test_packed_pool();
+        printf("Handle and packed pool tests passed ✅\n\n");
+
+        printf("Running test_reloc_heap...\n");
+        test_reloc_heap();
+
+        printf("Running test_reloc_heap_random_stress...\n");
+        test_reloc_heap_random_stress();
+        printf("Relocatable heap tests passed ✅\n\n");
+
+        printf("Running test_adapter_free_sized...\n");
+        test_adapter_free_sized();
+
+        printf("Running test_allocator_owns...\n");
+        test_allocator_owns();
+
+        printf("Running test_fallback_allocator...\n");
+        test_fallback_allocator();
+
+        printf("Running test_segregator_allocator...\n");
+        test_segregator_allocator();
+
+        printf("Running test_bucketizer_allocator...\n");
+        test_bucketizer_allocator();
+
+        printf("Adapter and composition tests passed ✅\n\n");
+
         printf("Running test_vm_basic...\n");
         test_vm_basic();
+        test_vm_range();
+        test_vm_large_pages();
+        test_vm_lazy_decommit();
+        test_vm_resize();
+        test_vm_zero_range();
+        test_vm_arena();
+        test_mapped_file();
 
         printf("VM tests passed ✅\n\n");
+
+        printf("Running test_latency_histogram...\n");
+        test_latency_histogram();
+
+        printf("Latency histogram tests passed ✅\n\n");
     }
 
     printf("ALL ALLOCATOR TESTS PASSED %d times ✅✅✅\n", n);
@@ -0,0 +1,528 @@
+// getpid is POSIX, mincore a BSD extension
+#if !defined(_DEFAULT_SOURCE)
+    #define _DEFAULT_SOURCE
+#endif
+
+#include <snmemory/snmemory.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #define getpid GetCurrentProcessId
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#if defined(SN_OS_LINUX)
+    #include <sys/mman.h>
+#endif
+
+#define TEST_ASSERT(x)                                                                                      \
+    do {                                                                                                    \
+        if (!(x)) {                                                                                         \
+            fprintf(stderr, "ASSERT FAILED: %s in function %s(%s:%d)\n", #x, __func__, __FILE__, __LINE__); \
+            abort();                                                                                        \
+        }                                                                                                   \
+    } while (0)
+
+#define KB(x) ((x) * 1024ULL)
+#define MB(x) ((x) * 1024ULL * 1024ULL)
+
+#define THREAD_COUNT 8
+#define ITERATIONS 20000
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define RUN_TEST(name)            \
+    do {                          \
+        tests_run++;              \
+        printf("  %s...", #name); \
+        fflush(stdout);           \
+        name();                   \
+        printf(" passed\n");      \
+        tests_passed++;           \
+    } while (0)
+
+typedef void (*ThreadFn)(uint32_t index);
+
+static ThreadFn thread_fn;
+
+#if defined(_WIN32)
+static DWORD WINAPI thread_entry(LPVOID arg) {
+    thread_fn((uint32_t)(uintptr_t)arg);
+    return 0;
+}
+#else
+static void *thread_entry(void *arg) {
+    thread_fn((uint32_t)(uintptr_t)arg);
+    return NULL;
+}
+#endif
+
+/* Run fn on THREAD_COUNT threads and wait for all of them */
+static void run_threads(ThreadFn fn) {
+    thread_fn = fn;
+
+#if defined(_WIN32)
+    HANDLE threads[THREAD_COUNT];
+    for (uint32_t i = 0; i < THREAD_COUNT; i++)
+        threads[i] = CreateThread(NULL, 0, thread_entry, (LPVOID)(uintptr_t)i, 0, NULL);
+    WaitForMultipleObjects(THREAD_COUNT, threads, TRUE, INFINITE);
+    for (uint32_t i = 0; i < THREAD_COUNT; i++) CloseHandle(threads[i]);
+#else
+    pthread_t threads[THREAD_COUNT];
+    for (uint32_t i = 0; i < THREAD_COUNT; i++)
+        TEST_ASSERT(pthread_create(&threads[i], NULL, thread_entry, (void *)(uintptr_t)i) == 0);
+    for (uint32_t i = 0; i < THREAD_COUNT; i++) pthread_join(threads[i], NULL);
+#endif
+}
+
+static uint32_t next_random(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/* Per-CPU caches */
+
+#define POOL_BLOCK_SIZE 64
+#define LIVE_BLOCKS 64
+
+static uint8_t pool_buffer[MB(1)];
+static SnPoolAllocator pool;
+static SnPercpuCache pool_cache;
+
+static void percpu_pool_worker(uint32_t index) {
+    void *live[LIVE_BLOCKS] = {0};
+    uint32_t state = 0x9E3779B9u * (index + 1);
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        uint32_t slot = next_random(&state) % LIVE_BLOCKS;
+
+        // Flushing while others use their slots must not lose or duplicate blocks
+        if (index == THREAD_COUNT - 1 && i % 1024 == 0) sn_percpu_cache_flush(&pool_cache);
+
+        if (live[slot]) {
+            // Blocks must not be handed to two threads at once
+            TEST_ASSERT(*(uint64_t *)live[slot] == ((uint64_t)index << 32 | slot));
+            sn_percpu_cache_free(&pool_cache, live[slot]);
+            live[slot] = NULL;
+        } else {
+            live[slot] = sn_percpu_cache_allocate(&pool_cache);
+            TEST_ASSERT(live[slot]);
+            *(uint64_t *)live[slot] = (uint64_t)index << 32 | slot;
+        }
+    }
+
+    for (uint32_t i = 0; i < LIVE_BLOCKS; i++) sn_percpu_cache_free(&pool_cache, live[i]);
+}
+
+static void test_percpu_pool_cache(void) {
+    TEST_ASSERT(sn_pool_allocator_init(&pool, pool_buffer, sizeof(pool_buffer), POOL_BLOCK_SIZE, 16));
+    uint64_t blocks = sn_pool_allocator_get_block_count(&pool);
+
+    static uint8_t slots[KB(64)];
+    TEST_ASSERT(sn_percpu_cache_get_required_size(1) <= sizeof(slots));
+    TEST_ASSERT(sn_percpu_cache_init_pool(&pool_cache, &pool, slots, sizeof(slots)));
+    TEST_ASSERT(pool_cache.slot_count >= 1);
+    TEST_ASSERT(pool_cache.slot_count <= sn_percpu_get_cpu_count());
+
+    /* Single threaded round trip goes through the slot */
+    void *p = sn_percpu_cache_allocate(&pool_cache);
+    TEST_ASSERT(p);
+    sn_percpu_cache_free(&pool_cache, p);
+    TEST_ASSERT(sn_percpu_cache_allocate(&pool_cache) == p);
+    sn_percpu_cache_free(&pool_cache, p);
+
+    SnMemoryAllocator allocator = sn_percpu_cache_get_allocator(&pool_cache);
+    TEST_ASSERT(!allocator.alloc(allocator.data, POOL_BLOCK_SIZE + 1, 8));
+
+    run_threads(percpu_pool_worker);
+
+    sn_percpu_cache_deinit(&pool_cache);
+    TEST_ASSERT(sn_pool_allocator_get_free_count(&pool) == blocks);
+}
+
+static uint8_t slab_buffer[MB(4)];
+static SnSlabAllocator slab;
+static SnPercpuSlab slab_cache;
+
+static void percpu_slab_worker(uint32_t index) {
+    void *live[LIVE_BLOCKS] = {0};
+    uint64_t sizes[LIVE_BLOCKS];
+    uint32_t state = 0x85EBCA6Bu * (index + 1);
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        uint32_t slot = next_random(&state) % LIVE_BLOCKS;
+
+        if (live[slot]) {
+            for (uint64_t b = 0; b < sizes[slot]; b++)
+                TEST_ASSERT(((uint8_t *)live[slot])[b] == (uint8_t)(index + slot));
+            sn_percpu_slab_free(&slab_cache, live[slot]);
+            live[slot] = NULL;
+        } else {
+            sizes[slot] = 1 + next_random(&state) % 512;
+            live[slot] = sn_percpu_slab_allocate(&slab_cache, sizes[slot], 8);
+            TEST_ASSERT(live[slot]);
+            TEST_ASSERT(sn_slab_allocator_get_usable_size(live[slot]) >= sizes[slot]);
+            memset(live[slot], (uint8_t)(index + slot), sizes[slot]);
+        }
+    }
+
+    for (uint32_t i = 0; i < LIVE_BLOCKS; i++) sn_percpu_slab_free(&slab_cache, live[i]);
+}
+
+static void test_percpu_slab(void) {
+    TEST_ASSERT(sn_slab_allocator_init(&slab, slab_buffer, sizeof(slab_buffer)));
+    uint64_t slabs = sn_slab_allocator_get_slab_count(&slab);
+
+    static uint8_t slots[MB(1)];
+    TEST_ASSERT(sn_percpu_slab_get_required_size(1) <= sizeof(slots));
+    TEST_ASSERT(sn_percpu_slab_init(&slab_cache, &slab, slots, sizeof(slots)));
+
+    void *p = sn_percpu_slab_allocate(&slab_cache, 100, 16);
+    TEST_ASSERT(p && SN_IS_ALIGNED(p, 16));
+    TEST_ASSERT(sn_slab_allocator_get_usable_size(p) == 112);
+    sn_percpu_slab_free(&slab_cache, p);
+
+    TEST_ASSERT(!sn_percpu_slab_allocate(&slab_cache, SN_SLAB_MAX_SIZE + 1, 8));
+
+    run_threads(percpu_slab_worker);
+
+    sn_percpu_slab_deinit(&slab_cache);
+
+    /* Every block went back, only cached empty slabs stay with their class */
+    TEST_ASSERT(sn_slab_allocator_get_free_slab_count(&slab) + SN_SLAB_CLASS_COUNT >= slabs);
+}
+
+/* Thread-owned heaps */
+
+#define REMOTE_BLOCKS 256
+
+static SnOwnedHeap owned_heap;
+static void *remote_blocks[THREAD_COUNT][REMOTE_BLOCKS];
+
+static void remote_free_worker(uint32_t index) {
+    for (uint32_t i = 0; i < REMOTE_BLOCKS; i++) {
+        TEST_ASSERT(*(uint8_t *)remote_blocks[index][i] == (uint8_t)(index + i));
+        sn_owned_heap_free(&owned_heap, remote_blocks[index][i]);
+    }
+}
+
+/* Allocate on this thread, free every block from the workers */
+static void owned_heap_remote_free(SnMemoryAdapter backend, uint32_t max_size) {
+    TEST_ASSERT(sn_owned_heap_init(&owned_heap, backend));
+    TEST_ASSERT(sn_owned_heap_is_owner(&owned_heap));
+
+    /* Owner frees go straight to the backend */
+    void *p = sn_owned_heap_allocate(&owned_heap, 1, 1);
+    TEST_ASSERT(p && sn_owned_heap_owns(&owned_heap, p));
+    sn_owned_heap_free(&owned_heap, p);
+    TEST_ASSERT(sn_owned_heap_drain(&owned_heap) == 0);
+
+    uint32_t state = 0x27D4EB2Fu;
+    for (uint32_t t = 0; t < THREAD_COUNT; t++) {
+        for (uint32_t i = 0; i < REMOTE_BLOCKS; i++) {
+            uint32_t size = 1 + next_random(&state) % max_size;
+            remote_blocks[t][i] = sn_owned_heap_allocate(&owned_heap, size, 8);
+            TEST_ASSERT(remote_blocks[t][i]);
+            *(uint8_t *)remote_blocks[t][i] = (uint8_t)(t + i);
+        }
+    }
+
+    run_threads(remote_free_worker);
+}
+
+static void test_owned_heap_pool(void) {
+    TEST_ASSERT(sn_pool_allocator_init(&pool, pool_buffer, sizeof(pool_buffer), POOL_BLOCK_SIZE, 16));
+    uint64_t blocks = sn_pool_allocator_get_free_count(&pool);
+
+    owned_heap_remote_free(sn_pool_allocator_get_adapter(&pool), POOL_BLOCK_SIZE);
+
+    /* Nothing reached the pool until the owner allocates again */
+    TEST_ASSERT(sn_pool_allocator_get_free_count(&pool) == blocks - THREAD_COUNT * REMOTE_BLOCKS);
+
+    void *p = sn_owned_heap_allocate(&owned_heap, POOL_BLOCK_SIZE, 16);
+    TEST_ASSERT(p);
+    TEST_ASSERT(sn_pool_allocator_get_free_count(&pool) == blocks - 1);
+
+    sn_owned_heap_free(&owned_heap, p);
+    sn_owned_heap_deinit(&owned_heap);
+    TEST_ASSERT(sn_pool_allocator_get_free_count(&pool) == blocks);
+}
+
+static uint8_t freelist_buffer[MB(1)];
+
+static void test_owned_heap_freelist(void) {
+    SnFreeListAllocator freelist;
+    TEST_ASSERT(sn_freelist_allocator_init(&freelist, freelist_buffer, sizeof(freelist_buffer)));
+    uint64_t free_size = sn_freelist_allocator_get_free_size(&freelist);
+
+    owned_heap_remote_free(sn_freelist_allocator_get_adapter(&freelist), 256);
+
+    TEST_ASSERT(sn_owned_heap_drain(&owned_heap) == THREAD_COUNT * REMOTE_BLOCKS);
+    TEST_ASSERT(sn_owned_heap_drain(&owned_heap) == 0);
+
+    sn_owned_heap_deinit(&owned_heap);
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&freelist) == free_size);
+}
+
+static void test_owned_heap_slab(void) {
+    TEST_ASSERT(sn_slab_allocator_init(&slab, slab_buffer, sizeof(slab_buffer)));
+    uint64_t slabs = sn_slab_allocator_get_slab_count(&slab);
+
+    owned_heap_remote_free(sn_slab_allocator_get_adapter(&slab), 512);
+
+    TEST_ASSERT(sn_owned_heap_drain(&owned_heap) == THREAD_COUNT * REMOTE_BLOCKS);
+
+    sn_owned_heap_deinit(&owned_heap);
+    TEST_ASSERT(sn_slab_allocator_get_free_slab_count(&slab) + SN_SLAB_CLASS_COUNT >= slabs);
+}
+
+/* Locked allocators */
+
+static SnLockedAllocator locked;
+
+static void locked_freelist_worker(uint32_t index) {
+    SnMemoryAllocator allocator = sn_locked_allocator_get_allocator(&locked);
+    void *live[LIVE_BLOCKS] = {0};
+    uint64_t sizes[LIVE_BLOCKS];
+    uint32_t state = 0x165667B1u * (index + 1);
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        uint32_t slot = next_random(&state) % LIVE_BLOCKS;
+
+        if (live[slot]) {
+            for (uint64_t b = 0; b < sizes[slot]; b++)
+                TEST_ASSERT(((uint8_t *)live[slot])[b] == (uint8_t)(index + slot));
+
+            if (next_random(&state) % 4 == 0) {
+                uint64_t new_size = 1 + next_random(&state) % 256;
+                void *ptr = allocator.realloc(allocator.data, live[slot], new_size, 8);
+                TEST_ASSERT(ptr);
+                memset(ptr, (uint8_t)(index + slot), new_size);
+                live[slot] = ptr;
+                sizes[slot] = new_size;
+            } else {
+                allocator.free(allocator.data, live[slot]);
+                live[slot] = NULL;
+            }
+        } else {
+            sizes[slot] = 1 + next_random(&state) % 256;
+            live[slot] = allocator.alloc(allocator.data, sizes[slot], 8);
+            TEST_ASSERT(live[slot]);
+            memset(live[slot], (uint8_t)(index + slot), sizes[slot]);
+        }
+    }
+
+    for (uint32_t i = 0; i < LIVE_BLOCKS; i++) allocator.free(allocator.data, live[i]);
+}
+
+static void locked_freelist_run(SnLockKind kind) {
+    SnFreeListAllocator freelist;
+    TEST_ASSERT(sn_freelist_allocator_init(&freelist, freelist_buffer, sizeof(freelist_buffer)));
+    uint64_t free_size = sn_freelist_allocator_get_free_size(&freelist);
+
+    SnMemoryAllocator allocator = sn_freelist_allocator_get_allocator(&freelist);
+    TEST_ASSERT(sn_locked_allocator_init(&locked, allocator, kind, true));
+
+    run_threads(locked_freelist_worker);
+
+    SnLockStats stats;
+    sn_locked_allocator_get_stats(&locked, &stats, true);
+    TEST_ASSERT(stats.acquire_count >= THREAD_COUNT * ITERATIONS);
+    TEST_ASSERT(stats.contended_count <= stats.acquire_count);
+    TEST_ASSERT(stats.hold_time.count == stats.acquire_count);
+
+    sn_locked_allocator_get_stats(&locked, &stats, false);
+    TEST_ASSERT(stats.acquire_count == 0 && stats.hold_time.count == 0);
+
+    sn_locked_allocator_deinit(&locked);
+    TEST_ASSERT(sn_freelist_allocator_get_free_size(&freelist) == free_size);
+}
+
+static void test_locked_mutex(void) {
+    locked_freelist_run(SN_LOCK_KIND_MUTEX);
+}
+
+static void test_locked_ticket(void) {
+    locked_freelist_run(SN_LOCK_KIND_TICKET);
+}
+
+static void test_locked_adaptive(void) {
+    locked_freelist_run(SN_LOCK_KIND_ADAPTIVE);
+}
+
+static void test_locked_uninstrumented(void) {
+    static uint8_t buffer[KB(64)];
+    SnFreeListAllocator freelist;
+    TEST_ASSERT(sn_freelist_allocator_init(&freelist, buffer, sizeof(buffer)));
+
+    SnLockedAllocator alloc;
+    SnMemoryAllocator allocator = sn_freelist_allocator_get_allocator(&freelist);
+    TEST_ASSERT(sn_locked_allocator_init(&alloc, allocator, SN_LOCK_KIND_TICKET, false));
+
+    void *p = sn_locked_allocator_allocate(&alloc, 64, 8);
+    TEST_ASSERT(p);
+    sn_locked_allocator_free(&alloc, p);
+
+    SnLockStats stats;
+    sn_locked_allocator_get_stats(&alloc, &stats, false);
+    TEST_ASSERT(stats.acquire_count == 0 && stats.hold_time.count == 0);
+
+    /* A pool can not reallocate, neither can its wrapper */
+    SnPoolAllocator small;
+    TEST_ASSERT(sn_pool_allocator_init(&small, buffer, sizeof(buffer), 64, 8));
+    sn_locked_allocator_deinit(&alloc);
+    allocator = sn_pool_allocator_get_allocator(&small);
+    TEST_ASSERT(sn_locked_allocator_init(&alloc, allocator, SN_LOCK_KIND_MUTEX, false));
+    TEST_ASSERT(!sn_locked_allocator_get_allocator(&alloc).realloc);
+    sn_locked_allocator_deinit(&alloc);
+}
+
+#if defined(SN_OS_LINUX)
+/* Lazy decommit: an unrelated commit does not wait for a batch being applied */
+
+    #define FLAG_LOAD(x) __atomic_load_n(&(x), __ATOMIC_SEQ_CST)
+    #define FLAG_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_SEQ_CST)
+
+    #define LAZY_ROUNDS 500
+
+static uint8_t *lazy_batch;
+static uint8_t *lazy_unrelated;
+static long lazy_flushing;
+static long lazy_done;
+static long lazy_overlapped;
+
+/* Some pages of the batch decommitted and some not, it is half way through */
+static bool lazy_batch_in_flight(void) {
+    uint64_t page_size = sn_vm_get_page_size();
+    unsigned char residency[SN_VM_LAZY_DECOMMIT_CAPACITY];
+    TEST_ASSERT(mincore(lazy_batch, SN_VM_LAZY_DECOMMIT_CAPACITY * page_size, residency) == 0);
+
+    uint32_t resident = 0;
+    for (uint32_t i = 0; i < SN_VM_LAZY_DECOMMIT_CAPACITY; ++i) resident += residency[i] & 1;
+    return resident && resident < SN_VM_LAZY_DECOMMIT_CAPACITY;
+}
+
+static void lazy_decommit_worker(uint32_t index) {
+    uint64_t page_size = sn_vm_get_page_size();
+
+    if (index == 0) {
+        for (long round = 1; round <= LAZY_ROUNDS && !FLAG_LOAD(lazy_overlapped); ++round) {
+            TEST_ASSERT(sn_vm_commit(lazy_batch, SN_VM_LAZY_DECOMMIT_CAPACITY));
+            memset(lazy_batch, 0xAB, SN_VM_LAZY_DECOMMIT_CAPACITY * page_size);
+
+            for (uint32_t i = 0; i < SN_VM_LAZY_DECOMMIT_CAPACITY; ++i)
+                TEST_ASSERT(sn_vm_decommit_lazy(lazy_batch + i * page_size, 1));
+
+            // Each flush gets its own number, so the other side can tell them apart
+            FLAG_STORE(lazy_flushing, round);
+            sn_vm_lazy_decommit_flush();
+            FLAG_STORE(lazy_flushing, 0);
+        }
+        FLAG_STORE(lazy_done, 1);
+    } else if (index == 1) {
+        while (!FLAG_LOAD(lazy_done)) {
+            long flushing = FLAG_LOAD(lazy_flushing);
+
+            TEST_ASSERT(sn_vm_commit(lazy_unrelated, 1));
+            TEST_ASSERT(lazy_unrelated[0] == 0);
+            lazy_unrelated[0] = 1;
+            TEST_ASSERT(sn_vm_decommit(lazy_unrelated, 1));
+
+            // The commit went through while a batch of the same round was still being applied
+            if (flushing && lazy_batch_in_flight() && FLAG_LOAD(lazy_flushing) == flushing)
+                FLAG_STORE(lazy_overlapped, 1);
+        }
+    }
+}
+
+static void test_vm_lazy_decommit(void) {
+    lazy_batch = sn_vm_reserve(NULL, SN_VM_LAZY_DECOMMIT_CAPACITY);
+    lazy_unrelated = sn_vm_reserve(NULL, 1);
+    TEST_ASSERT(lazy_batch && lazy_unrelated);
+
+    TEST_ASSERT(sn_vm_lazy_decommit_start());
+    run_threads(lazy_decommit_worker);
+    sn_vm_lazy_decommit_stop();
+
+    TEST_ASSERT(FLAG_LOAD(lazy_overlapped));
+
+    TEST_ASSERT(sn_vm_release(lazy_batch, SN_VM_LAZY_DECOMMIT_CAPACITY));
+    TEST_ASSERT(sn_vm_release(lazy_unrelated, 1));
+}
+#endif
+
+/* Shared ring: producer and consumer block on each other */
+
+#define RING_MESSAGES 20000
+
+static SnSharedRing ring_producer;
+static SnSharedRing ring_consumer;
+
+static void shared_ring_worker(uint32_t index) {
+    uint32_t state = 0x9E3779B9u;
+
+    if (index == 0) {
+        for (uint32_t i = 0; i < RING_MESSAGES; ++i) {
+            uint64_t size = sizeof(uint32_t) + next_random(&state) % 200;
+            uint32_t *msg = sn_shared_ring_reserve(&ring_producer, size, SN_SHARED_RING_WAIT_FOREVER);
+            TEST_ASSERT(msg);
+            msg[0] = i;
+            sn_shared_ring_commit(&ring_producer);
+        }
+    } else if (index == 1) {
+        for (uint32_t i = 0; i < RING_MESSAGES; ++i) {
+            uint64_t expected = sizeof(uint32_t) + next_random(&state) % 200;
+            uint64_t size;
+            uint32_t *msg = sn_shared_ring_peek(&ring_consumer, &size, SN_SHARED_RING_WAIT_FOREVER);
+            TEST_ASSERT(msg && size == expected && msg[0] == i);
+            sn_shared_ring_release(&ring_consumer);
+        }
+    }
+}
+
+static void test_shared_ring(void) {
+    char name[SN_SHARED_RING_NAME_MAX];
+    snprintf(name, sizeof(name), "/sn_thread_ring_%d_%llx", (int)getpid(), (unsigned long long)time(NULL));
+
+    /* Small ring so that both sides wait often */
+    TEST_ASSERT(sn_shared_ring_create(&ring_producer, name, 1024));
+    TEST_ASSERT(sn_shared_ring_open(&ring_consumer, name));
+
+    run_threads(shared_ring_worker);
+
+    TEST_ASSERT(!sn_shared_ring_peek(&ring_consumer, NULL, 0));
+    sn_shared_ring_close(&ring_consumer);
+    sn_shared_ring_close(&ring_producer);
+}
+
+int main(void) {
+    printf("Thread tests:\n");
+
+    RUN_TEST(test_percpu_pool_cache);
+    RUN_TEST(test_percpu_slab);
+    RUN_TEST(test_owned_heap_pool);
+    RUN_TEST(test_owned_heap_freelist);
+    RUN_TEST(test_owned_heap_slab);
+    RUN_TEST(test_locked_mutex);
+    RUN_TEST(test_locked_ticket);
+    RUN_TEST(test_locked_adaptive);
+    RUN_TEST(test_locked_uninstrumented);
+#if defined(SN_OS_LINUX)
+    RUN_TEST(test_vm_lazy_decommit);
+#endif
+    RUN_TEST(test_shared_ring);
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return tests_passed == tests_run ? 0 : 1;
+}